@@ -0,0 +1,170 @@
+#include "AsyncProcessor.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+
+#include <algorithm>
+
+namespace {
+
+// Android's THREAD_PRIORITY_URGENT_AUDIO
+constexpr int kUrgentAudioNice = -19;
+
+bool raiseWorkerPriority() {
+    sched_param param{};
+    param.sched_priority = sched_get_priority_min(SCHED_FIFO) + 1;
+    if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0) {
+        return true;
+    }
+    // Unprivileged: a nice level (per thread on Linux) is as far as the scheduler lets us go
+    setpriority(PRIO_PROCESS, 0, kUrgentAudioNice);
+    return false;
+}
+
+}
+
+AsyncProcessor::AsyncProcessor() {
+    sem_init(&mWake, 0, 0);
+}
+
+AsyncProcessor::~AsyncProcessor() {
+    stop();
+    sem_destroy(&mWake);
+}
+
+void AsyncProcessor::stop() {
+    if (mWorker.joinable()) {
+        mRunning.store(false, std::memory_order_release);
+        sem_post(&mWake);
+        mWorker.join();
+    }
+}
+
+void AsyncProcessor::start(RenderFunction render, int32_t maxCallbackFrames, int32_t latencyFrames,
+                           int32_t maxDryDelayFrames) {
+    stop();
+    while (sem_trywait(&mWake) == 0) {}
+
+    mRender = std::move(render);
+    mMaxCallbackFrames = std::max(maxCallbackFrames, 1);
+    mLatencyFrames = std::max(latencyFrames, 0);
+    mMaxDryDelay = std::max(maxDryDelayFrames, 0);
+    mDeadlineMisses.store(0, std::memory_order_relaxed);
+    mInputOverruns.store(0, std::memory_order_relaxed);
+    mRealtimePriority.store(false, std::memory_order_relaxed);
+    mMissedFrames = 0;
+    mDryDelay = 0;
+    mWrittenFrames = 0;
+    mGapHead = 0;
+    mGapCount = 0;
+
+    // Room for several callbacks beyond the budget before input has to be dropped
+    const size_t inFlight = (size_t) mLatencyFrames + 8 * (size_t) mMaxCallbackFrames;
+    mInput.reset(inFlight);
+    mOutput.reset(inFlight + mLatencyFrames + mMaxCallbackFrames);
+    mDry.reset((size_t) mLatencyFrames + mMaxDryDelay + (size_t) mMaxCallbackFrames);
+    mWorkerInput.assign(mMaxCallbackFrames, 0.0f);
+    mWorkerOutput.assign(mMaxCallbackFrames, 0.0f);
+    // A gap is played latencyFrames after it is made, and gaps are at least a frame apart
+    mGaps.assign((size_t) (mLatencyFrames + mMaxCallbackFrames) / 2 + 2, Gap{0, 0});
+
+    // Pre-roll so ring position == stream position
+    std::vector<float> silence(mLatencyFrames, 0.0f);
+    mOutput.write(silence.data(), silence.size());
+    mDry.write(silence.data(), silence.size());
+
+    mRunning.store(true, std::memory_order_release);
+    mWorker = std::thread(&AsyncProcessor::workerLoop, this);
+}
+
+void AsyncProcessor::setDryDelay(int32_t frames) {
+    frames = std::clamp(frames, 0, mMaxDryDelay);
+    if (frames > mDryDelay) {
+        auto spans = mDry.writeSpans(frames - mDryDelay);
+        std::fill(spans.first, spans.first + spans.firstSize, 0.0f);
+        std::fill(spans.second, spans.second + spans.secondSize, 0.0f);
+        mDry.commitWrite(spans.size());
+    } else if (frames < mDryDelay) {
+        mDry.consume(mDryDelay - frames);
+    }
+    mDryDelay = frames;
+}
+
+void AsyncProcessor::process(const float *input, float *output, int32_t numFrames) {
+    // Hand the input over first so the worker can start on it while we copy.
+    // All-or-nothing; a full ring means the worker has stalled for many callbacks.
+    const int64_t position = mWrittenFrames;
+    mWrittenFrames += numFrames;
+    if (mInput.availableToWrite() >= (size_t) numFrames) {
+        mInput.write(input, numFrames);
+    } else {
+        mInputOverruns.fetch_add(1, std::memory_order_relaxed);
+        Gap &last = mGaps[(mGapHead + mGapCount + mGaps.size() - 1) % mGaps.size()];
+        if (mGapCount > 0 && last.end == position) {
+            last.end = mWrittenFrames;
+        } else if (mGapCount < mGaps.size()) {
+            mGaps[(mGapHead + mGapCount) % mGaps.size()] = Gap{position, mWrittenFrames};
+            ++mGapCount;
+        }
+    }
+    sem_post(&mWake);
+
+    // The dry fallback, delayed to line up with the wet output
+    mDry.write(input, numFrames);
+    mDry.read(output, numFrames);
+
+    // Wet output for stream positions [playing, playing + numFrames); the pre-roll is the
+    // negative positions. Gaps keep the dry samples.
+    const int64_t playing = position - mLatencyFrames;
+    bool missed = false;
+    int32_t done = 0;
+    while (done < numFrames) {
+        const int64_t at = playing + done;
+        while (mGapCount > 0 && mGaps[mGapHead].end <= at) {
+            mGapHead = (mGapHead + 1) % mGaps.size();
+            --mGapCount;
+        }
+        int32_t length = numFrames - done;
+        if (mGapCount > 0 && mGaps[mGapHead].start <= at) {
+            length = (int32_t) std::min<int64_t>(length, mGaps[mGapHead].end - at);
+            missed = true;
+        } else {
+            if (mGapCount > 0) {
+                length = (int32_t) std::min<int64_t>(length, mGaps[mGapHead].start - at);
+            }
+            if (mMissedFrames > 0) {
+                mMissedFrames -= mOutput.consume(mMissedFrames);
+            }
+            const size_t delivered = mOutput.read(output + done, length);
+            if (delivered < (size_t) length) {
+                mMissedFrames += length - delivered;
+                missed = true;
+            }
+        }
+        done += length;
+    }
+    if (missed) {
+        mDeadlineMisses.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void AsyncProcessor::workerLoop() {
+    mRealtimePriority.store(raiseWorkerPriority(), std::memory_order_relaxed);
+    while (true) {
+        sem_wait(&mWake);
+        if (!mRunning.load(std::memory_order_acquire)) break;
+        drainInput();
+    }
+}
+
+void AsyncProcessor::drainInput() {
+    size_t available;
+    while (mRunning.load(std::memory_order_relaxed) && (available = mInput.availableToRead()) > 0) {
+        const int32_t chunk = (int32_t) std::min(available, (size_t) mMaxCallbackFrames);
+        mInput.read(mWorkerInput.data(), chunk);
+        mRender(mWorkerInput.data(), mWorkerOutput.data(), chunk);
+        // Sized for the whole input ring on top of the pre-roll, so this can't overflow
+        mOutput.write(mWorkerOutput.data(), chunk);
+    }
+}
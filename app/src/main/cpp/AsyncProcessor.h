@@ -0,0 +1,109 @@
+#ifndef OBOEPASSTHROUGH_ASYNCPROCESSOR_H
+#define OBOEPASSTHROUGH_ASYNCPROCESSOR_H
+
+#include <semaphore.h>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "SpscRingBuffer.h"
+
+/**
+ * Runs a processing chain on a dedicated worker thread so the audio callback only moves
+ * samples between lock-free rings.
+ *
+ * process() writes each callback's input to the worker through an SpscRingBuffer, posts a
+ * semaphore, and plays back whatever the worker has returned through a second ring. That
+ * ring is pre-rolled with latencyFrames of silence, so the worker has latencyFrames of wall
+ * time (the extra-latency budget) to render each callback before the audio thread needs it.
+ *
+ * When the output is not ready at its deadline, the audio thread plays the dry input in
+ * its place, delayed by latencyFrames + the dry delay (the chain's own latency, see
+ * setDryDelay()) so the fallback lines up with the wet signal, counts a deadline miss and
+ * discards the late samples once they arrive.
+ *
+ * When the input ring is full (the worker has stalled for many callbacks), that callback's
+ * input is dropped. Its frames are remembered as a gap in the stream: when playback gets
+ * to them they play dry and count as a miss, but nothing is discarded for them, since the
+ * worker never sees them. Output on either side of the gap stays aligned.
+ *
+ * The worker asks for SCHED_FIFO and falls back to the strongest nice level the process
+ * is allowed (Android's THREAD_PRIORITY_URGENT_AUDIO); hasRealtimePriority() reports
+ * which one it got.
+ *
+ * start() allocates and starts the worker; process() and setDryDelay() do not.
+ */
+class AsyncProcessor {
+public:
+    // Called on the worker thread with up to maxCallbackFrames frames at a time.
+    using RenderFunction = std::function<void(const float *input, float *output, int32_t numFrames)>;
+
+    AsyncProcessor();
+    ~AsyncProcessor();
+
+    AsyncProcessor(const AsyncProcessor &) = delete;
+    AsyncProcessor &operator=(const AsyncProcessor &) = delete;
+
+    // Not real-time safe. Stops any running worker, sizes the rings and starts a new one.
+    // maxDryDelayFrames bounds setDryDelay().
+    void start(RenderFunction render, int32_t maxCallbackFrames, int32_t latencyFrames,
+               int32_t maxDryDelayFrames);
+    // Not real-time safe. Idempotent.
+    void stop();
+
+    bool isRunning() const { return mWorker.joinable(); }
+    int32_t getLatencyFrames() const { return mLatencyFrames; }
+
+    // ---- audio thread ----
+    // Any number of frames up to maxCallbackFrames; output lags input by getLatencyFrames()
+    // plus whatever the render function itself adds.
+    void process(const float *input, float *output, int32_t numFrames);
+    // Latency of the render function, so the dry fallback stays aligned with it. Clamped to
+    // maxDryDelayFrames; a change takes effect at once (skipping dry samples or inserting silence).
+    void setDryDelay(int32_t frames);
+
+    // ---- any thread ----
+    int64_t getDeadlineMisses() const { return mDeadlineMisses.load(std::memory_order_relaxed); }
+    int64_t getInputOverruns() const { return mInputOverruns.load(std::memory_order_relaxed); }
+    bool hasRealtimePriority() const { return mRealtimePriority.load(std::memory_order_relaxed); }
+
+private:
+    void workerLoop();
+    void drainInput();
+
+    RenderFunction mRender;
+    int32_t mMaxCallbackFrames = 0;
+    int32_t mLatencyFrames = 0;
+    int32_t mMaxDryDelay = 0;
+
+    SpscRingBuffer<float> mInput;       // audio thread -> worker
+    SpscRingBuffer<float> mOutput;      // worker -> audio thread, pre-rolled with latencyFrames
+    std::vector<float> mWorkerInput;
+    std::vector<float> mWorkerOutput;
+    sem_t mWake;
+    std::thread mWorker;
+    std::atomic<bool> mRunning{false};
+    std::atomic<bool> mRealtimePriority{false};
+    std::atomic<int64_t> mDeadlineMisses{0};
+    std::atomic<int64_t> mInputOverruns{0};
+
+    // Stream positions [start, end) whose input was dropped
+    struct Gap {
+        int64_t start;
+        int64_t end;
+    };
+
+    // audio thread
+    SpscRingBuffer<float> mDry;         // delay line for the fallback, used by one thread only
+    int32_t mDryDelay = 0;
+    size_t mMissedFrames = 0;           // played dry; discard when the late output lands
+    int64_t mWrittenFrames = 0;         // input stream position, dropped callbacks included
+    std::vector<Gap> mGaps;             // pending gaps, oldest first, as a ring
+    size_t mGapHead = 0;
+    size_t mGapCount = 0;
+};
+
+#endif //OBOEPASSTHROUGH_ASYNCPROCESSOR_H
@@ -0,0 +1,178 @@
+#include "BiquadCascade.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+
+#include "SimdVec4.h"
+
+BiquadCascade::Coefficients BiquadCascade::design(const Section &section, int32_t sampleRate) {
+    const double nyquist = 0.5 * sampleRate;
+    const double f0 = std::min(std::max((double) section.frequencyHz, 1.0), 0.99 * nyquist);
+    const double w0 = 2.0 * M_PI * f0 / sampleRate;
+    const double cosw = cos(w0);
+    const double alpha = sin(w0) / (2.0 * std::max((double) section.q, 0.05));
+
+    double b0, b1, b2, a0, a1, a2;
+    switch (section.type) {
+        case SectionType::HighPass:
+            b0 = 0.5 * (1.0 + cosw);
+            b1 = -(1.0 + cosw);
+            b2 = b0;
+            a0 = 1.0 + alpha;
+            a1 = -2.0 * cosw;
+            a2 = 1.0 - alpha;
+            break;
+        case SectionType::LowPass:
+            b0 = 0.5 * (1.0 - cosw);
+            b1 = 1.0 - cosw;
+            b2 = b0;
+            a0 = 1.0 + alpha;
+            a1 = -2.0 * cosw;
+            a2 = 1.0 - alpha;
+            break;
+        case SectionType::Peaking:
+        default: {
+            const double a = pow(10.0, section.gainDb / 40.0);
+            b0 = 1.0 + alpha * a;
+            b1 = -2.0 * cosw;
+            b2 = 1.0 - alpha * a;
+            a0 = 1.0 + alpha / a;
+            a1 = b1;
+            a2 = 1.0 - alpha / a;
+            break;
+        }
+    }
+
+    Coefficients c;
+    c.b0 = (float) (b0 / a0);
+    c.b1 = (float) (b1 / a0);
+    c.b2 = (float) (b2 / a0);
+    c.a1 = (float) (a1 / a0);
+    c.a2 = (float) (a2 / a0);
+    return c;
+}
+
+std::vector<BiquadCascade::Section> BiquadCascade::bandLimit(float lowHz, float highHz) {
+    // Butterworth fourth order = two second-order sections with Q = 1 / (2 cos(pi/8)), 1 / (2 cos(3pi/8))
+    const float q1 = 0.54119610f;
+    const float q2 = 1.30656296f;
+    return {
+            {SectionType::HighPass, lowHz, q1, 0.0f},
+            {SectionType::HighPass, lowHz, q2, 0.0f},
+            {SectionType::LowPass, highHz, q1, 0.0f},
+            {SectionType::LowPass, highHz, q2, 0.0f},
+    };
+}
+
+void BiquadCascade::configure(int32_t sampleRate) {
+    mSampleRate = sampleRate;
+    publish();
+}
+
+void BiquadCascade::setSections(const std::vector<Section> &sections) {
+    mSections.assign(sections.begin(),
+                     sections.begin() + std::min<size_t>(sections.size(), kMaxSections));
+    publish();
+}
+
+float BiquadCascade::responseDb(float frequencyHz) const {
+    const double w = 2.0 * M_PI * frequencyHz / mSampleRate;
+    const std::complex<double> z1 = std::polar(1.0, -w);
+    const std::complex<double> z2 = z1 * z1;
+    double db = 0.0;
+    for (const Section &section : mSections) {
+        Coefficients c = design(section, mSampleRate);
+        std::complex<double> h = ((double) c.b0 + (double) c.b1 * z1 + (double) c.b2 * z2) /
+                                 (1.0 + (double) c.a1 * z1 + (double) c.a2 * z2);
+        db += 20.0 * log10(std::max(std::abs(h), 1e-12));
+    }
+    return (float) db;
+}
+
+void BiquadCascade::publish() {
+    Layout &layout = mLayouts.writeBuffer();
+    layout.numSections = (int32_t) mSections.size();
+    for (int32_t s = 0; s < layout.numSections; ++s) {
+        const Coefficients c = design(mSections[s], mSampleRate);
+        layout.coeffs[s] = c;
+        // Column j is the response of outputs 0..3 to a unit value on input j alone
+        for (int32_t j = 0; j < 8; ++j) {
+            double x[6] = {};       // x[-2], x[-1], x0..x3
+            double y[6] = {};       // y[-2], y[-1], y0..y3
+            if (j < 4) x[2 + j] = 1.0;
+            else if (j == 4) x[1] = 1.0;
+            else if (j == 5) x[0] = 1.0;
+            else if (j == 6) y[1] = 1.0;
+            else y[0] = 1.0;
+            for (int32_t n = 2; n < 6; ++n) {
+                y[n] = c.b0 * x[n] + c.b1 * x[n - 1] + c.b2 * x[n - 2] - c.a1 * y[n - 1] - c.a2 * y[n - 2];
+                layout.block[s][j][n - 2] = (float) y[n];
+            }
+        }
+    }
+    mLayouts.publish();
+}
+
+void BiquadCascade::reset() {
+    mState.fill(State());
+}
+
+void BiquadCascade::process(const float *input, float *output, int32_t numFrames) {
+    const Layout &layout = mLayouts.read();
+    if (layout.numSections == 0) {
+        if (input != output) std::copy(input, input + numFrames, output);
+        return;
+    }
+
+    const int32_t vectorFrames = numFrames & ~3;
+    const float *in = input;
+    for (int32_t s = 0; s < layout.numSections; ++s) {
+        const float (*m)[4] = layout.block[s];
+        const simd::vec4 c0 = simd::load(m[0]), c1 = simd::load(m[1]);
+        const simd::vec4 c2 = simd::load(m[2]), c3 = simd::load(m[3]);
+        const simd::vec4 cx1 = simd::load(m[4]), cx2 = simd::load(m[5]);
+        const simd::vec4 cy1 = simd::load(m[6]), cy2 = simd::load(m[7]);
+        State st = mState[s];
+
+        int32_t i = 0;
+        for (; i < vectorFrames; i += 4) {
+            const float x0 = in[i], x1 = in[i + 1], x2 = in[i + 2], x3 = in[i + 3];
+            // Feed-forward terms first, in two chains; only the last two wait on y[-1], y[-2]
+            simd::vec4 a = simd::mul(c0, simd::set1(x0));
+            simd::vec4 b = simd::mul(c1, simd::set1(x1));
+            a = simd::madd(c2, simd::set1(x2), a);
+            b = simd::madd(c3, simd::set1(x3), b);
+            a = simd::madd(cx1, simd::set1(st.x1), a);
+            b = simd::madd(cx2, simd::set1(st.x2), b);
+            simd::vec4 y = simd::madd(cy1, simd::set1(st.y1), simd::add(a, b));
+            y = simd::madd(cy2, simd::set1(st.y2), y);
+            simd::store(output + i, y);
+            st.x1 = x3;
+            st.x2 = x2;
+            st.y1 = output[i + 3];
+            st.y2 = output[i + 2];
+        }
+
+        const Coefficients &c = layout.coeffs[s];
+        for (; i < numFrames; ++i) {
+            const float x = in[i];
+            const float y = c.b0 * x + c.b1 * st.x1 + c.b2 * st.x2 - c.a1 * st.y1 - c.a2 * st.y2;
+            st.x2 = st.x1;
+            st.x1 = x;
+            st.y2 = st.y1;
+            st.y1 = y;
+            output[i] = y;
+        }
+
+        // Flush decayed history before it reaches the denormal range
+        if (std::fabs(st.x1) < kDenormalFloor) st.x1 = 0.0f;
+        if (std::fabs(st.x2) < kDenormalFloor) st.x2 = 0.0f;
+        if (std::fabs(st.y1) < kDenormalFloor) st.y1 = 0.0f;
+        if (std::fabs(st.y2) < kDenormalFloor) st.y2 = 0.0f;
+        mState[s] = st;
+
+        // Later sections run in place
+        in = output;
+    }
+}
@@ -0,0 +1,96 @@
+#ifndef OBOEPASSTHROUGH_BIQUADCASCADE_H
+#define OBOEPASSTHROUGH_BIQUADCASCADE_H
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "TripleBuffer.h"
+
+/**
+ * Cascade of up to kMaxSections biquads (RBJ cookbook high-pass, low-pass and peaking
+ * EQ), run sample-by-sample on the callback buffer: no block delay, only the filters'
+ * own group delay.
+ *
+ * Each section is direct form I. A mono cascade is one serial recursion, so instead of
+ * vectorizing across sections the block is processed four samples at a time in exact
+ * state-space form: the four outputs are a fixed linear combination of the four inputs
+ * and the section's four state values (x[-1], x[-2], y[-1], y[-2]), i.e. eight vector
+ * multiply-adds with no dependency inside the group. The last two inputs and outputs
+ * are the next state, so tails shorter than four samples fall back to the plain
+ * recursion on the same state.
+ *
+ * State values that decay below kDenormalFloor are flushed to zero after every block,
+ * so a silent input never leaves the recursion in denormal arithmetic.
+ *
+ * configure() and setSections() run on a control thread and publish through a
+ * TripleBuffer; process() runs on the audio thread and does not allocate.
+ */
+class BiquadCascade {
+public:
+    static constexpr int32_t kMaxSections = 8;
+    static constexpr float kDenormalFloor = 1e-15f;
+
+    enum class SectionType : int32_t {
+        HighPass = 0,
+        LowPass = 1,
+        Peaking = 2,
+    };
+
+    struct Section {
+        SectionType type = SectionType::Peaking;
+        float frequencyHz = 1000.0f;
+        float q = 0.70710678f;
+        float gainDb = 0.0f;            // Peaking only
+    };
+
+    // Normalized so a0 = 1.
+    struct Coefficients {
+        float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f;
+        float a1 = 0.0f, a2 = 0.0f;
+    };
+
+    static Coefficients design(const Section &section, int32_t sampleRate);
+
+    // Fourth-order Butterworth high-pass at lowHz and low-pass at highHz (four sections).
+    static std::vector<Section> bandLimit(float lowHz, float highHz);
+
+    // ---- control thread ----
+    void configure(int32_t sampleRate);
+    // Sections past kMaxSections are ignored; an empty list passes audio through.
+    void setSections(const std::vector<Section> &sections);
+    const std::vector<Section> &getSections() const { return mSections; }
+    // Magnitude response of the configured cascade.
+    float responseDb(float frequencyHz) const;
+
+    // ---- audio thread ----
+    // input may equal output.
+    void process(const float *input, float *output, int32_t numFrames);
+    // Clears the filter history. Only while the audio thread is not running.
+    void reset();
+
+private:
+    struct Layout {
+        int32_t numSections = 0;
+        std::array<Coefficients, kMaxSections> coeffs{};
+        // Per section, the four outputs' weights on x0..x3, x[-1], x[-2], y[-1], y[-2]
+        alignas(16) float block[kMaxSections][8][4];
+    };
+
+    struct State {
+        float x1 = 0.0f, x2 = 0.0f, y1 = 0.0f, y2 = 0.0f;
+    };
+
+    void publish();
+
+    // control-side copy of the configuration
+    int32_t mSampleRate = 48000;
+    std::vector<Section> mSections;
+
+    TripleBuffer<Layout> mLayouts;
+
+    // audio-side state
+    std::array<State, kMaxSections> mState{};
+};
+
+#endif //OBOEPASSTHROUGH_BIQUADCASCADE_H
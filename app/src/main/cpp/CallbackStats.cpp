@@ -0,0 +1,56 @@
+#include "CallbackStats.h"
+
+#include <algorithm>
+#include <cmath>
+
+int64_t CallbackStats::bucketUpperNs(int i) {
+    return (int64_t) llround(1000.0 * exp2((double) (i + 1) / kBucketsPerOctave));
+}
+
+int64_t CallbackStats::Snapshot::percentileNs(double p) const {
+    if (callbacks <= 0) return 0;
+    int64_t rank = (int64_t) std::ceil(std::min(std::max(p, 0.0), 1.0) * callbacks);
+    int64_t seen = 0;
+    for (int i = 0; i < kNumBuckets; ++i) {
+        seen += histogram[i];
+        if (seen >= rank && seen > 0) {
+            return std::min(bucketUpperNs(i), maxNs);
+        }
+    }
+    return maxNs;
+}
+
+void CallbackStats::beginCallback() {
+    if (mResetRequested.load(std::memory_order_relaxed)) {
+        mResetRequested.store(false, std::memory_order_relaxed);
+        mLocal = Snapshot();
+    }
+    mStart = Clock::now();
+}
+
+void CallbackStats::noteDepths(int32_t inputFrames, int32_t outputFrames) {
+    mLocal.inputHighWater = std::max(mLocal.inputHighWater, inputFrames);
+    mLocal.outputHighWater = std::max(mLocal.outputHighWater, outputFrames);
+}
+
+int64_t CallbackStats::endCallback(int32_t numFrames) {
+    int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - mStart).count();
+
+    // Bucket i covers (upper(i - 1), upper(i)]; 1 us and below land in bucket 0
+    int bucket = 0;
+    if (ns > 1000) {
+        bucket = (int) std::ceil(kBucketsPerOctave * std::log2(ns / 1000.0)) - 1;
+        bucket = std::min(std::max(bucket, 0), kNumBuckets - 1);
+    }
+    ++mLocal.histogram[bucket];
+
+    mLocal.minNs = mLocal.callbacks == 0 ? ns : std::min(mLocal.minNs, ns);
+    mLocal.maxNs = std::max(mLocal.maxNs, ns);
+    mLocal.totalNs += ns;
+    mLocal.frames += numFrames;
+    ++mLocal.callbacks;
+
+    mPublished.writeBuffer() = mLocal;
+    mPublished.publish();
+    return ns;
+}
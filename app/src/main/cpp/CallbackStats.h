@@ -0,0 +1,94 @@
+#ifndef OBOEPASSTHROUGH_CALLBACKSTATS_H
+#define OBOEPASSTHROUGH_CALLBACKSTATS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "TripleBuffer.h"
+
+/**
+ * Real-time-safe instrumentation for the audio callback: a duration histogram with
+ * min/max/mean, counters for short reads, ring overruns/overflows and output underruns,
+ * and FIFO depth high-water marks.
+ *
+ * The audio thread accumulates into a private Snapshot with plain stores and publishes a
+ * copy through a TripleBuffer at the end of each callback, so it never waits, allocates
+ * or shares a cache line with the reader. Control-thread reset requests travel the other
+ * way through a relaxed atomic flag that the next callback picks up.
+ */
+class CallbackStats {
+public:
+    // Four buckets per octave from 1 us; the last bucket also catches anything longer.
+    static constexpr int kNumBuckets = 64;
+    static constexpr int kBucketsPerOctave = 4;
+
+    struct Snapshot {
+        int64_t callbacks = 0;
+        int64_t frames = 0;
+        int64_t minNs = 0;
+        int64_t maxNs = 0;
+        int64_t totalNs = 0;
+        int64_t shortReads = 0;         // not enough mic audio for a callback (zero-filled)
+        int64_t inputOverruns = 0;      // input ring full, oldest input dropped
+        int64_t outputOverflows = 0;    // output FIFO full, oldest output dropped
+        int64_t outputUnderruns = 0;    // output zero-filled after the pipeline had primed
+        int32_t inputHighWater = 0;     // frames
+        int32_t outputHighWater = 0;    // frames
+        double driftPpm = 0.0;          // latest DriftCompensator state
+        double driftFillFrames = 0.0;
+        int64_t driftSlips = 0;
+        int32_t latencyTargetFrames = 0;  // mic backlog the jitter controller holds
+        int32_t latencyMarginFrames = 0;  // of which safety margin
+        int64_t latencyDrops = 0;         // backlog trims
+        int32_t qualityLevel = 0;         // LoadGovernor::Level
+        int64_t qualityStepDowns = 0;
+        int64_t qualityStepUps = 0;
+        uint32_t histogram[kNumBuckets] = {};
+
+        // Upper edge of the histogram bucket holding the p-th fraction (0..1) of callbacks.
+        int64_t percentileNs(double p) const;
+    };
+
+    // Upper edge of bucket i in ns.
+    static int64_t bucketUpperNs(int i);
+
+    // ---- audio thread ----
+    void beginCallback();
+    void addShortRead() { ++mLocal.shortReads; }
+    void addInputOverrun() { ++mLocal.inputOverruns; }
+    void addOutputOverflow() { ++mLocal.outputOverflows; }
+    void addOutputUnderrun() { ++mLocal.outputUnderruns; }
+    void noteDepths(int32_t inputFrames, int32_t outputFrames);
+    void noteDrift(double correctionPpm, double fillFrames, int64_t slips) {
+        mLocal.driftPpm = correctionPpm;
+        mLocal.driftFillFrames = fillFrames;
+        mLocal.driftSlips = slips;
+    }
+    void noteLatency(int32_t targetFrames, int32_t marginFrames, int64_t drops) {
+        mLocal.latencyTargetFrames = targetFrames;
+        mLocal.latencyMarginFrames = marginFrames;
+        mLocal.latencyDrops = drops;
+    }
+    void noteQuality(int32_t level, int64_t stepDowns, int64_t stepUps) {
+        mLocal.qualityLevel = level;
+        mLocal.qualityStepDowns = stepDowns;
+        mLocal.qualityStepUps = stepUps;
+    }
+    // Returns this callback's duration in ns.
+    int64_t endCallback(int32_t numFrames);
+
+    // ---- control thread (a single reader at a time) ----
+    const Snapshot &read() { return mPublished.read(); }
+    void requestReset() { mResetRequested.store(true, std::memory_order_relaxed); }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    Snapshot mLocal;
+    Clock::time_point mStart;
+    TripleBuffer<Snapshot> mPublished;
+    std::atomic<bool> mResetRequested{false};
+};
+
+#endif //OBOEPASSTHROUGH_CALLBACKSTATS_H
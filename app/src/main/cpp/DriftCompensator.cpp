@@ -0,0 +1,166 @@
+#include "DriftCompensator.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Loop tuning: closed-loop natural frequency and damping of the fill level, and the time
+// constant of the fill smoothing. The fill is only observed at mic-burst granularity, so
+// the loop is kept slow enough that a burst-sized step moves the ratio by < 300 ppm.
+constexpr double kLoopOmega = 0.1;          // rad/s
+constexpr double kLoopDamping = 0.7;
+constexpr double kFillTimeConstant = 1.0;   // s
+
+} // namespace
+
+void DriftCompensator::configure(int32_t sampleRate, int32_t targetFrames, int32_t maxCallbackFrames,
+                                 int32_t channels) {
+    mSampleRate = sampleRate;
+    mChannels = std::max(channels, 1);
+    mTargetFrames = std::max(targetFrames, 4);
+    mSlipFrames = std::max(4 * maxCallbackFrames, sampleRate / 20);
+    mMaxTargetFrames = mTargetFrames + mSlipFrames / 2;
+    mMaxDropFrames = maxCallbackFrames;
+    mRing.reset((size_t) (mTargetFrames + 2 * mSlipFrames) * mChannels);
+    // One callback's worth of taps at the fastest ratio, a drop, and the interpolator's reach
+    mScratch.assign(((size_t) (maxCallbackFrames * (1.0 + kMaxCorrectionPpm * 1e-6)) +
+                     mMaxDropFrames + 8) * mChannels, 0.0f);
+    // One-second windows, margin steps of 32 frames
+    mJitter.configure(sampleRate, 8, std::max(mTargetFrames, mSlipFrames / 2), 32);
+    mPrimed = false;
+    mPhase = 0.0;
+    mRatio = 1.0;
+    mFillSmoothed = mTargetFrames;
+    mIntegral = 0.0;
+    mUnderruns = 0;
+    mSlips = 0;
+    mDrops = 0;
+}
+
+int32_t DriftCompensator::write(const float *input, int32_t numFrames) {
+    // The backlog is only seen at this granularity, so as the two clocks slide past each
+    // other it can read up to one chunk low; never trim into that while such chunks arrive
+    mJitter.noteChunk(numFrames + 8);
+    size_t space = mRing.availableToWrite() / mChannels;
+    if ((size_t) numFrames > space) {
+        mRing.consume((numFrames - space) * mChannels);
+    }
+    return (int32_t) (mRing.write(input, (size_t) numFrames * mChannels) / mChannels);
+}
+
+float DriftCompensator::interpolate(const float *x, double position, int32_t stride) {
+    int32_t k = (int32_t) position;
+    float mu = (float) (position - k);
+    const float *p = x + (size_t) k * stride;
+    float xm1 = p[0], x0 = p[stride], x1 = p[2 * stride], x2 = p[3 * stride];
+    // Cubic Lagrange through x[-1..2], evaluated at mu as ((c3 mu + c2) mu + c1) mu + c0
+    float c0 = x0;
+    float c1 = x1 - (1.0f / 3.0f) * xm1 - 0.5f * x0 - (1.0f / 6.0f) * x2;
+    float c2 = 0.5f * (xm1 + x1) - x0;
+    float c3 = (1.0f / 6.0f) * (x2 - xm1) + 0.5f * (x0 - x1);
+    return ((c3 * mu + c2) * mu + c1) * mu + c0;
+}
+
+int32_t DriftCompensator::read(float *output, int32_t numFrames) {
+    const int32_t channels = mChannels;
+    double fill = (double) bufferedFrames() - mPhase;
+    if (!mPrimed) {
+        // Start (or restart) only with the target buffered, so the loop begins on target
+        if (fill < mTargetFrames + 3) {
+            std::fill(output, output + (size_t) numFrames * channels, 0.0f);
+            return 0;
+        }
+        mPrimed = true;
+        mFillSmoothed = fill;
+    }
+    if (fill > mTargetFrames + mSlipFrames) {
+        // Far outside what the loop can pull in; drop straight back to the target
+        mRing.consume((size_t) (fill - mTargetFrames) * channels);
+        fill = (double) bufferedFrames() - mPhase;
+        mFillSmoothed = fill;
+        ++mSlips;
+    }
+
+    updateRatio(numFrames);
+
+    // Headroom this read leaves behind; surplus beyond the jitter margin is dropped now
+    int32_t drop = 0;
+    if (mLatencyControl) {
+        int32_t slack = (int32_t) (fill - numFrames * mRatio) - 4;
+        drop = std::min(mJitter.update(slack, numFrames), mMaxDropFrames);
+        drop = std::min(drop, mTargetFrames - 8);
+        if (drop > 0) {
+            mTargetFrames -= drop;
+            mFillSmoothed -= drop;
+            ++mDrops;
+        } else {
+            drop = 0;
+        }
+    }
+
+    // Taps for this callback, linearized; tap k + 1 is the frame at or before the read point
+    const size_t scratchFrames = mScratch.size() / channels;
+    const int32_t maxOut = (int32_t) std::min<size_t>((size_t) numFrames,
+                                                      scratchFrames - mMaxDropFrames - 8);
+    const size_t needed = (size_t) (mPhase + maxOut * mRatio) + drop + 4;
+    const int32_t have = (int32_t) (mRing.peek(mScratch.data(), std::min(needed, scratchFrames) * channels) /
+                                    channels);
+    const float *x = mScratch.data();
+
+    // A drop reads ahead by drop frames, fading in from where the stream was
+    const int32_t fadeFrames = std::min(kDropFadeFrames, maxOut);
+    double position = mPhase;
+    int32_t produced = 0;
+    for (; produced < maxOut; ++produced) {
+        double ahead = position + drop;
+        if ((int32_t) ahead + 4 > have) break;
+        float *frame = output + (size_t) produced * channels;
+        for (int32_t c = 0; c < channels; ++c) {
+            float y = interpolate(x + c, ahead, channels);
+            if (drop > 0 && produced < fadeFrames) {
+                float g = (float) produced / fadeFrames;
+                float old = interpolate(x + c, position, channels);
+                y = old + g * (y - old);
+            }
+            frame[c] = y;
+        }
+        position += mRatio;
+    }
+
+    position += drop;
+    int32_t advance = (int32_t) position;
+    mRing.consume((size_t) advance * channels);
+    mPhase = position - advance;
+
+    if (produced < numFrames) {
+        std::fill(output + (size_t) produced * channels, output + (size_t) numFrames * channels, 0.0f);
+        ++mUnderruns;
+        mPrimed = false;
+        mIntegral = 0.0;
+        if (mLatencyControl) {
+            // Not enough margin: widen it and re-prime to a higher target
+            mJitter.noteUnderrun();
+            mTargetFrames = std::min(mMaxTargetFrames, mTargetFrames + mJitter.getMargin());
+        }
+    }
+    return produced;
+}
+
+void DriftCompensator::updateRatio(int32_t numFrames) {
+    const double dt = (double) numFrames / mSampleRate;
+    const double fill = (double) bufferedFrames() - mPhase;
+    mFillSmoothed += (1.0 - std::exp(-dt / kFillTimeConstant)) * (fill - mFillSmoothed);
+
+    // d(fill)/dt = rate * (drift - correction), so these gains give the loop natural
+    // frequency kLoopOmega and damping kLoopDamping independent of the sample rate
+    const double kp = 2.0 * kLoopDamping * kLoopOmega / mSampleRate;
+    const double ki = kLoopOmega * kLoopOmega / mSampleRate;
+    const double maxCorrection = kMaxCorrectionPpm * 1e-6;
+
+    const double error = mFillSmoothed - mTargetFrames;
+    mIntegral += error * dt;
+    mIntegral = std::max(-maxCorrection / ki, std::min(maxCorrection / ki, mIntegral));
+    const double correction = kp * error + ki * mIntegral;
+    mRatio = 1.0 + std::max(-maxCorrection, std::min(maxCorrection, correction));
+}
@@ -0,0 +1,91 @@
+#ifndef OBOEPASSTHROUGH_DRIFTCOMPENSATOR_H
+#define OBOEPASSTHROUGH_DRIFTCOMPENSATOR_H
+
+#include <cstdint>
+#include <vector>
+
+#include "JitterTracker.h"
+#include "SpscRingBuffer.h"
+
+/**
+ * Absorbs the clock mismatch between the mic and the DAC.
+ *
+ * Mic frames are written in as they arrive (any amount per callback); read() then
+ * produces exactly the frames the output callback needs, resampling by a ratio within
+ * +-kMaxCorrectionPpm of 1. A PI loop on the smoothed fill level steers the ratio so
+ * the backlog, and with it the added latency, settles at the target instead of
+ * drifting into dropouts or growing delay.
+ *
+ * The resampler is a cubic Lagrange interpolator in Farrow form: four taps and three
+ * multiply-adds per output frame, no tables. At ratios this close to 1 its images sit
+ * far below the noise floor.
+ *
+ * With latency control on (the default), the target itself is minimized: a JitterTracker
+ * watches the headroom left after each read, and surplus beyond its safety margin is
+ * dropped at once with a short crossfade and taken off the target. An underrun widens the
+ * margin and raises the target by a step; quiet periods let the margin shrink again.
+ *
+ * Hard corrections are a last resort: a backlog far beyond the target is dropped back to
+ * it, and a starved read is zero-filled and re-primes.
+ *
+ * Frames are interleaved across the configured channels. Every channel is interpolated
+ * at the same read position, so they stay sample-aligned.
+ *
+ * configure() allocates; write() and read() are real-time safe and must be called from
+ * one thread.
+ */
+class DriftCompensator {
+public:
+    static constexpr double kMaxCorrectionPpm = 1000.0;
+    static constexpr int32_t kDropFadeFrames = 64;
+
+    // targetFrames is the starting backlog; latency control works down from there.
+    void configure(int32_t sampleRate, int32_t targetFrames, int32_t maxCallbackFrames,
+                   int32_t channels = 1);
+    // Off: hold the configured target. Takes effect at the next configure().
+    void setLatencyControl(bool enabled) { mLatencyControl = enabled; }
+
+    // Returns the number of frames accepted; on overflow the oldest are dropped.
+    int32_t write(const float *input, int32_t numFrames);
+
+    // Always fills numFrames; returns how many came from the mic rather than zero-fill.
+    int32_t read(float *output, int32_t numFrames);
+
+    int32_t getTargetFrames() const { return mTargetFrames; }
+    int32_t getMarginFrames() const { return mJitter.getMargin(); }
+    int64_t getDrops() const { return mDrops; }
+    // Frames buffered ahead of the interpolation point, smoothed.
+    double getFillFrames() const { return mFillSmoothed; }
+    // Positive when the mic runs fast and its frames are consumed faster than real time.
+    double getCorrectionPpm() const { return (mRatio - 1.0) * 1e6; }
+    int32_t getChannelCount() const { return mChannels; }
+    int64_t getUnderruns() const { return mUnderruns; }
+    int64_t getSlips() const { return mSlips; }
+
+private:
+    void updateRatio(int32_t numFrames);
+    size_t bufferedFrames() const { return mRing.availableToRead() / mChannels; }
+    // x is one channel's first tap; frames are stride samples apart
+    static float interpolate(const float *x, double position, int32_t stride);
+
+    SpscRingBuffer<float> mRing;
+    std::vector<float> mScratch;
+    int32_t mSampleRate = 48000;
+    int32_t mChannels = 1;
+    int32_t mTargetFrames = 0;
+    int32_t mSlipFrames = 0;
+    int32_t mMaxTargetFrames = 0;
+    int32_t mMaxDropFrames = 0;
+    bool mLatencyControl = true;
+    JitterTracker mJitter;
+    bool mPrimed = false;
+    double mPhase = 0.0;            // fractional read position between taps 1 and 2
+    double mRatio = 1.0;            // input frames consumed per output frame
+    double mFillSmoothed = 0.0;
+    double mIntegral = 0.0;         // frame-seconds
+    int64_t mUnderruns = 0;
+    int64_t mSlips = 0;
+    int64_t mDrops = 0;
+};
+
+#endif //OBOEPASSTHROUGH_DRIFTCOMPENSATOR_H
@@ -0,0 +1,35 @@
+#include "DspArena.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+DspArena::~DspArena() {
+    if (mBase) {
+        ::operator delete(mBase, std::align_val_t(kAlignment));
+    }
+}
+
+void DspArena::allocate(size_t bytes) {
+    if (mBase) {
+        ::operator delete(mBase, std::align_val_t(kAlignment));
+        mBase = nullptr;
+    }
+    // Keep even an empty arena out of sizing mode
+    mCapacity = (bytes + kAlignment - 1) / kAlignment * kAlignment;
+    mBase = static_cast<uint8_t *>(::operator new(std::max<size_t>(mCapacity, kAlignment),
+                                                  std::align_val_t(kAlignment)));
+    std::memset(mBase, 0, mCapacity);
+    mUsed = 0;
+}
+
+void *DspArena::takeBytes(size_t bytes) {
+    const size_t offset = (mUsed + kAlignment - 1) / kAlignment * kAlignment;
+    if (!mBase) {
+        mUsed = offset + bytes;
+        return nullptr;
+    }
+    if (offset + bytes > mCapacity) return nullptr;
+    mUsed = offset + bytes;
+    return mBase + offset;
+}
@@ -0,0 +1,73 @@
+#ifndef OBOEPASSTHROUGH_DSPARENA_H
+#define OBOEPASSTHROUGH_DSPARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "fft_backend.h"
+
+/**
+ * One cache-line-aligned block that a processor's buffers, ring storage and FFT plans are
+ * carved from, so setup makes a single allocation and the audio path never touches the
+ * heap.
+ *
+ * The layout is a function that take()s every region in a fixed order. build() runs it
+ * twice: on an empty arena, where take() returns null and only adds up the sizes, then on
+ * storage of exactly that size. Every region starts on its own cache line, so vector
+ * loads are aligned and neighbouring buffers never share a line.
+ *
+ * build() and allocate() are not real-time safe; take() never allocates.
+ */
+class DspArena {
+public:
+    static constexpr size_t kAlignment = 64;
+
+    DspArena() = default;
+    ~DspArena();
+
+    DspArena(const DspArena &) = delete;
+    DspArena &operator=(const DspArena &) = delete;
+
+    // Runs layout(arena) once to size the arena and again to carve it.
+    template <typename Layout>
+    void build(Layout &&layout) {
+        DspArena sizing;
+        layout(sizing);
+        allocate(sizing.used());
+        layout(*this);
+    }
+
+    // Replaces the storage with bytes zeroed bytes and rewinds. Earlier regions are gone.
+    void allocate(size_t bytes);
+
+    // The next bytes, cache-line aligned. Null while sizing, or if the arena is too small
+    // for the layout (a layout that changed between the two passes).
+    void *takeBytes(size_t bytes);
+
+    template <typename T>
+    T *take(size_t count) {
+        static_assert(std::is_trivially_destructible<T>::value, "the arena never runs destructors");
+        return static_cast<T *>(takeBytes(count * sizeof(T)));
+    }
+
+    bool isSizing() const { return mBase == nullptr; }
+    size_t used() const { return mUsed; }
+    size_t capacity() const { return mCapacity; }
+
+private:
+    uint8_t *mBase = nullptr;
+    size_t mCapacity = 0;
+    size_t mUsed = 0;
+};
+
+// An FFT plan placed through kiss's mem/lenmem contract; null while sizing. Released with
+// the arena, never with fft_backend_free.
+inline fft_backend_cfg takeFftPlan(DspArena &arena, int nfft, int inverse) {
+    size_t bytes = 0;
+    fft_backend_alloc(nfft, inverse, nullptr, &bytes);
+    void *mem = arena.takeBytes(bytes);
+    return mem ? fft_backend_alloc(nfft, inverse, mem, &bytes) : nullptr;
+}
+
+#endif //OBOEPASSTHROUGH_DSPARENA_H
@@ -0,0 +1,60 @@
+#include "FirDesign.h"
+
+#include <cmath>
+
+namespace {
+
+// Ideal low-pass impulse response with cutoff fc (cycles/sample) at offset x from centre.
+double lowPassTap(double fc, double x) {
+    if (fc <= 0.0) return 0.0;
+    if (x == 0.0) return 2.0 * fc;
+    return sin(2.0 * M_PI * fc * x) / (M_PI * x);
+}
+
+// Zeroth-order modified Bessel function of the first kind, by its power series.
+double besselI0(double x) {
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 64 && term > 1e-12 * sum; ++k) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+} // namespace
+
+namespace FirDesign {
+
+std::vector<float> bandPass(float lowHz, float highHz, int32_t sampleRate, int32_t numTaps) {
+    std::vector<float> taps(numTaps);
+    const double nyquist = 0.5 * sampleRate;
+    const double fl = lowHz > 0.0f ? lowHz / (double) sampleRate : 0.0;
+    const double fh = highHz < nyquist ? highHz / (double) sampleRate : 0.5;
+    const double centre = 0.5 * (numTaps - 1);
+
+    for (int32_t n = 0; n < numTaps; ++n) {
+        double x = n - centre;
+        double ideal = lowPassTap(fh, x) - lowPassTap(fl, x);
+        double phase = numTaps > 1 ? 2.0 * M_PI * n / (numTaps - 1) : 0.0;
+        double window = 0.42 - 0.5 * cos(phase) + 0.08 * cos(2.0 * phase);
+        taps[n] = static_cast<float>(ideal * window);
+    }
+    return taps;
+}
+
+std::vector<double> kaiserLowPass(double cutoff, int32_t numTaps, double beta) {
+    std::vector<double> taps(numTaps);
+    const double centre = 0.5 * (numTaps - 1);
+    const double norm = besselI0(beta);
+    double sum = 0.0;
+    for (int32_t n = 0; n < numTaps; ++n) {
+        double r = numTaps > 1 ? (n - centre) / centre : 0.0;
+        double window = besselI0(beta * sqrt(std::fmax(1.0 - r * r, 0.0))) / norm;
+        taps[n] = lowPassTap(cutoff, n - centre) * window;
+        sum += taps[n];
+    }
+    for (double &t : taps) t /= sum;
+    return taps;
+}
+
+} // namespace FirDesign
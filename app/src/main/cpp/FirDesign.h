@@ -0,0 +1,25 @@
+#ifndef OBOEPASSTHROUGH_FIRDESIGN_H
+#define OBOEPASSTHROUGH_FIRDESIGN_H
+
+#include <cstdint>
+#include <vector>
+
+namespace FirDesign {
+
+/**
+ * Linear-phase windowed-sinc band-pass (Blackman window).
+ * lowHz <= 0 gives a low-pass, highHz >= sampleRate / 2 gives a high-pass.
+ * Group delay is (numTaps - 1) / 2 samples.
+ */
+std::vector<float> bandPass(float lowHz, float highHz, int32_t sampleRate, int32_t numTaps);
+
+/**
+ * Linear-phase windowed-sinc low-pass with a Kaiser window, cutoff in cycles per sample.
+ * The stopband is about 8.7 * beta dB down beyond a transition of roughly
+ * (8.7 * beta - 8) / (14.36 * numTaps) cycles per sample; unity DC gain.
+ */
+std::vector<double> kaiserLowPass(double cutoff, int32_t numTaps, double beta);
+
+} // namespace FirDesign
+
+#endif //OBOEPASSTHROUGH_FIRDESIGN_H
@@ -0,0 +1,215 @@
+#include "FixedSpectralProcessor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+kiss_fftr_q31_cfg takeQ31Plan(DspArena &arena, int nfft, int inverse) {
+    size_t bytes = 0;
+    kiss_fftr_q31_alloc(nfft, inverse, nullptr, &bytes);
+    void *mem = arena.takeBytes(bytes);
+    return mem ? kiss_fftr_q31_alloc(nfft, inverse, mem, &bytes) : nullptr;
+}
+
+// Largest bin part the inverse can take: its first pass adds half of two bins to their
+// rotated difference, up to about 2.8 times a part, and the butterflies need that in int32
+constexpr int64_t kBinLimit = (int64_t) 1 << 29;
+
+// Bits to give up so a full-scale tone still fits under kBinLimit: once the gain has undone
+// kiss's scaling, a windowed tone's bin carries hop / 2 times its Q30 amplitude
+int32_t headroomBits(int32_t hopSize) {
+    int32_t bits = 0;
+    while ((1 << bits) < hopSize) ++bits;
+    return bits;
+}
+
+inline int16_t saturate16(int64_t x) {
+    return (int16_t) std::clamp<int64_t>(x, INT16_MIN, INT16_MAX);
+}
+
+inline int32_t saturate32(int64_t x) {
+    return (int32_t) std::clamp<int64_t>(x, INT32_MIN, INT32_MAX);
+}
+
+// An overlap-added Q30 sum back to int16. The sum is taken in int64 so two near-full-scale
+// frames cannot wrap; hops of 2^15 and up leave no bits to shift out, so shift may be <= 0.
+inline int16_t toSample(int64_t sum, int32_t shift) {
+    if (shift <= 0) return saturate16(sum * ((int64_t) 1 << -shift));
+    return saturate16((sum + ((int64_t) 1 << (shift - 1))) >> shift);
+}
+
+} // namespace
+
+FixedSpectralProcessor::FixedSpectralProcessor(const SpectralProcessor::Config &config,
+                                               int32_t sampleRate) :
+        mConfig(config.sanitized()),
+        mFftSize(mConfig.fftSize),
+        mHopSize(mConfig.hopSize()),
+        mHeadroomBits(headroomBits(mHopSize)),
+        mInputCapacity(SpscRingBuffer<int16_t>::capacityFor(mFftSize * 2)),
+        mOutputCapacity(SpscRingBuffer<int16_t>::capacityFor(mFftSize * 8)) {
+    mArena.build([this](DspArena &arena) { layout(arena); });
+
+    // The float path's periodic windows, quantized; the normalization uses the quantized sum
+    int64_t windowSum = 0;
+    for (int i = 0; i < mFftSize; ++i) {
+        float phase = 2.0f * M_PI * i / mFftSize;
+        float w;
+        switch (mConfig.window) {
+            case SpectralProcessor::WindowType::Hamming:
+                w = 0.54f - 0.46f * cosf(phase);
+                break;
+            case SpectralProcessor::WindowType::Blackman:
+                w = 0.42f - 0.5f * cosf(phase) + 0.08f * cosf(2.0f * phase);
+                break;
+            default:
+                w = 0.5f - 0.5f * cosf(phase);
+                break;
+        }
+        mWindow[i] = (int16_t) std::clamp(lrintf(w * INT16_MAX), 0L, (long) INT16_MAX);
+        windowSum += mWindow[i];
+    }
+    mNormalization = (float) mHopSize * INT16_MAX / (float) windowSum;
+
+    mGainTable.setFftSize(mFftSize, sampleRate);
+    publishGains();
+    reset();
+}
+
+void FixedSpectralProcessor::layout(DspArena &arena) {
+    mWindow = arena.take<int16_t>(mFftSize);
+    mFrame = arena.take<int32_t>(mFftSize);
+    mSpectrum = arena.take<kiss_fft_q31_cpx>(mFftSize / 2 + 1);
+    mOverlap = arena.take<int32_t>(mFftSize - mHopSize);
+    mFftCfg = takeQ31Plan(arena, mFftSize, 0);
+    mIfftCfg = takeQ31Plan(arena, mFftSize, 1);
+    mInputStorage = arena.take<int16_t>(mInputCapacity);
+    mOutputStorage = arena.take<int16_t>(mOutputCapacity);
+}
+
+void FixedSpectralProcessor::setGainCurve(std::vector<SpectralGainTable::GainPoint> points) {
+    mGainTable.setGainCurve(std::move(points));
+    publishGains();
+}
+
+void FixedSpectralProcessor::publishGains() {
+    // Undo both transforms' 1/N, normalize the overlap, leave the headroom
+    const std::vector<float> &gains = mGainTable.getBinGains();
+    const double scale = (double) mFftSize * mNormalization * std::ldexp(1.0, 16 - mHeadroomBits);
+    Table &table = mTables.writeBuffer();
+    table.gains.resize(gains.size());
+    table.active = SpectralGainTable::BinRange();
+    for (size_t k = 0; k < gains.size(); ++k) {
+        double q = std::min(std::round(gains[k] * scale), (double) INT32_MAX);
+        table.gains[k] = (int32_t) q;
+        if (table.gains[k] != 0) {
+            if (table.active.end == 0) table.active.begin = (int32_t) k;
+            table.active.end = (int32_t) k + 1;
+        }
+    }
+    mTables.publish();
+}
+
+void FixedSpectralProcessor::reset() {
+    mInputRing.reset(mInputStorage, mInputCapacity);
+    mOutputFIFO.reset(mOutputStorage, mOutputCapacity);
+    std::fill(mOverlap, mOverlap + (mFftSize - mHopSize), 0);
+    mFlow = SpectralProcessor::Flow();
+    mPrimed = false;
+    mLatencyFrames = 0;
+}
+
+int32_t FixedSpectralProcessor::process(const int16_t *input, int32_t numInput,
+                                        int16_t *output, int32_t numOutput) {
+    // Ring handling as in SpectralProcessor::process()
+    mFlow.inputDropped = 0;
+    mFlow.outputDropped = 0;
+    size_t space = mInputRing.availableToWrite();
+    if ((size_t) numInput > space) {
+        mFlow.inputDropped = (int32_t) mInputRing.consume(numInput - space);
+    }
+    mInputRing.write(input, numInput);
+
+    while (mInputRing.availableToRead() >= (size_t) mFftSize) {
+        processFrame();
+    }
+
+    int32_t toCopy = static_cast<int32_t>(mOutputFIFO.read(output, numOutput));
+    if (toCopy < numOutput) {
+        std::fill(output + toCopy, output + numOutput, 0);
+    }
+    mFlow.underrunFrames = mPrimed ? numOutput - toCopy : 0;
+    mLatencyFrames += numOutput - toCopy - mFlow.inputDropped - mFlow.outputDropped;
+    mPrimed = mPrimed || toCopy > 0;
+    mFlow.inputDepth = (int32_t) mInputRing.availableToRead();
+    mFlow.outputDepth = (int32_t) mOutputFIFO.availableToRead();
+    return toCopy;
+}
+
+void FixedSpectralProcessor::processFrame() {
+    // Q15 sample times Q15 window: Q30, exact
+    auto block = mInputRing.readSpans(mFftSize);
+    for (size_t n = 0; n < block.firstSize; ++n) {
+        mFrame[n] = block.first[n] * mWindow[n];
+    }
+    const int16_t *w = mWindow + block.firstSize;
+    for (size_t n = 0; n < block.secondSize; ++n) {
+        mFrame[block.firstSize + n] = block.second[n] * w[n];
+    }
+    kiss_fftr_q31(mFftCfg, mFrame, mSpectrum);
+
+    // Q16 gains; zero outside the active band
+    const Table &table = mTables.read();
+    const int32_t bins = mFftSize / 2 + 1;
+    const int32_t *g = table.gains.data();
+    std::fill(mSpectrum, mSpectrum + table.active.begin, kiss_fft_q31_cpx{0, 0});
+    int64_t peak = 0;
+    for (int32_t k = table.active.begin; k < table.active.end; ++k) {
+        peak = std::max(peak, std::abs((int64_t) mSpectrum[k].r * g[k]));
+        peak = std::max(peak, std::abs((int64_t) mSpectrum[k].i * g[k]));
+    }
+    if (peak <= kBinLimit << 16) {
+        for (int32_t k = table.active.begin; k < table.active.end; ++k) {
+            mSpectrum[k].r = (int32_t) (((int64_t) mSpectrum[k].r * g[k] + (1 << 15)) >> 16);
+            mSpectrum[k].i = (int32_t) (((int64_t) mSpectrum[k].i * g[k] + (1 << 15)) >> 16);
+        }
+    } else {
+        // Too loud for the inverse: turn the whole frame down, so it keeps its shape
+        const double scale = (double) kBinLimit / (double) peak;
+        for (int32_t k = table.active.begin; k < table.active.end; ++k) {
+            mSpectrum[k].r = (int32_t) std::llround((double) mSpectrum[k].r * g[k] * scale);
+            mSpectrum[k].i = (int32_t) std::llround((double) mSpectrum[k].i * g[k] * scale);
+        }
+    }
+    std::fill(mSpectrum + table.active.end, mSpectrum + bins, kiss_fft_q31_cpx{0, 0});
+    kiss_fftri_q31(mIfftCfg, mSpectrum, mFrame);
+
+    // Overlap-add in int64, back to int16 with rounding and saturation
+    const int32_t hop = mHopSize;
+    const int32_t tail = mFftSize - hop;
+    const int32_t shift = 15 - mHeadroomBits;
+    size_t room = mOutputFIFO.availableToWrite();
+    if ((size_t) hop > room) {
+        mFlow.outputDropped += (int32_t) mOutputFIFO.consume(hop - room);
+    }
+    auto spans = mOutputFIFO.writeSpans(hop);
+    const int32_t first = (int32_t) spans.firstSize;
+    for (int32_t i = 0; i < first; ++i) {
+        spans.first[i] = toSample((int64_t) mFrame[i] + mOverlap[i], shift);
+    }
+    for (int32_t i = first; i < hop; ++i) {
+        spans.second[i - first] = toSample((int64_t) mFrame[i] + mOverlap[i], shift);
+    }
+    mOutputFIFO.commitWrite(hop);
+
+    const int32_t carried = tail - hop;
+    for (int32_t i = 0; i < carried; ++i) {
+        mOverlap[i] = saturate32((int64_t) mFrame[hop + i] + mOverlap[hop + i]);
+    }
+    for (int32_t i = carried; i < tail; ++i) {
+        mOverlap[i] = mFrame[hop + i];
+    }
+    mInputRing.consume(hop);
+}
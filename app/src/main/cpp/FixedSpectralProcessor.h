@@ -0,0 +1,91 @@
+#ifndef OBOEPASSTHROUGH_FIXEDSPECTRALPROCESSOR_H
+#define OBOEPASSTHROUGH_FIXEDSPECTRALPROCESSOR_H
+
+#include <cstdint>
+#include <vector>
+
+#include "DspArena.h"
+#include "kiss_fftr_q31.h"
+#include "SpectralGainTable.h"
+#include "SpectralProcessor.h"
+#include "SpscRingBuffer.h"
+#include "TripleBuffer.h"
+
+/**
+ * The Spectral path in fixed point, for cores where float throughput or power is what
+ * runs out first (low-end armeabi-v7a): int16 in and out, and the same STFT as
+ * SpectralProcessor (window, real FFT, prescription gain, overlap-add) in integer math.
+ *
+ * Each Q15 sample times its Q15 window tap is a Q30 frame sample, with no rounding, and
+ * the transforms are kiss_fftr_q31. Both of those directions divide by the size, so the
+ * Q16 per-bin gains put back the size and the overlap normalization, less 2^headroomBits.
+ * The headroom grows with the frame's coherent gain (the hop). A frame with a bin too loud
+ * for the inverse transform is turned down as a whole, which keeps its shape; the int16
+ * output would clip there anyway. The overlap-add accumulates in int64 and rounds to int16
+ * with saturation.
+ *
+ * There is no compressor; WDRC stays on the float path. Latency and ring behaviour match
+ * SpectralProcessor. Buffers, plans and rings come from one DspArena, and process() does
+ * not allocate.
+ */
+class FixedSpectralProcessor {
+public:
+    FixedSpectralProcessor(const SpectralProcessor::Config &config, int32_t sampleRate);
+
+    FixedSpectralProcessor(const FixedSpectralProcessor &) = delete;
+    FixedSpectralProcessor &operator=(const FixedSpectralProcessor &) = delete;
+
+    // ---- control thread ----
+    // Rebuilt here, picked up by the next frame.
+    void setGainCurve(std::vector<SpectralGainTable::GainPoint> points);
+
+    // Empties the rings and clears all signal history. Only while nothing else is using
+    // the processor.
+    void reset();
+
+    // ---- audio thread ----
+    // Same contract as SpectralProcessor::process().
+    int32_t process(const int16_t *input, int32_t numInput, int16_t *output, int32_t numOutput);
+
+    const SpectralProcessor::Flow &getLastFlow() const { return mFlow; }
+    int32_t getLatencyFrames() const { return mPrimed ? mLatencyFrames : 0; }
+    const SpectralProcessor::Config &getConfig() const { return mConfig; }
+    int32_t getHeadroomBits() const { return mHeadroomBits; }
+
+private:
+    void layout(DspArena &arena);
+    void publishGains();
+    void processFrame();
+
+    const SpectralProcessor::Config mConfig;
+    const int32_t mFftSize;
+    const int32_t mHopSize;
+    const int32_t mHeadroomBits;
+    const size_t mInputCapacity;
+    const size_t mOutputCapacity;
+    float mNormalization = 0.0f;        // hop / sum(window), for the gain table
+    DspArena mArena;                    // backs the buffers, plans and ring storage below
+    int16_t *mWindow = nullptr;         // Q15
+    int32_t *mFrame = nullptr;          // Q30 windowed input, then the inverse transform
+    kiss_fft_q31_cpx *mSpectrum = nullptr;
+    int32_t *mOverlap = nullptr;        // fftSize - hop frames still to be added to
+    kiss_fftr_q31_cfg mFftCfg = nullptr;
+    kiss_fftr_q31_cfg mIfftCfg = nullptr;
+    int16_t *mInputStorage = nullptr;
+    int16_t *mOutputStorage = nullptr;
+    SpscRingBuffer<int16_t> mInputRing;
+    SpscRingBuffer<int16_t> mOutputFIFO;
+
+    SpectralGainTable mGainTable;       // control thread: the float gains to convert
+    struct Table {
+        std::vector<int32_t> gains;     // Q16, one per bin
+        SpectralGainTable::BinRange active;
+    };
+    TripleBuffer<Table> mTables;
+
+    SpectralProcessor::Flow mFlow;
+    bool mPrimed = false;
+    int32_t mLatencyFrames = 0;
+};
+
+#endif //OBOEPASSTHROUGH_FIXEDSPECTRALPROCESSOR_H
@@ -0,0 +1,71 @@
+#include "Interleave.h"
+
+#include <cstring>
+
+#include "SimdVec4.h"
+
+namespace Interleave {
+
+void toPlanar(const float *interleaved, int32_t channels, int32_t numFrames, float *const *planar) {
+    int32_t i = 0;
+    if (channels == 1) {
+        if (numFrames > 0) std::memcpy(planar[0], interleaved, (size_t) numFrames * sizeof(float));
+        return;
+    } else if (channels == 2) {
+        float *left = planar[0], *right = planar[1];
+        for (; i + 4 <= numFrames; i += 4) {
+            simd::vec4 l, r;
+            simd::loadDeinterleave(interleaved + 2 * i, l, r);
+            simd::store(left + i, l);
+            simd::store(right + i, r);
+        }
+    } else if (channels == 4) {
+        for (; i + 4 <= numFrames; i += 4) {
+            // Four frames as rows; transposed, each row is one channel
+            const float *p = interleaved + 4 * i;
+            simd::vec4 r0 = simd::load(p), r1 = simd::load(p + 4);
+            simd::vec4 r2 = simd::load(p + 8), r3 = simd::load(p + 12);
+            simd::transpose(r0, r1, r2, r3);
+            simd::store(planar[0] + i, r0);
+            simd::store(planar[1] + i, r1);
+            simd::store(planar[2] + i, r2);
+            simd::store(planar[3] + i, r3);
+        }
+    }
+    for (; i < numFrames; ++i) {
+        for (int32_t c = 0; c < channels; ++c) {
+            planar[c][i] = interleaved[i * channels + c];
+        }
+    }
+}
+
+void fromPlanar(const float *const *planar, int32_t channels, int32_t numFrames, float *interleaved) {
+    int32_t i = 0;
+    if (channels == 1) {
+        if (numFrames > 0) std::memcpy(interleaved, planar[0], (size_t) numFrames * sizeof(float));
+        return;
+    } else if (channels == 2) {
+        const float *left = planar[0], *right = planar[1];
+        for (; i + 4 <= numFrames; i += 4) {
+            simd::storeInterleave(interleaved + 2 * i, simd::load(left + i), simd::load(right + i));
+        }
+    } else if (channels == 4) {
+        for (; i + 4 <= numFrames; i += 4) {
+            simd::vec4 r0 = simd::load(planar[0] + i), r1 = simd::load(planar[1] + i);
+            simd::vec4 r2 = simd::load(planar[2] + i), r3 = simd::load(planar[3] + i);
+            simd::transpose(r0, r1, r2, r3);
+            float *p = interleaved + 4 * i;
+            simd::store(p, r0);
+            simd::store(p + 4, r1);
+            simd::store(p + 8, r2);
+            simd::store(p + 12, r3);
+        }
+    }
+    for (; i < numFrames; ++i) {
+        for (int32_t c = 0; c < channels; ++c) {
+            interleaved[i * channels + c] = planar[c][i];
+        }
+    }
+}
+
+} // namespace Interleave
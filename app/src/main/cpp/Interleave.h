@@ -0,0 +1,23 @@
+#ifndef OBOEPASSTHROUGH_INTERLEAVE_H
+#define OBOEPASSTHROUGH_INTERLEAVE_H
+
+#include <cstdint>
+
+/**
+ * Conversion between interleaved frames, as a stream delivers them (L R L R ...), and
+ * one contiguous (planar) buffer per channel, which is how the per-channel DSP runs.
+ *
+ * Two and four channels go four frames at a time on NEON / SSE2 (see SimdVec4.h). Two
+ * channels use the deinterleaving loads and stores; four use a 4 x 4 transpose. Other
+ * counts, and the tails, are scalar. One channel is a copy. The planar buffers must not
+ * overlap the interleaved one. Real-time safe.
+ */
+namespace Interleave {
+
+void toPlanar(const float *interleaved, int32_t channels, int32_t numFrames, float *const *planar);
+
+void fromPlanar(const float *const *planar, int32_t channels, int32_t numFrames, float *interleaved);
+
+} // namespace Interleave
+
+#endif //OBOEPASSTHROUGH_INTERLEAVE_H
@@ -0,0 +1,65 @@
+#include "JitterTracker.h"
+
+#include <algorithm>
+
+void JitterTracker::configure(int32_t windowFrames, int32_t minMargin, int32_t maxMargin,
+                              int32_t marginStep) {
+    mWindowFrames = std::max(windowFrames, 1);
+    mMinMargin = minMargin;
+    mMaxMargin = std::max(maxMargin, minMargin);
+    mMarginStep = std::max(marginStep, 4);
+    mMargin = mMinMargin;
+    reset();
+}
+
+void JitterTracker::reset() {
+    mFramesInWindow = 0;
+    mCurrentMin = kNoSlack;
+    mPreviousMin = kNoSlack;
+    mCurrentMaxChunk = 0;
+    mPreviousMaxChunk = 0;
+    mUnderrunInWindow = false;
+    mDecay = 0;
+}
+
+int32_t JitterTracker::update(int32_t slackFrames, int32_t numFrames) {
+    mCurrentMin = std::min(mCurrentMin, slackFrames);
+    mFramesInWindow += numFrames;
+    if (mFramesInWindow < mWindowFrames) {
+        return 0;
+    }
+
+    // Window complete
+    if (!mUnderrunInWindow) {
+        mDecay += mMarginStep;
+        int32_t steps = mDecay / 4;
+        mDecay -= steps * 4;
+        mMargin = std::max(mMinMargin, mMargin - steps);
+    }
+    int32_t minSlack = std::min(mCurrentMin, mPreviousMin);
+    const int32_t margin = getMargin();
+    mPreviousMin = mCurrentMin;
+    mCurrentMin = kNoSlack;
+    mPreviousMaxChunk = mCurrentMaxChunk;
+    mCurrentMaxChunk = 0;
+    mFramesInWindow = 0;
+    mUnderrunInWindow = false;
+
+    int32_t surplus = minSlack == kNoSlack ? 0 : minSlack - margin;
+    if (surplus < kHysteresisFrames) {
+        return 0;
+    }
+    // Slack seen so far no longer applies once the owner drops
+    mPreviousMin = kNoSlack;
+    return surplus;
+}
+
+void JitterTracker::noteUnderrun() {
+    mMinMargin = std::min(mMaxMargin, mMinMargin + mMarginStep / 2);
+    mMargin = std::min(mMaxMargin, mMargin + mMarginStep);
+    mDecay = 0;
+    mUnderrunInWindow = true;
+    mCurrentMin = kNoSlack;
+    mPreviousMin = kNoSlack;
+    mFramesInWindow = 0;
+}
@@ -0,0 +1,61 @@
+#ifndef OBOEPASSTHROUGH_JITTERTRACKER_H
+#define OBOEPASSTHROUGH_JITTERTRACKER_H
+
+#include <algorithm>
+#include <cstdint>
+
+/**
+ * Decides how much buffered audio is surplus. The owner reports its headroom ("slack":
+ * frames still buffered beyond what the callback needs) once per callback; the tracker
+ * keeps the minimum over two consecutive windows, which covers the arrival jitter seen
+ * recently, and reports anything beyond the safety margin as droppable.
+ *
+ * The margin grows by a step on every underrun and decays by a quarter step per quiet
+ * window, but never below a floor that each underrun raises by half a step, so after a
+ * few misses it settles just above the jitter the device actually shows instead of
+ * cycling between trimming and underrunning.
+ *
+ * The owner can also report the size of each chunk it receives (noteChunk). The largest
+ * over the same two windows is a second floor under the margin, since the backlog is only
+ * seen at that granularity. It lapses as soon as the chunk leaves the windows, so a
+ * one-off large delivery (priming, catch-up after a stall) doesn't hold latency up.
+ *
+ * Plain arithmetic; called only from the audio thread.
+ */
+class JitterTracker {
+public:
+    void configure(int32_t windowFrames, int32_t minMargin, int32_t maxMargin, int32_t marginStep);
+    void reset();
+
+    // Returns frames the owner may drop now (usually 0).
+    int32_t update(int32_t slackFrames, int32_t numFrames);
+    void noteUnderrun();
+    // A chunk of this many frames arrived; the margin stays at least that for two windows.
+    void noteChunk(int32_t frames) { mCurrentMaxChunk = std::max(mCurrentMaxChunk, frames); }
+
+    int32_t getMargin() const {
+        const int32_t chunk = std::max(mCurrentMaxChunk, mPreviousMaxChunk);
+        return std::max(mMargin, std::min(mMaxMargin, chunk));
+    }
+
+private:
+    static constexpr int32_t kNoSlack = 1 << 30;
+    // Surplus below this isn't worth a crossfade
+    static constexpr int32_t kHysteresisFrames = 8;
+
+    int32_t mWindowFrames = 48000;
+    int32_t mMinMargin = 0;
+    int32_t mMaxMargin = 0;
+    int32_t mMarginStep = 0;
+    int32_t mMargin = 0;
+    int32_t mDecay = 0;             // quarter steps waiting to be taken off the margin
+
+    int32_t mFramesInWindow = 0;
+    int32_t mCurrentMin = kNoSlack;
+    int32_t mPreviousMin = kNoSlack;
+    int32_t mCurrentMaxChunk = 0;
+    int32_t mPreviousMaxChunk = 0;
+    bool mUnderrunInWindow = false;
+};
+
+#endif //OBOEPASSTHROUGH_JITTERTRACKER_H
@@ -0,0 +1,81 @@
+#include "LoadGovernor.h"
+
+#include <algorithm>
+#include <bitset>
+
+void LoadGovernor::configure(int32_t sampleRate, const Params &params) {
+    mSampleRate = std::max(sampleRate, 1);
+    mParams = params;
+    mParams.stepDownCount = std::clamp(mParams.stepDownCount, 1, kWindow);
+    reset();
+}
+
+void LoadGovernor::reset() {
+    mLevel = Level::Full;
+    mHistory = 0;
+    mSettleFrames = 0;
+    mCalmFrames = 0;
+    mSinceStepUpFrames = 0;
+    mLastStepUp = false;
+    mBackoff = 1;
+    mStepDowns = 0;
+    mStepUps = 0;
+}
+
+int64_t LoadGovernor::holdFrames() const {
+    return (int64_t) (mParams.stepUpSeconds * mSampleRate) * mBackoff;
+}
+
+void LoadGovernor::setAvailable(Level level, bool available) {
+    if (level == Level::Full || level == Level::Bypass) return;
+    const uint32_t bit = 1u << (int32_t) level;
+    mAvailable = available ? mAvailable | bit : mAvailable & ~bit;
+}
+
+void LoadGovernor::step(int32_t direction) {
+    int32_t next = (int32_t) mLevel + direction;
+    while (!isAvailable(static_cast<Level>(next))) next += direction;
+    mLevel = static_cast<Level>(next);
+    mHistory = 0;
+    mCalmFrames = 0;
+    mSettleFrames = (int64_t) (mParams.settleSeconds * mSampleRate);
+    mLastStepUp = direction < 0;
+    if (direction < 0) {
+        mSinceStepUpFrames = 0;
+        ++mStepUps;
+    } else {
+        ++mStepDowns;
+    }
+}
+
+bool LoadGovernor::update(int64_t callbackNs, int32_t numFrames) {
+    if (numFrames <= 0) return false;
+    mSinceStepUpFrames += numFrames;
+    if (mSettleFrames > 0) {
+        mSettleFrames -= numFrames;
+        return false;
+    }
+
+    const double load = callbackNs * (double) mSampleRate / (1e9 * numFrames);
+    mHistory = (mHistory << 1) | (load > mParams.stepDownLoad ? 1u : 0u);
+    if (std::bitset<32>(mHistory).count() >= (size_t) mParams.stepDownCount
+            && mLevel != Level::Bypass) {
+        // Pushed back down soon after a step up: that level doesn't fit yet
+        if (mLastStepUp && mSinceStepUpFrames < 2 * holdFrames()) {
+            mBackoff = std::min(2 * mBackoff, kMaxBackoff);
+        }
+        step(+1);
+        return true;
+    }
+
+    // A step up that held for a few holds has earned a quicker next try
+    if (mBackoff > 1 && mSinceStepUpFrames > 4 * holdFrames()) {
+        mBackoff = 1;
+    }
+    mCalmFrames = load < mParams.stepUpLoad ? mCalmFrames + numFrames : 0;
+    if (mLevel != Level::Full && mCalmFrames >= holdFrames()) {
+        step(-1);
+        return true;
+    }
+    return false;
+}
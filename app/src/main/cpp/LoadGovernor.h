@@ -0,0 +1,80 @@
+#ifndef OBOEPASSTHROUGH_LOADGOVERNOR_H
+#define OBOEPASSTHROUGH_LOADGOVERNOR_H
+
+#include <cstdint>
+
+/**
+ * Watches the audio callback's cost against its period and walks a quality ladder: down
+ * one level when callbacks keep coming close to the deadline (thermal throttling, a busy
+ * big core), back up one level after a sustained quiet spell.
+ *
+ * Stepping down takes stepDownCount of the last kWindow callbacks above stepDownLoad;
+ * stepping up takes every callback for stepUpSeconds below the much lower stepUpLoad.
+ * Measurements are ignored for settleSeconds after each step while the new level is
+ * built and crossfaded in. A level that gets stepped down from again soon after it was
+ * stepped up to doubles the hold before the next try (up to kMaxBackoff), so a device
+ * hovering at a boundary doesn't oscillate.
+ *
+ * The governor only decides; the caller maps levels onto its processing, and marks the
+ * levels that would save it nothing as unavailable so they are stepped over. update() is
+ * real-time safe; everything runs on the thread that does the processing.
+ */
+class LoadGovernor {
+public:
+    // Cumulative: each level also keeps the savings of the ones above it.
+    enum class Level : int32_t {
+        Full = 0,
+        SmallerFft = 1,     // half the FFT size
+        FewerBands = 2,     // compressor bands merged in pairs
+        NoCompressor = 3,   // optional stages off
+        Bypass = 4,         // dry passthrough
+    };
+    static constexpr int32_t kNumLevels = 5;
+    static constexpr int32_t kWindow = 32;
+    static constexpr int32_t kMaxBackoff = 8;
+
+    struct Params {
+        float stepDownLoad = 0.7f;      // callback cost / callback period
+        int32_t stepDownCount = 8;      // of the last kWindow callbacks
+        float stepUpLoad = 0.3f;
+        float stepUpSeconds = 2.0f;
+        float settleSeconds = 0.5f;
+    };
+
+    // Starts at Full.
+    void configure(int32_t sampleRate, const Params &params);
+    void configure(int32_t sampleRate) { configure(sampleRate, Params()); }
+    void reset();
+
+    // A level that costs no less than the one above it (no compressor bands to merge, an
+    // FFT already at its smallest) is skipped in both directions. Full and Bypass always
+    // stay available. Kept across configure() and reset().
+    void setAvailable(Level level, bool available);
+    bool isAvailable(Level level) const { return (mAvailable >> (int32_t) level) & 1u; }
+
+    // One callback's cost. Returns true when the level changed.
+    bool update(int64_t callbackNs, int32_t numFrames);
+
+    Level getLevel() const { return mLevel; }
+    int64_t getStepDowns() const { return mStepDowns; }
+    int64_t getStepUps() const { return mStepUps; }
+
+private:
+    void step(int32_t direction);
+    int64_t holdFrames() const;
+
+    Params mParams;
+    int32_t mSampleRate = 48000;
+    Level mLevel = Level::Full;
+    uint32_t mAvailable = (1u << kNumLevels) - 1;   // bit per level
+    uint32_t mHistory = 0;          // bit i set: callback i ago was above stepDownLoad
+    int64_t mSettleFrames = 0;
+    int64_t mCalmFrames = 0;
+    int64_t mSinceStepUpFrames = 0;
+    bool mLastStepUp = false;
+    int32_t mBackoff = 1;
+    int64_t mStepDowns = 0;
+    int64_t mStepUps = 0;
+};
+
+#endif //OBOEPASSTHROUGH_LOADGOVERNOR_H
@@ -0,0 +1,194 @@
+#include "MultibandCompressor.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "SimdVec4.h"
+
+namespace {
+
+// Sum of re^2 + im^2 over bins [begin, end)
+float bandEnergy(const float *spectrum, int32_t begin, int32_t end) {
+    simd::vec4 acc = simd::set1(0.0f);
+    int32_t k = begin;
+    for (; k + 4 <= end; k += 4) {
+        simd::vec4 re, im;
+        simd::loadDeinterleave(spectrum + 2 * k, re, im);
+        acc = simd::madd(re, re, simd::madd(im, im, acc));
+    }
+    float lanes[4];
+    simd::store(lanes, acc);
+    float sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    for (; k < end; ++k) {
+        sum += spectrum[2 * k] * spectrum[2 * k] + spectrum[2 * k + 1] * spectrum[2 * k + 1];
+    }
+    return sum;
+}
+
+// spectrum[k] *= g0 + (g1 - g0) * fraction[k] over bins [begin, end)
+void applyRamp(float *spectrum, const float *fraction, int32_t begin, int32_t end,
+               float g0, float g1) {
+    const float slope = g1 - g0;
+    const simd::vec4 base = simd::set1(g0);
+    const simd::vec4 step = simd::set1(slope);
+    int32_t k = begin;
+    for (; k + 4 <= end; k += 4) {
+        simd::vec4 g = simd::madd(step, simd::load(fraction + k), base);
+        simd::vec4 re, im;
+        simd::loadDeinterleave(spectrum + 2 * k, re, im);
+        simd::storeInterleave(spectrum + 2 * k, simd::mul(re, g), simd::mul(im, g));
+    }
+    for (; k < end; ++k) {
+        float g = g0 + slope * fraction[k];
+        spectrum[2 * k] *= g;
+        spectrum[2 * k + 1] *= g;
+    }
+}
+
+} // namespace
+
+void MultibandCompressor::configure(int32_t numBands, int32_t fftSize, int32_t hopSize,
+                                    int32_t sampleRate, float windowSumSquares,
+                                    float lowHz, float highHz) {
+    mNumBands = std::min(std::max(numBands, 0), kMaxBands);
+    mFftSize = fftSize;
+    mHopSize = hopSize;
+    mSampleRate = sampleRate;
+    mWindowSumSquares = windowSumSquares;
+    mLowHz = lowHz;
+    mHighHz = std::min(highHz, 0.5f * sampleRate);
+    publish();
+}
+
+void MultibandCompressor::setBand(int32_t band, const BandParams &params) {
+    if (band < 0 || band >= kMaxBands) return;
+    mParams[band] = params;
+    publish();
+}
+
+void MultibandCompressor::setAllBands(const BandParams &params) {
+    mParams.fill(params);
+    publish();
+}
+
+std::vector<MultibandCompressor::BandParams> MultibandCompressor::mergeBands(
+        const std::vector<BandParams> &bands, int32_t maxBands) {
+    std::vector<BandParams> merged = bands;
+    maxBands = std::max(maxBands, 0);
+    while ((int32_t) merged.size() > maxBands) {
+        if (maxBands == 0) {
+            merged.clear();
+            break;
+        }
+        std::vector<BandParams> pairs;
+        for (size_t b = 0; b < merged.size(); b += 2) {
+            if (b + 1 == merged.size()) {
+                pairs.push_back(merged[b]);
+                break;
+            }
+            const BandParams &lo = merged[b];
+            const BandParams &hi = merged[b + 1];
+            BandParams p;
+            p.thresholdDb = 0.5f * (lo.thresholdDb + hi.thresholdDb);
+            p.ratio = 0.5f * (lo.ratio + hi.ratio);
+            p.attackMs = std::min(lo.attackMs, hi.attackMs);
+            p.releaseMs = 0.5f * (lo.releaseMs + hi.releaseMs);
+            p.gainDb = 0.5f * (lo.gainDb + hi.gainDb);
+            pairs.push_back(p);
+        }
+        merged = std::move(pairs);
+    }
+    return merged;
+}
+
+float MultibandCompressor::staticOutputDb(int32_t band, float inputDb) const {
+    const BandParams &p = mParams[band];
+    float over = std::max(inputDb - p.thresholdDb, 0.0f);
+    return inputDb + p.gainDb + over * (1.0f / p.ratio - 1.0f);
+}
+
+void MultibandCompressor::publish() {
+    Layout &layout = mLayouts.writeBuffer();
+    layout.numBands = mNumBands;
+    if (mNumBands == 0 || mFftSize <= 0) {
+        layout.numBands = 0;
+        mLayouts.publish();
+        return;
+    }
+
+    const int32_t bins = mFftSize / 2 + 1;
+    const float binHz = (float) mSampleRate / mFftSize;
+    layout.numBins = bins;
+    // One-sided energy of a windowed sine of amplitude A is about N * A^2 * sum(w^2) / 4;
+    // scale it so a full-scale (A = 1) sine reads as 0 dB.
+    layout.levelScale = 4.0f / (mFftSize * mWindowSumSquares);
+
+    // Log-spaced edges between the band limits; the outer bands extend to DC and Nyquist
+    const float ratio = mHighHz / mLowHz;
+    layout.edges[0] = 0;
+    for (int32_t b = 1; b < mNumBands; ++b) {
+        float edgeHz = mLowHz * powf(ratio, (float) b / mNumBands);
+        layout.edges[b] = std::min(bins, (int32_t) lroundf(edgeHz / binHz));
+    }
+    layout.edges[mNumBands] = bins;
+
+    // Knots: 0, the geometric centre of each band, Nyquist. Segment j spans
+    // [knots[j], knots[j+1]) and ramps from band j-1's gain to band j's, clamped at the ends.
+    layout.knots[0] = 0;
+    for (int32_t b = 0; b < mNumBands; ++b) {
+        float centreHz = mLowHz * powf(ratio, (b + 0.5f) / mNumBands);
+        layout.knots[b + 1] = std::min(bins, std::max(layout.knots[b],
+                                                      (int32_t) lroundf(centreHz / binHz)));
+    }
+    layout.knots[mNumBands + 1] = bins;
+
+    layout.binFraction.assign(bins, 0.0f);
+    for (int32_t j = 0; j <= mNumBands; ++j) {
+        int32_t begin = layout.knots[j];
+        int32_t end = layout.knots[j + 1];
+        for (int32_t k = begin; k < end; ++k) {
+            layout.binFraction[k] = (float) (k - begin) / (end - begin);
+        }
+    }
+
+    const float framesPerSecond = (float) mSampleRate / mHopSize;
+    for (int32_t b = 0; b < mNumBands; ++b) {
+        const BandParams &p = mParams[b];
+        BandState &state = layout.bands[b];
+        state.thresholdDb = p.thresholdDb;
+        state.slope = 1.0f / std::max(p.ratio, 1.0f) - 1.0f;
+        state.attackCoeff = expf(-1.0f / std::max(p.attackMs * 1e-3f * framesPerSecond, 1e-3f));
+        state.releaseCoeff = expf(-1.0f / std::max(p.releaseMs * 1e-3f * framesPerSecond, 1e-3f));
+        state.gainDb = p.gainDb;
+    }
+    mLayouts.publish();
+}
+
+void MultibandCompressor::process(kiss_fft_cpx *spectrum) {
+    const Layout &layout = mLayouts.read();
+    const int32_t numBands = layout.numBands;
+    if (numBands == 0) return;
+    float *s = reinterpret_cast<float *>(spectrum);
+
+    // 1) band levels -> static curve -> attack/release smoothing, all in dB
+    for (int32_t b = 0; b < numBands; ++b) {
+        const BandState &band = layout.bands[b];
+        float energy = bandEnergy(s, layout.edges[b], layout.edges[b + 1]);
+        float levelDb = 10.0f * log10f(energy * layout.levelScale + 1e-20f);
+        float targetDb = band.gainDb + std::max(levelDb - band.thresholdDb, 0.0f) * band.slope;
+        float &smoothed = mSmoothedGainDb[b];
+        float coeff = targetDb < smoothed ? band.attackCoeff : band.releaseCoeff;
+        smoothed = targetDb + coeff * (smoothed - targetDb);
+    }
+
+    // 2) per-bin gain, ramped between band centres
+    for (int32_t b = 0; b < numBands; ++b) {
+        mKnotGain[b + 1] = powf(10.0f, mSmoothedGainDb[b] / 20.0f);
+    }
+    mKnotGain[0] = mKnotGain[1];
+    mKnotGain[numBands + 1] = mKnotGain[numBands];
+    for (int32_t j = 0; j <= numBands; ++j) {
+        applyRamp(s, layout.binFraction.data(), layout.knots[j], layout.knots[j + 1],
+                  mKnotGain[j], mKnotGain[j + 1]);
+    }
+}
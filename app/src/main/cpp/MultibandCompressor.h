@@ -0,0 +1,102 @@
+#ifndef OBOEPASSTHROUGH_MULTIBANDCOMPRESSOR_H
+#define OBOEPASSTHROUGH_MULTIBANDCOMPRESSOR_H
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "kiss_fft.h"
+#include "TripleBuffer.h"
+
+/**
+ * Multi-band wide dynamic range compression (WDRC) on STFT frames.
+ *
+ * Bands are log-spaced between the band limits. Per frame, each band's level is the
+ * energy of its bins, calibrated so a full-scale sine reads 0 dB. The static curve is
+ * linear gain below the threshold and 1/ratio above it, and the resulting gain in dB is
+ * smoothed with separate attack and release time constants. Per-bin gain is
+ * interpolated linearly between band centres so band edges don't step.
+ *
+ * Band sums and the interpolated gain multiply are single vectorized passes over the
+ * bins, so their cost depends on the FFT size, not the band count; only the few
+ * log/exp per band scale with it.
+ *
+ * configure() and setBand() run on a control thread and publish through a TripleBuffer;
+ * process() runs on the audio thread and does not allocate.
+ */
+class MultibandCompressor {
+public:
+    static constexpr int32_t kMaxBands = 16;
+
+    struct BandParams {
+        float thresholdDb = -40.0f;     // dB re full-scale sine
+        float ratio = 1.0f;             // input dB change per output dB change above threshold
+        float attackMs = 10.0f;         // time constant while gain is falling
+        float releaseMs = 100.0f;       // time constant while gain is rising
+        float gainDb = 0.0f;            // static gain, applied at every level
+    };
+
+    // ---- control thread ----
+    // hopSize is frames between process() calls; windowSumSquares is sum(w[n]^2) of the
+    // analysis window, used to calibrate band levels. numBands of 0 disables the stage.
+    void configure(int32_t numBands, int32_t fftSize, int32_t hopSize, int32_t sampleRate,
+                   float windowSumSquares, float lowHz = 125.0f, float highHz = 18000.0f);
+    void setBand(int32_t band, const BandParams &params);
+    void setAllBands(const BandParams &params);
+    const BandParams &getBand(int32_t band) const { return mParams[band]; }
+    int32_t getNumBands() const { return mNumBands; }
+
+    // Halves bands (merging neighbours in pairs, an odd last band kept) until at most
+    // maxBands remain. With the same band limits the merged bands cover each pair's bins.
+    static std::vector<BandParams> mergeBands(const std::vector<BandParams> &bands,
+                                              int32_t maxBands);
+
+    // Steady-state output level for a given band input level (the static curve).
+    float staticOutputDb(int32_t band, float inputDb) const;
+
+    // ---- audio thread ----
+    // spectrum has fftSize / 2 + 1 bins. No-op while disabled.
+    void process(kiss_fft_cpx *spectrum);
+
+    // Smoothed gain (dB) last applied to a band; for tests and instrumentation.
+    float currentGainDb(int32_t band) const { return mSmoothedGainDb[band]; }
+
+private:
+    struct BandState {
+        float thresholdDb;
+        float slope;                    // 1 / ratio - 1
+        float attackCoeff;
+        float releaseCoeff;
+        float gainDb;
+    };
+
+    struct Layout {
+        int32_t numBands = 0;
+        int32_t numBins = 0;
+        float levelScale = 1.0f;        // band energy -> mean square of a full-scale-sine reference
+        std::array<BandState, kMaxBands> bands{};
+        std::array<int32_t, kMaxBands + 1> edges{};    // bins [edges[b], edges[b+1]) belong to band b
+        std::array<int32_t, kMaxBands + 2> knots{};    // gain interpolation points, see publish()
+        std::vector<float> binFraction;                // each bin's position between its knots
+    };
+
+    void publish();
+
+    // control-side copy of the configuration
+    int32_t mNumBands = 0;
+    int32_t mFftSize = 0;
+    int32_t mHopSize = 0;
+    int32_t mSampleRate = 0;
+    float mWindowSumSquares = 1.0f;
+    float mLowHz = 125.0f;
+    float mHighHz = 18000.0f;
+    std::array<BandParams, kMaxBands> mParams{};
+
+    TripleBuffer<Layout> mLayouts;
+
+    // audio-side state
+    std::array<float, kMaxBands> mSmoothedGainDb{};
+    std::array<float, kMaxBands + 2> mKnotGain{};
+};
+
+#endif //OBOEPASSTHROUGH_MULTIBANDCOMPRESSOR_H
@@ -0,0 +1,166 @@
+#include "NonUniformConvolver.h"
+
+#include <algorithm>
+#include <cstring>
+
+NonUniformConvolver::NonUniformConvolver() {
+    sem_init(&mWake, 0, 0);
+}
+
+NonUniformConvolver::~NonUniformConvolver() {
+    stopWorker();
+    sem_destroy(&mWake);
+}
+
+void NonUniformConvolver::stopWorker() {
+    if (mWorker.joinable()) {
+        mRunning.store(false, std::memory_order_release);
+        sem_post(&mWake);
+        mWorker.join();
+    }
+}
+
+void NonUniformConvolver::release() {
+    stopWorker();
+    mTail.clear();
+    mTail.shrink_to_fit();
+    mDeadlineMisses.store(0, std::memory_order_relaxed);
+    mInputOverruns.store(0, std::memory_order_relaxed);
+    mTailBlocksDone.store(0, std::memory_order_relaxed);
+}
+
+void NonUniformConvolver::configure(int32_t blockSize, const float *taps, int32_t numTaps,
+                                    int32_t maxTailBlockSize) {
+    stopWorker();
+    mBlockSize = blockSize;
+    mTail.clear();
+    mDeadlineMisses.store(0, std::memory_order_relaxed);
+    mInputOverruns.store(0, std::memory_order_relaxed);
+    mTailBlocksDone.store(0, std::memory_order_relaxed);
+    mPendingInput.assign(blockSize, 0.0f);
+    mPendingOutput.assign(blockSize, 0.0f);
+    mPendingPos = 0;
+
+    int32_t numPartitions = (numTaps + blockSize - 1) / blockSize;
+    if (numPartitions <= kMaxUniformPartitions) {
+        mHead.configure(blockSize, taps, numTaps);
+        return;
+    }
+
+    int32_t headTaps = kHeadPartitions * blockSize;
+    mHead.configure(blockSize, taps, headTaps);
+
+    // Tail block sizes are blockSize * 2^k so the worker can consume whole input blocks.
+    int32_t maxBlock = blockSize;
+    while (maxBlock * 2 <= maxTailBlockSize) maxBlock *= 2;
+
+    int32_t offset = headTaps;
+    int32_t largestBlock = blockSize;
+    while (offset < numTaps) {
+        auto segment = std::make_unique<TailSegment>();
+        int32_t segmentBlock = std::min(offset / 2, maxBlock);
+        // two partitions per segment until the block size saturates, then everything left
+        int32_t length = segmentBlock < maxBlock ? 2 * segmentBlock : numTaps - offset;
+        length = std::min(length, numTaps - offset);
+
+        segment->convolver.configure(segmentBlock, taps + offset, length);
+        segment->offset = offset;
+        segment->input.assign(segmentBlock, 0.0f);
+        segment->output.assign(segmentBlock, 0.0f);
+        segment->ring.reset(offset + 2 * segmentBlock);
+        // pre-roll: stream positions [0, offset) get nothing from taps >= offset
+        std::vector<float> zeros(offset, 0.0f);
+        segment->ring.write(zeros.data(), zeros.size());
+
+        largestBlock = std::max(largestBlock, segmentBlock);
+        offset += length;
+        mTail.push_back(std::move(segment));
+    }
+
+    mTailInput.reset(4 * largestBlock);
+    mWorkerBlock.resize(blockSize);
+    if (mOffline) return;
+    mRunning.store(true, std::memory_order_release);
+    mWorker = std::thread(&NonUniformConvolver::workerLoop, this);
+}
+
+void NonUniformConvolver::processBlock(const float *input, float *output) {
+    const int32_t B = mBlockSize;
+    mHead.processBlock(input, output);
+    if (mTail.empty()) return;
+
+    // Mix in whatever each tail segment has delivered for this block
+    for (auto &segment : mTail) {
+        auto &ring = segment->ring;
+        if (segment->missedFrames > 0) {
+            segment->missedFrames -= ring.consume(segment->missedFrames);
+        }
+        auto spans = ring.readSpans(B);
+        for (size_t i = 0; i < spans.firstSize; ++i) output[i] += spans.first[i];
+        float *rest = output + spans.firstSize;
+        for (size_t i = 0; i < spans.secondSize; ++i) rest[i] += spans.second[i];
+        ring.consume(spans.size());
+        if (spans.size() < (size_t) B) {
+            segment->missedFrames += B - spans.size();
+            mDeadlineMisses.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // Hand this block to the worker. Blocks are all-or-nothing so the worker never sees
+    // a torn one; a full ring means the worker has stalled for several tail blocks.
+    if (mTailInput.availableToWrite() >= (size_t) B) {
+        mTailInput.write(input, B);
+    } else {
+        mInputOverruns.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (mOffline) {
+        // Each segment's next output is due at least one block later, so it is always ready
+        drainTailInput();
+    } else {
+        sem_post(&mWake);
+    }
+}
+
+void NonUniformConvolver::process(const float *input, float *output, int32_t numFrames) {
+    while (numFrames > 0) {
+        int32_t chunk = std::min(numFrames, mBlockSize - mPendingPos);
+        std::memcpy(output, mPendingOutput.data() + mPendingPos, chunk * sizeof(float));
+        std::memcpy(mPendingInput.data() + mPendingPos, input, chunk * sizeof(float));
+        mPendingPos += chunk;
+        input += chunk;
+        output += chunk;
+        numFrames -= chunk;
+        if (mPendingPos == mBlockSize) {
+            processBlock(mPendingInput.data(), mPendingOutput.data());
+            mPendingPos = 0;
+        }
+    }
+}
+
+void NonUniformConvolver::workerLoop() {
+    while (true) {
+        sem_wait(&mWake);
+        if (!mRunning.load(std::memory_order_acquire)) break;
+        drainTailInput();
+    }
+}
+
+void NonUniformConvolver::drainTailInput() {
+    const int32_t B = mBlockSize;
+    while (mTailInput.availableToRead() >= (size_t) B) {
+        mTailInput.read(mWorkerBlock.data(), B);
+        // Segments are ordered by block size, so the tightest deadline is served first
+        for (auto &segment : mTail) {
+            int32_t segmentBlock = segment->convolver.getBlockSize();
+            std::memcpy(segment->input.data() + segment->inputPos, mWorkerBlock.data(),
+                        B * sizeof(float));
+            segment->inputPos += B;
+            if (segment->inputPos == segmentBlock) {
+                segment->convolver.processBlock(segment->input.data(), segment->output.data());
+                segment->ring.write(segment->output.data(), segmentBlock);
+                segment->inputPos = 0;
+            }
+        }
+        mTailBlocksDone.fetch_add(1, std::memory_order_release);
+    }
+}
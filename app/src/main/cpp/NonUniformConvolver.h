@@ -0,0 +1,114 @@
+#ifndef OBOEPASSTHROUGH_NONUNIFORMCONVOLVER_H
+#define OBOEPASSTHROUGH_NONUNIFORMCONVOLVER_H
+
+#include <semaphore.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "PartitionedConvolver.h"
+#include "SpscRingBuffer.h"
+
+/**
+ * Non-uniformly partitioned FIR convolution for long (4k-32k tap) filters.
+ *
+ * The head of the filter runs as a PartitionedConvolver with blockSize partitions on the
+ * caller's (audio) thread, so the callback cost is bounded by the head alone. The tail is
+ * split into segments whose block size doubles (up to maxTailBlockSize); segment k with
+ * block Bk starts at tap offset >= 2 * Bk, which gives a worker thread about Bk frames of
+ * wall time to deliver each block before the audio thread needs it.
+ *
+ * Handoff is lock-free: input goes to the worker through one SpscRingBuffer and each
+ * segment returns its output through its own SpscRingBuffer, pre-rolled with offset
+ * zeros so ring position == stream position. When a segment's output is not ready at
+ * its deadline, the audio thread plays the head without it, counts a deadline miss and
+ * discards the late samples once they arrive.
+ *
+ * Offline (setOffline), there is no worker: each block's tail input is convolved on the
+ * caller's thread before processBlock() returns, so output is exact however fast the
+ * caller runs, at the cost of the tail's work landing in the calls that complete a block.
+ *
+ * configure() allocates and starts the worker; process() and processBlock() do not.
+ */
+class NonUniformConvolver {
+public:
+    NonUniformConvolver();
+    ~NonUniformConvolver();
+
+    NonUniformConvolver(const NonUniformConvolver &) = delete;
+    NonUniformConvolver &operator=(const NonUniformConvolver &) = delete;
+
+    // Filters of up to kMaxUniformPartitions partitions run entirely on the caller's thread.
+    static constexpr int32_t kMaxUniformPartitions = 16;
+    static constexpr int32_t kHeadPartitions = 4;
+
+    // Not real-time safe. Stops any running worker, rebuilds, restarts it if needed.
+    void configure(int32_t blockSize, const float *taps, int32_t numTaps,
+                   int32_t maxTailBlockSize = 8192);
+
+    // Not real-time safe. Stops the worker and frees the tail segments, for an instance not
+    // needed for now; counters read zero. Call configure() before processing again.
+    void release();
+
+    // Runs the tail on the caller's thread instead of the worker, for file processing and
+    // other callers not paced by the audio clock. Applied on the next configure().
+    void setOffline(bool offline) { mOffline = offline; }
+    bool isOffline() const { return mOffline; }
+
+    // Streams any number of frames; output lags input by getLatencyFrames().
+    void process(const float *input, float *output, int32_t numFrames);
+
+    // Exactly getBlockSize() frames, no extra buffering.
+    void processBlock(const float *input, float *output);
+
+    int32_t getBlockSize() const { return mBlockSize; }
+    int32_t getLatencyFrames() const { return mBlockSize; }
+    int32_t getNumTailSegments() const { return (int32_t) mTail.size(); }
+    int64_t getDeadlineMisses() const { return mDeadlineMisses.load(std::memory_order_relaxed); }
+    int64_t getInputOverruns() const { return mInputOverruns.load(std::memory_order_relaxed); }
+    // Input blocks the tail has delivered output for; behind the blocks handed in while the
+    // worker is catching up. Tests use it to let the worker finish before the next callback.
+    int64_t getTailBlocksDone() const { return mTailBlocksDone.load(std::memory_order_acquire); }
+
+private:
+    struct TailSegment {
+        PartitionedConvolver convolver;
+        int32_t offset = 0;                 // first tap handled by this segment
+        // worker-side
+        std::vector<float> input;
+        std::vector<float> output;
+        int32_t inputPos = 0;
+        // worker -> audio thread
+        SpscRingBuffer<float> ring;
+        // audio-side: frames already played without this segment, to discard when late data lands
+        size_t missedFrames = 0;
+    };
+
+    void stopWorker();
+    void workerLoop();
+    void drainTailInput();
+
+    int32_t mBlockSize = 0;
+    bool mOffline = false;
+    PartitionedConvolver mHead;
+    std::vector<std::unique_ptr<TailSegment>> mTail;
+
+    SpscRingBuffer<float> mTailInput;   // audio thread -> worker, whole blocks
+    std::vector<float> mWorkerBlock;
+    sem_t mWake;
+    std::thread mWorker;
+    std::atomic<bool> mRunning{false};
+    std::atomic<int64_t> mDeadlineMisses{0};
+    std::atomic<int64_t> mInputOverruns{0};
+    std::atomic<int64_t> mTailBlocksDone{0};
+
+    // streaming adapter for process()
+    std::vector<float> mPendingInput;
+    std::vector<float> mPendingOutput;
+    int32_t mPendingPos = 0;
+};
+
+#endif //OBOEPASSTHROUGH_NONUNIFORMCONVOLVER_H
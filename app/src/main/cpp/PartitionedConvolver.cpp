@@ -0,0 +1,93 @@
+#include "PartitionedConvolver.h"
+
+#include <algorithm>
+#include <cstring>
+
+void PartitionedConvolver::layout(DspArena &arena) {
+    const size_t spectra = (size_t) mNumPartitions * mNumBins;
+    mFftCfg = takeFftPlan(arena, mFftSize, 0);
+    mIfftCfg = takeFftPlan(arena, mFftSize, 1);
+    mFilterSpectra = arena.take<kiss_fft_cpx>(spectra);
+    mDelayLine = arena.take<kiss_fft_cpx>(spectra);
+    mAccumulator = arena.take<kiss_fft_cpx>(mNumBins);
+    mTimeBuffer = arena.take<float>(mFftSize);
+    mIfftOutput = arena.take<float>(mFftSize);
+    mPendingInput = arena.take<float>(mBlockSize);
+    mPendingOutput = arena.take<float>(mBlockSize);
+}
+
+void PartitionedConvolver::configure(int32_t blockSize, const float *taps, int32_t numTaps) {
+    mBlockSize = blockSize;
+    mFftSize = 2 * blockSize;
+    mNumBins = blockSize + 1;
+    mNumPartitions = std::max<int32_t>(1, (numTaps + blockSize - 1) / blockSize);
+    mArena.build([this](DspArena &arena) { layout(arena); });
+
+    // Partition p holds taps [p*B, (p+1)*B) zero-padded to 2B. The inverse FFT is
+    // unnormalized, so fold 1/N into the partition spectra once here.
+    const float scale = 1.0f / mFftSize;
+    float *padded = mIfftOutput;    // free until the first block
+    for (int32_t p = 0; p < mNumPartitions; ++p) {
+        std::fill(padded, padded + mFftSize, 0.0f);
+        int32_t begin = p * blockSize;
+        int32_t count = std::min(blockSize, numTaps - begin);
+        for (int32_t i = 0; i < count; ++i) padded[i] = taps[begin + i] * scale;
+        fft_backend_fftr(mFftCfg, padded, &mFilterSpectra[(size_t) p * mNumBins]);
+    }
+    reset();
+}
+
+void PartitionedConvolver::reset() {
+    std::fill(mDelayLine, mDelayLine + (size_t) mNumPartitions * mNumBins, kiss_fft_cpx{0, 0});
+    std::fill(mTimeBuffer, mTimeBuffer + mFftSize, 0.0f);
+    std::fill(mPendingInput, mPendingInput + mBlockSize, 0.0f);
+    std::fill(mPendingOutput, mPendingOutput + mBlockSize, 0.0f);
+    mDelayLineHead = 0;
+    mPendingPos = 0;
+}
+
+void PartitionedConvolver::processBlock(const float *input, float *output) {
+    const int32_t B = mBlockSize;
+    const int32_t bins = mNumBins;
+
+    // Slide the 2B input window and transform it into the newest delay-line slot
+    std::memmove(mTimeBuffer, mTimeBuffer + B, B * sizeof(float));
+    std::memcpy(mTimeBuffer + B, input, B * sizeof(float));
+    mDelayLineHead = (mDelayLineHead == 0 ? mNumPartitions : mDelayLineHead) - 1;
+    fft_backend_fftr(mFftCfg, mTimeBuffer, &mDelayLine[(size_t) mDelayLineHead * bins]);
+
+    // Accumulate X[t - p] * H[p] over all partitions. The delay line is walked from
+    // the head forward, wrapping once, so both halves are contiguous loops.
+    std::fill(mAccumulator, mAccumulator + bins, kiss_fft_cpx{0, 0});
+    kiss_fft_cpx *acc = mAccumulator;
+    int32_t slot = mDelayLineHead;
+    for (int32_t p = 0; p < mNumPartitions; ++p) {
+        const kiss_fft_cpx *x = &mDelayLine[(size_t) slot * bins];
+        const kiss_fft_cpx *h = &mFilterSpectra[(size_t) p * bins];
+        for (int32_t k = 0; k < bins; ++k) {
+            acc[k].r += x[k].r * h[k].r - x[k].i * h[k].i;
+            acc[k].i += x[k].r * h[k].i + x[k].i * h[k].r;
+        }
+        if (++slot == mNumPartitions) slot = 0;
+    }
+
+    // Overlap-save: the second half of the circular result is the valid linear output
+    fft_backend_fftri(mIfftCfg, mAccumulator, mIfftOutput);
+    std::memcpy(output, mIfftOutput + B, B * sizeof(float));
+}
+
+void PartitionedConvolver::process(const float *input, float *output, int32_t numFrames) {
+    while (numFrames > 0) {
+        int32_t chunk = std::min(numFrames, mBlockSize - mPendingPos);
+        std::memcpy(output, mPendingOutput + mPendingPos, chunk * sizeof(float));
+        std::memcpy(mPendingInput + mPendingPos, input, chunk * sizeof(float));
+        mPendingPos += chunk;
+        input += chunk;
+        output += chunk;
+        numFrames -= chunk;
+        if (mPendingPos == mBlockSize) {
+            processBlock(mPendingInput, mPendingOutput);
+            mPendingPos = 0;
+        }
+    }
+}
@@ -0,0 +1,67 @@
+#ifndef OBOEPASSTHROUGH_PARTITIONEDCONVOLVER_H
+#define OBOEPASSTHROUGH_PARTITIONEDCONVOLVER_H
+
+#include <cstdint>
+#include "DspArena.h"
+
+/**
+ * Uniformly partitioned overlap-save FIR convolution (UPOLS).
+ *
+ * The filter is split into partitions of blockSize taps, each transformed once with a
+ * 2 * blockSize real FFT. Every input block is transformed once and pushed into a
+ * frequency-domain delay line; the output block is the sum of the delay line times the
+ * partition spectra, followed by a single inverse FFT.
+ *
+ * Algorithmic latency is exactly one block, independent of the filter length.
+ * configure() carves every buffer and both FFT plans from one DspArena; process() and
+ * processBlock() do not allocate.
+ */
+class PartitionedConvolver {
+public:
+    PartitionedConvolver() = default;
+
+    PartitionedConvolver(const PartitionedConvolver &) = delete;
+    PartitionedConvolver &operator=(const PartitionedConvolver &) = delete;
+
+    // Not real-time safe.
+    void configure(int32_t blockSize, const float *taps, int32_t numTaps);
+
+    // Clear the signal history, keeping the filter.
+    void reset();
+
+    // Streams any number of frames; output lags input by getLatencyFrames().
+    void process(const float *input, float *output, int32_t numFrames);
+
+    // Convolve exactly one block of getBlockSize() frames with no extra buffering.
+    // Output block n is the filter response to input blocks 0..n (overlap-save).
+    void processBlock(const float *input, float *output);
+
+    int32_t getBlockSize() const { return mBlockSize; }
+    int32_t getNumPartitions() const { return mNumPartitions; }
+    int32_t getLatencyFrames() const { return mBlockSize; }
+
+private:
+    void layout(DspArena &arena);
+
+    int32_t mBlockSize = 0;
+    int32_t mFftSize = 0;
+    int32_t mNumBins = 0;
+    int32_t mNumPartitions = 0;
+    DspArena mArena;                            // backs the plans and buffers below
+    fft_backend_cfg mFftCfg = nullptr;
+    fft_backend_cfg mIfftCfg = nullptr;
+
+    kiss_fft_cpx *mFilterSpectra = nullptr;     // mNumPartitions * mNumBins, pre-scaled by 1/N
+    kiss_fft_cpx *mDelayLine = nullptr;         // frequency-domain delay line, same layout
+    int32_t mDelayLineHead = 0;                 // slot holding the newest input spectrum
+    kiss_fft_cpx *mAccumulator = nullptr;       // mNumBins
+    float *mTimeBuffer = nullptr;               // 2 * blockSize: [previous block, current block]
+    float *mIfftOutput = nullptr;               // 2 * blockSize
+
+    // streaming adapter for process()
+    float *mPendingInput = nullptr;
+    float *mPendingOutput = nullptr;
+    int32_t mPendingPos = 0;
+};
+
+#endif //OBOEPASSTHROUGH_PARTITIONEDCONVOLVER_H
@@ -0,0 +1,137 @@
+#include "PolyphaseResampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+#include "FirDesign.h"
+#include "Interleave.h"
+#include "SimdVec4.h"
+
+namespace {
+
+// Dot product of the newest taps frames (oldest first) with one time-reversed phase.
+// Four accumulators keep the multiply-adds independent; taps is a multiple of 16.
+inline float dot(const float *x, const float *h, int32_t taps) {
+    simd::vec4 a0 = simd::set1(0.0f), a1 = a0, a2 = a0, a3 = a0;
+    for (int32_t j = 0; j < taps; j += 16) {
+        a0 = simd::madd(simd::load(x + j), simd::load(h + j), a0);
+        a1 = simd::madd(simd::load(x + j + 4), simd::load(h + j + 4), a1);
+        a2 = simd::madd(simd::load(x + j + 8), simd::load(h + j + 8), a2);
+        a3 = simd::madd(simd::load(x + j + 12), simd::load(h + j + 12), a3);
+    }
+    alignas(16) float lanes[4];
+    simd::store(lanes, simd::add(simd::add(a0, a1), simd::add(a2, a3)));
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+} // namespace
+
+void PolyphaseResampler::configure(int32_t inputRate, int32_t outputRate, int32_t maxInputFrames,
+                                   int32_t channels) {
+    mChannels = std::max(1, std::min(channels, kMaxChannels));
+    mInputRate = inputRate;
+    mOutputRate = outputRate;
+    const int32_t g = std::gcd(inputRate, outputRate);
+    mUp = outputRate / g;
+    mDown = inputRate / g;
+    mMaxInputFrames = maxInputFrames;
+
+    // Enough taps per phase to keep the transition band a fixed fraction of the lower
+    // rate when downsampling
+    const double ratio = std::max(1.0, (double) inputRate / outputRate);
+    mTaps = ((int32_t) std::ceil(kBaseTapsPerPhase * ratio) + 15) / 16 * 16;
+
+    mPhases.clear();
+    if (!isPassthrough()) {
+        // Transition band of a Kaiser design at this beta, in cycles at the input rate,
+        // placed just below the lower Nyquist
+        const double transition = (8.7 * kKaiserBeta - 8.0) / (14.36 * mTaps);
+        const double lowerNyquist = 0.5 * std::min(inputRate, outputRate) / inputRate;
+        const double cutoff = std::max(lowerNyquist - 0.5 * transition, 0.25 * lowerNyquist);
+        std::vector<double> prototype = FirDesign::kaiserLowPass(cutoff / mUp, mTaps * mUp, kKaiserBeta);
+
+        // Phase p holds prototype taps p, p + L, p + 2L, ..., applied to x[n], x[n-1], ...;
+        // reversed, so they line up with the input oldest first
+        mPhases.resize((size_t) mUp * mTaps);
+        for (int32_t p = 0; p < mUp; ++p) {
+            double sum = 0.0;
+            for (int32_t j = 0; j < mTaps; ++j) sum += prototype[p + j * mUp];
+            float *row = &mPhases[(size_t) p * mTaps];
+            for (int32_t j = 0; j < mTaps; ++j) {
+                row[mTaps - 1 - j] = static_cast<float>(prototype[p + j * mUp] / sum);
+            }
+        }
+    }
+    mBuffer.assign(((size_t) mTaps + std::max(maxInputFrames, 0)) * mChannels, 0.0f);
+    reset();
+}
+
+void PolyphaseResampler::reset() {
+    std::fill(mBuffer.begin(), mBuffer.end(), 0.0f);
+    mNext = 0;
+    mPhase = 0;
+}
+
+double PolyphaseResampler::getLatencyFrames() const {
+    return isPassthrough() ? 0.0 : 0.5 * (mTaps * mUp - 1) / mUp;
+}
+
+int32_t PolyphaseResampler::outputCapacityFor(int32_t numInput) const {
+    return (int32_t) (((int64_t) numInput * mUp + mDown - 1) / mDown) + 1;
+}
+
+int32_t PolyphaseResampler::maxInputFor(int32_t outputCapacity) const {
+    return std::max(0, (int32_t) ((int64_t) (outputCapacity - 1) * mDown / mUp));
+}
+
+int32_t PolyphaseResampler::inputFramesFor(int32_t numOutput) const {
+    if (numOutput <= 0) return 0;
+    if (isPassthrough()) return numOutput;
+    // Newest frame used by the last of the outputs, plus one
+    const int64_t last = mNext + ((int64_t) mPhase + (int64_t) (numOutput - 1) * mDown) / mUp;
+    return (int32_t) std::max<int64_t>(0, last + 1);
+}
+
+int32_t PolyphaseResampler::process(const float *input, int32_t numInput, float *output,
+                                    int32_t maxOutput) {
+    const int32_t channels = mChannels;
+    numInput = std::min(numInput, mMaxInputFrames);
+    if (isPassthrough()) {
+        const int32_t n = std::min(numInput, maxOutput);
+        std::memcpy(output, input, (size_t) n * channels * sizeof(float));
+        return n;
+    }
+
+    // Input frame k sits at buffer[mTaps + k] of its channel; the output whose newest
+    // frame is n reads buffer[n + 1 .. n + mTaps]
+    const size_t stride = (size_t) mTaps + mMaxInputFrames;
+    float *buffers[kMaxChannels] = {};
+    float *inputs[kMaxChannels] = {};
+    for (int32_t c = 0; c < channels; ++c) {
+        buffers[c] = mBuffer.data() + c * stride;
+        inputs[c] = buffers[c] + mTaps;
+    }
+    Interleave::toPlanar(input, channels, numInput, inputs);
+    int32_t n = mNext;
+    int32_t p = mPhase;
+    int32_t produced = 0;
+    while (n < numInput && produced < maxOutput) {
+        const float *phase = &mPhases[(size_t) p * mTaps];
+        float *frame = output + (size_t) produced * channels;
+        for (int32_t c = 0; c < channels; ++c) {
+            frame[c] = dot(buffers[c] + n + 1, phase, mTaps);
+        }
+        ++produced;
+        p += mDown;
+        n += p / mUp;
+        p %= mUp;
+    }
+    mNext = n - numInput;
+    mPhase = p;
+    for (int32_t c = 0; c < channels; ++c) {
+        std::memmove(buffers[c], buffers[c] + numInput, (size_t) mTaps * sizeof(float));
+    }
+    return produced;
+}
@@ -0,0 +1,80 @@
+#ifndef OBOEPASSTHROUGH_POLYPHASERESAMPLER_H
+#define OBOEPASSTHROUGH_POLYPHASERESAMPLER_H
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * Rational-ratio polyphase resampler between a stream's native rate and the engine's core
+ * rate, e.g. 44.1 -> 48 kHz as L/M = 160/147 or 16 -> 48 kHz as 3/1.
+ *
+ * The prototype is a single Kaiser-windowed sinc (FirDesign::kaiserLowPass) at L times the
+ * input rate. Its stopband starts at the lower of the two Nyquists, so neither the
+ * upsampling images nor the downsampling aliases get through. It is split into L phases of
+ * getTapsPerPhase() taps. Each phase is stored time-reversed and normalized to unity DC
+ * gain, so each output is one contiguous vector dot product (simd::vec4) over the newest
+ * input frames. Output m uses phase m * M mod L. The tables are built once in configure().
+ * The taps per phase grow with the downsampling factor so the transition band stays
+ * the same width relative to the output rate.
+ *
+ * It can be driven two ways:
+ *  - push: process() everything that arrived, with room for outputCapacityFor(numInput).
+ *  - pull: inputFramesFor(n) is exactly the input that yields the next n outputs, and
+ *    process() with that input and maxOutput n returns n.
+ * Use one mode per configure(). Equal rates pass straight through with no delay.
+ *
+ * Frames are interleaved across the configured channels. Input is deinterleaved into one
+ * history per channel (see Interleave.h), and every channel uses the same phase table.
+ *
+ * configure() allocates; process() does not. One thread at a time.
+ */
+class PolyphaseResampler {
+public:
+    static constexpr int32_t kBaseTapsPerPhase = 64;
+    static constexpr double kKaiserBeta = 9.0;     // about 90 dB stopband
+    static constexpr int32_t kMaxChannels = 8;
+
+    // numInput passed to process() must not exceed maxInputFrames.
+    void configure(int32_t inputRate, int32_t outputRate, int32_t maxInputFrames,
+                   int32_t channels = 1);
+    // Clears the history and restarts at phase 0.
+    void reset();
+
+    bool isPassthrough() const { return mUp == mDown; }
+    int32_t getInputRate() const { return mInputRate; }
+    int32_t getOutputRate() const { return mOutputRate; }
+    int32_t getUpFactor() const { return mUp; }
+    int32_t getDownFactor() const { return mDown; }
+    int32_t getTapsPerPhase() const { return mTaps; }
+    int32_t getChannelCount() const { return mChannels; }
+    // Group delay in input frames.
+    double getLatencyFrames() const;
+
+    // Push mode: the most a call with numInput frames can produce, and the most input
+    // whose output fits outputCapacity.
+    int32_t outputCapacityFor(int32_t numInput) const;
+    int32_t maxInputFor(int32_t outputCapacity) const;
+    // Pull mode: exactly the input needed for the next numOutput frames.
+    int32_t inputFramesFor(int32_t numOutput) const;
+
+    int32_t process(const float *input, int32_t numInput, float *output, int32_t maxOutput);
+
+private:
+    int32_t mInputRate = 48000;
+    int32_t mOutputRate = 48000;
+    int32_t mUp = 1;                    // L
+    int32_t mDown = 1;                  // M
+    int32_t mTaps = kBaseTapsPerPhase;
+    int32_t mMaxInputFrames = 0;
+    int32_t mChannels = 1;
+    std::vector<float> mPhases;         // mUp rows of mTaps, time-reversed
+    // Per channel, mTaps + mMaxInputFrames apart: mTaps frames of history, then the
+    // current input
+    std::vector<float> mBuffer;
+    // Newest input frame of the next output, relative to the next call's input. It can be
+    // -1 in pull mode, when the last frame of the previous call is used again.
+    int32_t mNext = 0;
+    int32_t mPhase = 0;                 // of the next output, 0..L-1
+};
+
+#endif //OBOEPASSTHROUGH_POLYPHASERESAMPLER_H
@@ -0,0 +1,127 @@
+#ifndef OBOEPASSTHROUGH_PROCESSORCHAIN_H
+#define OBOEPASSTHROUGH_PROCESSORCHAIN_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "SpectralGainTable.h"
+#include "kiss_fft.h"
+
+/**
+ * Processing chains composed at compile time. Stages are plain types held by value in a
+ * tuple and called directly, so the compiler sees the whole chain and can inline it; no
+ * virtual calls and no per-stage dispatch on the audio thread.
+ *
+ * Time-domain stages have
+ *     void process(const float *input, float *output, int32_t numFrames);
+ * The first stage maps the chain's input to its output; every later stage then runs in
+ * place (input == output), so stages that can't alias go first.
+ *
+ * Spectral stages work on one frame's fftSize / 2 + 1 bins:
+ *     void process(kiss_fft_cpx *spectrum, SpectralGainTable::BinRange &active);
+ * active starts as every bin. A stage that zeroes bins outside a band narrows it, and
+ * the caller can prune the inverse FFT to what is left; other stages leave it alone.
+ *
+ * ChainSet holds a few prebuilt chains and runs the one selected at run time, with a
+ * single branch per block rather than per stage.
+ */
+namespace chain {
+
+template <typename... Stages>
+class TimeChain {
+public:
+    static constexpr size_t kNumStages = sizeof...(Stages);
+
+    TimeChain() = default;
+    template <size_t N = kNumStages, std::enable_if_t<(N > 0), int> = 0>
+    explicit TimeChain(Stages... stages) : mStages(std::move(stages)...) {}
+
+    void process(const float *input, float *output, int32_t numFrames) {
+        if constexpr (kNumStages == 0) {
+            if (input != output) std::copy(input, input + numFrames, output);
+        } else {
+            processFrom<0>(input, output, numFrames);
+        }
+    }
+
+    template <size_t I>
+    auto &stage() { return std::get<I>(mStages); }
+
+private:
+    template <size_t I>
+    void processFrom(const float *input, float *output, int32_t numFrames) {
+        std::get<I>(mStages).process(input, output, numFrames);
+        if constexpr (I + 1 < kNumStages) {
+            processFrom<I + 1>(output, output, numFrames);
+        }
+    }
+
+    std::tuple<Stages...> mStages;
+};
+
+template <typename... Stages>
+class SpectralChain {
+public:
+    static constexpr size_t kNumStages = sizeof...(Stages);
+
+    SpectralChain() = default;
+    template <size_t N = kNumStages, std::enable_if_t<(N > 0), int> = 0>
+    explicit SpectralChain(Stages... stages) : mStages(std::move(stages)...) {}
+
+    // Returns the bins that may still be nonzero.
+    SpectralGainTable::BinRange process(kiss_fft_cpx *spectrum, int32_t numBins) {
+        SpectralGainTable::BinRange active{0, numBins};
+        std::apply([&](auto &... stage) { (stage.process(spectrum, active), ...); }, mStages);
+        return active;
+    }
+
+    template <size_t I>
+    auto &stage() { return std::get<I>(mStages); }
+
+private:
+    std::tuple<Stages...> mStages;
+};
+
+// Bins both ranges keep; empty ranges stay empty.
+inline SpectralGainTable::BinRange intersect(SpectralGainTable::BinRange a,
+                                             SpectralGainTable::BinRange b) {
+    SpectralGainTable::BinRange r{std::max(a.begin, b.begin), std::min(a.end, b.end)};
+    if (r.end < r.begin) r.end = r.begin;
+    return r;
+}
+
+template <typename... Chains>
+class ChainSet {
+public:
+    static constexpr size_t kNumChains = sizeof...(Chains);
+
+    ChainSet() = default;
+    template <size_t N = kNumChains, std::enable_if_t<(N > 0), int> = 0>
+    explicit ChainSet(Chains... chains) : mChains(std::move(chains)...) {}
+
+    // An out-of-range index runs chain 0.
+    void process(size_t index, const float *input, float *output, int32_t numFrames) {
+        dispatch(index < kNumChains ? index : 0, input, output, numFrames,
+                 std::index_sequence_for<Chains...>());
+    }
+
+    template <size_t I>
+    auto &get() { return std::get<I>(mChains); }
+
+private:
+    template <size_t... I>
+    void dispatch(size_t index, const float *input, float *output, int32_t numFrames,
+                  std::index_sequence<I...>) {
+        ((index == I && (std::get<I>(mChains).process(input, output, numFrames), true)) || ...);
+    }
+
+    std::tuple<Chains...> mChains;
+};
+
+} // namespace chain
+
+#endif //OBOEPASSTHROUGH_PROCESSORCHAIN_H
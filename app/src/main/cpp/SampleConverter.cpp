@@ -0,0 +1,287 @@
+#include "SampleConverter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "SimdVec4.h"
+
+namespace {
+
+using Format = SampleConverter::Format;
+
+// Integer full scale and the saturation bounds, as floats. I32's upper bound is the
+// largest float below 2^31.
+struct Range {
+    float scale;
+    float lo;
+    float hi;
+};
+
+constexpr Range kI16Range = {32768.0f, -32768.0f, 32767.0f};
+constexpr Range kI24Range = {8388608.0f, -8388608.0f, 8388607.0f};
+constexpr Range kI32Range = {2147483648.0f, -2147483648.0f, 2147483520.0f};
+
+inline int32_t unpack24(const uint8_t *p) {
+    return (int32_t) ((uint32_t) p[0] << 8 | (uint32_t) p[1] << 16 | (uint32_t) p[2] << 24) >> 8;
+}
+
+inline void pack24(uint8_t *p, int32_t x) {
+    p[0] = (uint8_t) x;
+    p[1] = (uint8_t) (x >> 8);
+    p[2] = (uint8_t) (x >> 16);
+}
+
+inline uint32_t xorshift(uint32_t &s) {
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    return s;
+}
+
+// The two 16-bit halves of one xorshift word are two uniforms; their sum is triangular
+// on (-1, 1) LSB
+constexpr float kTpdfScale = 1.0f / 65536.0f;
+
+inline float tpdf(uint32_t s) {
+    return (float) ((int32_t) (s >> 16) + (int32_t) (s & 0xffffu) - 65535) * kTpdfScale;
+}
+
+inline int32_t quantize(float x, const Range &range, float dither) {
+    const float v = std::min(range.hi, std::max(range.lo, x * range.scale + dither));
+    return (int32_t) lrintf(v);
+}
+
+// ---- int32 lanes next to simd::vec4 ----
+#if defined(SIMD_VEC4_NEON)
+
+typedef int32x4_t ivec4;
+typedef uint32x4_t uvec4;
+
+inline ivec4 roundToInt(simd::vec4 x) {
+#if defined(SIMD_VEC4_NEON_A64)
+    return vcvtnq_s32_f32(x);
+#else
+    // vcvtq truncates, so round half away from zero first
+    const float32x4_t half = vbslq_f32(vcltq_f32(x, vdupq_n_f32(0.0f)), vdupq_n_f32(-0.5f),
+                                       vdupq_n_f32(0.5f));
+    return vcvtq_s32_f32(vaddq_f32(x, half));
+#endif
+}
+
+inline simd::vec4 toVec(ivec4 x) { return vcvtq_f32_s32(x); }
+inline ivec4 loadI32(const int32_t *p) { return vld1q_s32(p); }
+inline void storeI32(int32_t *p, ivec4 v) { vst1q_s32(p, v); }
+inline ivec4 loadI16(const int16_t *p) { return vmovl_s16(vld1_s16(p)); }
+inline void storeI16(int16_t *p, ivec4 v) { vst1_s16(p, vqmovn_s32(v)); }
+inline uvec4 loadState(const uint32_t *p) { return vld1q_u32(p); }
+inline void storeState(uint32_t *p, uvec4 s) { vst1q_u32(p, s); }
+
+inline simd::vec4 nextTpdf(uvec4 &s) {
+    s = veorq_u32(s, vshlq_n_u32(s, 13));
+    s = veorq_u32(s, vshrq_n_u32(s, 17));
+    s = veorq_u32(s, vshlq_n_u32(s, 5));
+    const int32x4_t sum = vreinterpretq_s32_u32(vaddq_u32(vshrq_n_u32(s, 16),
+                                                          vandq_u32(s, vdupq_n_u32(0xffffu))));
+    return vmulq_n_f32(vcvtq_f32_s32(vsubq_s32(sum, vdupq_n_s32(65535))), kTpdfScale);
+}
+
+#elif defined(SIMD_VEC4_SSE)
+
+typedef __m128i ivec4;
+typedef __m128i uvec4;
+
+// Round to nearest under the default MXCSR mode
+inline ivec4 roundToInt(simd::vec4 x) { return _mm_cvtps_epi32(x); }
+inline simd::vec4 toVec(ivec4 x) { return _mm_cvtepi32_ps(x); }
+inline ivec4 loadI32(const int32_t *p) { return _mm_loadu_si128((const __m128i *) p); }
+inline void storeI32(int32_t *p, ivec4 v) { _mm_storeu_si128((__m128i *) p, v); }
+
+// Each int16 into the top half of its lane, then an arithmetic shift back down
+inline ivec4 loadI16(const int16_t *p) {
+    const __m128i x = _mm_loadl_epi64((const __m128i *) p);
+    return _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+}
+
+inline void storeI16(int16_t *p, ivec4 v) { _mm_storel_epi64((__m128i *) p, _mm_packs_epi32(v, v)); }
+inline uvec4 loadState(const uint32_t *p) { return _mm_loadu_si128((const __m128i *) p); }
+inline void storeState(uint32_t *p, uvec4 s) { _mm_storeu_si128((__m128i *) p, s); }
+
+inline simd::vec4 nextTpdf(uvec4 &s) {
+    s = _mm_xor_si128(s, _mm_slli_epi32(s, 13));
+    s = _mm_xor_si128(s, _mm_srli_epi32(s, 17));
+    s = _mm_xor_si128(s, _mm_slli_epi32(s, 5));
+    const __m128i sum = _mm_add_epi32(_mm_srli_epi32(s, 16), _mm_and_si128(s, _mm_set1_epi32(0xffff)));
+    return _mm_mul_ps(_mm_cvtepi32_ps(_mm_sub_epi32(sum, _mm_set1_epi32(65535))),
+                      _mm_set1_ps(kTpdfScale));
+}
+
+#else
+
+struct ivec4 {
+    int32_t v[4];
+};
+
+struct uvec4 {
+    uint32_t v[4];
+};
+
+inline ivec4 roundToInt(simd::vec4 x) {
+    ivec4 r;
+    for (int i = 0; i < 4; ++i) r.v[i] = (int32_t) lrintf(x.v[i]);
+    return r;
+}
+
+inline simd::vec4 toVec(ivec4 x) { return {{(float) x.v[0], (float) x.v[1], (float) x.v[2], (float) x.v[3]}}; }
+inline ivec4 loadI32(const int32_t *p) { return {{p[0], p[1], p[2], p[3]}}; }
+inline void storeI32(int32_t *p, ivec4 v) { for (int i = 0; i < 4; ++i) p[i] = v.v[i]; }
+inline ivec4 loadI16(const int16_t *p) { return {{p[0], p[1], p[2], p[3]}}; }
+inline void storeI16(int16_t *p, ivec4 v) { for (int i = 0; i < 4; ++i) p[i] = (int16_t) v.v[i]; }
+inline uvec4 loadState(const uint32_t *p) { return {{p[0], p[1], p[2], p[3]}}; }
+inline void storeState(uint32_t *p, uvec4 s) { for (int i = 0; i < 4; ++i) p[i] = s.v[i]; }
+
+inline simd::vec4 nextTpdf(uvec4 &s) {
+    simd::vec4 r;
+    for (int i = 0; i < 4; ++i) r.v[i] = tpdf(xorshift(s.v[i]));
+    return r;
+}
+
+#endif
+
+constexpr Range rangeOf(Format format) {
+    return format == Format::I16 ? kI16Range : format == Format::I24 ? kI24Range : kI32Range;
+}
+
+// One device sample, and four of them as int32 lanes
+template <Format F>
+inline int32_t loadInt(const void *input, int32_t at) {
+    if (F == Format::I16) return static_cast<const int16_t *>(input)[at];
+    if (F == Format::I32) return static_cast<const int32_t *>(input)[at];
+    return unpack24(static_cast<const uint8_t *>(input) + 3 * at);
+}
+
+template <Format F>
+inline void storeInt(void *output, int32_t at, int32_t x) {
+    if (F == Format::I16) {
+        static_cast<int16_t *>(output)[at] = (int16_t) x;
+    } else if (F == Format::I32) {
+        static_cast<int32_t *>(output)[at] = x;
+    } else {
+        pack24(static_cast<uint8_t *>(output) + 3 * at, x);
+    }
+}
+
+template <Format F>
+inline ivec4 loadInts(const void *input, int32_t at) {
+    if (F == Format::I16) return loadI16(static_cast<const int16_t *>(input) + at);
+    if (F == Format::I32) return loadI32(static_cast<const int32_t *>(input) + at);
+    alignas(16) int32_t lanes[4];
+    for (int i = 0; i < 4; ++i) lanes[i] = loadInt<F>(input, at + i);
+    return loadI32(lanes);
+}
+
+template <Format F>
+inline void storeInts(void *output, int32_t at, ivec4 q) {
+    if (F == Format::I16) {
+        storeI16(static_cast<int16_t *>(output) + at, q);
+    } else if (F == Format::I32) {
+        storeI32(static_cast<int32_t *>(output) + at, q);
+    } else {
+        alignas(16) int32_t lanes[4];
+        storeI32(lanes, q);
+        for (int i = 0; i < 4; ++i) storeInt<F>(output, at + i, lanes[i]);
+    }
+}
+
+// Eight samples per step, as two independent vectors
+template <Format F>
+void widen(const void *input, float *output, int32_t numSamples) {
+    const float k = 1.0f / rangeOf(F).scale;
+    const simd::vec4 kv = simd::set1(k);
+    int32_t i = 0;
+    for (; i + 8 <= numSamples; i += 8) {
+        simd::store(output + i, simd::mul(toVec(loadInts<F>(input, i)), kv));
+        simd::store(output + i + 4, simd::mul(toVec(loadInts<F>(input, i + 4)), kv));
+    }
+    for (; i < numSamples; ++i) output[i] = loadInt<F>(input, i) * k;
+}
+
+// Scaled, dithered, saturated and rounded. Each vector has its own dither lanes, so the
+// two xorshift chains run side by side; the tail continues from state[0].
+template <Format F>
+void narrow(const float *input, void *output, int32_t numSamples, bool dither, uint32_t *state) {
+    constexpr Range range = rangeOf(F);
+    const simd::vec4 scale = simd::set1(range.scale);
+    const simd::vec4 lo = simd::set1(range.lo);
+    const simd::vec4 hi = simd::set1(range.hi);
+    uvec4 s0 = loadState(state);
+    uvec4 s1 = loadState(state + 4);
+    int32_t i = 0;
+    for (; i + 8 <= numSamples; i += 8) {
+        simd::vec4 v0 = simd::mul(simd::load(input + i), scale);
+        simd::vec4 v1 = simd::mul(simd::load(input + i + 4), scale);
+        if (dither) {
+            v0 = simd::add(v0, nextTpdf(s0));
+            v1 = simd::add(v1, nextTpdf(s1));
+        }
+        storeInts<F>(output, i, roundToInt(simd::min(simd::max(v0, lo), hi)));
+        storeInts<F>(output, i + 4, roundToInt(simd::min(simd::max(v1, lo), hi)));
+    }
+    storeState(state, s0);
+    storeState(state + 4, s1);
+    for (; i < numSamples; ++i) {
+        storeInt<F>(output, i, quantize(input[i], range, dither ? tpdf(xorshift(state[0])) : 0.0f));
+    }
+}
+
+} // namespace
+
+int32_t SampleConverter::bytesPerSample(Format format) {
+    switch (format) {
+        case Format::I16:
+            return 2;
+        case Format::I24:
+            return 3;
+        default:
+            return 4;
+    }
+}
+
+void SampleConverter::configure(Format format, bool dither) {
+    mFormat = format;
+    mDither = dither;
+}
+
+void SampleConverter::toFloat(const void *input, float *output, int32_t numSamples) const {
+    switch (mFormat) {
+        case Format::Float:
+            if (input != output) std::memcpy(output, input, (size_t) numSamples * sizeof(float));
+            break;
+        case Format::I16:
+            widen<Format::I16>(input, output, numSamples);
+            break;
+        case Format::I24:
+            widen<Format::I24>(input, output, numSamples);
+            break;
+        case Format::I32:
+            widen<Format::I32>(input, output, numSamples);
+            break;
+    }
+}
+
+void SampleConverter::fromFloat(const float *input, void *output, int32_t numSamples) {
+    switch (mFormat) {
+        case Format::Float:
+            if (input != output) std::memcpy(output, input, (size_t) numSamples * sizeof(float));
+            break;
+        case Format::I16:
+            narrow<Format::I16>(input, output, numSamples, mDither, mDitherState);
+            break;
+        case Format::I24:
+            narrow<Format::I24>(input, output, numSamples, mDither, mDitherState);
+            break;
+        case Format::I32:
+            narrow<Format::I32>(input, output, numSamples, false, mDitherState);
+            break;
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef OBOEPASSTHROUGH_SAMPLECONVERTER_H
+#define OBOEPASSTHROUGH_SAMPLECONVERTER_H
+
+#include <cstdint>
+
+/**
+ * Converts between the engine's float samples and a stream's device format, so the
+ * streams can open in whatever format the device's fast (MMAP) path uses, typically I16
+ * or I24, instead of asking for float and getting a shared or converted stream.
+ *
+ * Eight samples at a time on NEON / SSE2 (see SimdVec4.h), scalar for the tail. Integer
+ * input is scaled to [-1, 1). Float output is scaled to the integer range, saturated at
+ * full scale, and rounded to nearest. I16 and I24 output first get TPDF dither
+ * of +-1 LSB from eight xorshift32 lanes. That keeps the requantization error a flat
+ * noise floor instead of distortion on quiet signals. I32 output is not dithered:
+ * float's 24-bit mantissa is already coarser than its LSB. I24 is packed (3 bytes,
+ * little-endian), and its byte shuffle is scalar.
+ *
+ * configure() runs while the stream is stopped. toFloat() and fromFloat() run on the
+ * audio thread and do not allocate. Each stream needs its own converter, because
+ * fromFloat() advances the dither state.
+ */
+class SampleConverter {
+public:
+    enum class Format : int32_t {
+        Float = 0,
+        I16 = 1,
+        I24 = 2,        // packed
+        I32 = 3,
+    };
+
+    static int32_t bytesPerSample(Format format);
+
+    // ---- control thread ----
+    void configure(Format format, bool dither = true);
+    Format getFormat() const { return mFormat; }
+    bool isDithered() const { return mDither; }
+
+    // ---- audio thread ----
+    // numSamples counts samples, not bytes or frames.
+    void toFloat(const void *input, float *output, int32_t numSamples) const;
+    void fromFloat(const float *input, void *output, int32_t numSamples);
+
+private:
+    Format mFormat = Format::Float;
+    bool mDither = true;
+    uint32_t mDitherState[8] = {0x9e3779b9u, 0x243f6a88u, 0xb7e15163u, 0x85a308d3u,
+                                0x13198a2eu, 0x03707344u, 0xa4093822u, 0x299f31d0u};
+};
+
+#endif //OBOEPASSTHROUGH_SAMPLECONVERTER_H
@@ -0,0 +1,156 @@
+#ifndef OBOEPASSTHROUGH_SIMDVEC4_H
+#define OBOEPASSTHROUGH_SIMDVEC4_H
+
+/**
+ * Minimal 4 x float vector used by the hand-vectorized DSP kernels.
+ * NEON on arm64-v8a / armeabi-v7a, SSE2 on x86 / x86_64, plain structs elsewhere.
+ * All loads and stores are unaligned.
+ *
+ * PASSTHROUGH_NEON_EMULATION=64 (or 32) selects the AArch64 (or ARMv7) NEON branch on a
+ * host, against the lane-by-lane arm_neon.h in test/neon-emulation.
+ */
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(PASSTHROUGH_NEON_EMULATION)
+#include <arm_neon.h>
+#define SIMD_VEC4_NEON 1
+#if defined(__aarch64__) || PASSTHROUGH_NEON_EMULATION == 64
+#define SIMD_VEC4_NEON_A64 1
+#endif
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SIMD_VEC4_SSE 1
+#endif
+
+namespace simd {
+
+#if defined(SIMD_VEC4_NEON)
+
+typedef float32x4_t vec4;
+
+inline vec4 load(const float *p) { return vld1q_f32(p); }
+inline void store(float *p, vec4 v) { vst1q_f32(p, v); }
+inline vec4 set1(float x) { return vdupq_n_f32(x); }
+inline vec4 add(vec4 a, vec4 b) { return vaddq_f32(a, b); }
+inline vec4 sub(vec4 a, vec4 b) { return vsubq_f32(a, b); }
+inline vec4 mul(vec4 a, vec4 b) { return vmulq_f32(a, b); }
+inline vec4 neg(vec4 a) { return vnegq_f32(a); }
+inline vec4 min(vec4 a, vec4 b) { return vminq_f32(a, b); }
+inline vec4 max(vec4 a, vec4 b) { return vmaxq_f32(a, b); }
+
+// a * b + c
+inline vec4 madd(vec4 a, vec4 b, vec4 c) {
+#if defined(SIMD_VEC4_NEON_A64)
+    return vfmaq_f32(c, a, b);
+#else
+    return vmlaq_f32(c, a, b);
+#endif
+}
+
+// [a3 a2 a1 a0]
+inline vec4 reverse(vec4 a) {
+    vec4 r = vrev64q_f32(a);
+    return vcombine_f32(vget_high_f32(r), vget_low_f32(r));
+}
+
+// p[0,2,4,6] -> even, p[1,3,5,7] -> odd
+inline void loadDeinterleave(const float *p, vec4 &even, vec4 &odd) {
+    float32x4x2_t v = vld2q_f32(p);
+    even = v.val[0];
+    odd = v.val[1];
+}
+
+// p[0..7] = a0 b0 a1 b1 a2 b2 a3 b3
+inline void storeInterleave(float *p, vec4 a, vec4 b) {
+    float32x4x2_t v = {{a, b}};
+    vst2q_f32(p, v);
+}
+
+inline void transpose(vec4 &r0, vec4 &r1, vec4 &r2, vec4 &r3) {
+    float32x4x2_t t01 = vtrnq_f32(r0, r1);
+    float32x4x2_t t23 = vtrnq_f32(r2, r3);
+    r0 = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+    r1 = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+    r2 = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+    r3 = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+}
+
+#elif defined(SIMD_VEC4_SSE)
+
+typedef __m128 vec4;
+
+inline vec4 load(const float *p) { return _mm_loadu_ps(p); }
+inline void store(float *p, vec4 v) { _mm_storeu_ps(p, v); }
+inline vec4 set1(float x) { return _mm_set1_ps(x); }
+inline vec4 add(vec4 a, vec4 b) { return _mm_add_ps(a, b); }
+inline vec4 sub(vec4 a, vec4 b) { return _mm_sub_ps(a, b); }
+inline vec4 mul(vec4 a, vec4 b) { return _mm_mul_ps(a, b); }
+inline vec4 neg(vec4 a) { return _mm_xor_ps(a, _mm_set1_ps(-0.0f)); }
+inline vec4 min(vec4 a, vec4 b) { return _mm_min_ps(a, b); }
+inline vec4 max(vec4 a, vec4 b) { return _mm_max_ps(a, b); }
+inline vec4 madd(vec4 a, vec4 b, vec4 c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+inline vec4 reverse(vec4 a) { return _mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 1, 2, 3)); }
+
+inline void loadDeinterleave(const float *p, vec4 &even, vec4 &odd) {
+    __m128 lo = _mm_loadu_ps(p);
+    __m128 hi = _mm_loadu_ps(p + 4);
+    even = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0));
+    odd = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1));
+}
+
+inline void storeInterleave(float *p, vec4 a, vec4 b) {
+    _mm_storeu_ps(p, _mm_unpacklo_ps(a, b));
+    _mm_storeu_ps(p + 4, _mm_unpackhi_ps(a, b));
+}
+
+inline void transpose(vec4 &r0, vec4 &r1, vec4 &r2, vec4 &r3) {
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+}
+
+#else
+
+struct vec4 {
+    float v[4];
+};
+
+inline vec4 load(const float *p) { return {{p[0], p[1], p[2], p[3]}}; }
+inline void store(float *p, vec4 a) { for (int i = 0; i < 4; ++i) p[i] = a.v[i]; }
+inline vec4 set1(float x) { return {{x, x, x, x}}; }
+#define SIMD_VEC4_SCALAR_OP(name, expr) \
+    inline vec4 name(vec4 a, vec4 b) { vec4 r; for (int i = 0; i < 4; ++i) r.v[i] = (expr); return r; }
+SIMD_VEC4_SCALAR_OP(add, a.v[i] + b.v[i])
+SIMD_VEC4_SCALAR_OP(sub, a.v[i] - b.v[i])
+SIMD_VEC4_SCALAR_OP(mul, a.v[i] * b.v[i])
+SIMD_VEC4_SCALAR_OP(min, a.v[i] < b.v[i] ? a.v[i] : b.v[i])
+SIMD_VEC4_SCALAR_OP(max, a.v[i] > b.v[i] ? a.v[i] : b.v[i])
+#undef SIMD_VEC4_SCALAR_OP
+inline vec4 neg(vec4 a) { return {{-a.v[0], -a.v[1], -a.v[2], -a.v[3]}}; }
+inline vec4 madd(vec4 a, vec4 b, vec4 c) { return add(mul(a, b), c); }
+inline vec4 reverse(vec4 a) { return {{a.v[3], a.v[2], a.v[1], a.v[0]}}; }
+
+inline void loadDeinterleave(const float *p, vec4 &even, vec4 &odd) {
+    even = {{p[0], p[2], p[4], p[6]}};
+    odd = {{p[1], p[3], p[5], p[7]}};
+}
+
+inline void storeInterleave(float *p, vec4 a, vec4 b) {
+    for (int i = 0; i < 4; ++i) {
+        p[2 * i] = a.v[i];
+        p[2 * i + 1] = b.v[i];
+    }
+}
+
+inline void transpose(vec4 &r0, vec4 &r1, vec4 &r2, vec4 &r3) {
+    vec4 t0 = r0, t1 = r1, t2 = r2, t3 = r3;
+    for (int i = 0; i < 4; ++i) {
+        r0.v[i] = (i == 0 ? t0 : i == 1 ? t1 : i == 2 ? t2 : t3).v[0];
+        r1.v[i] = (i == 0 ? t0 : i == 1 ? t1 : i == 2 ? t2 : t3).v[1];
+        r2.v[i] = (i == 0 ? t0 : i == 1 ? t1 : i == 2 ? t2 : t3).v[2];
+        r3.v[i] = (i == 0 ? t0 : i == 1 ? t1 : i == 2 ? t2 : t3).v[3];
+    }
+}
+
+#endif
+
+} // namespace simd
+
+#endif //OBOEPASSTHROUGH_SIMDVEC4_H
@@ -0,0 +1,116 @@
+#include "SpectralGainTable.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "SimdVec4.h"
+
+void SpectralGainTable::setFftSize(int32_t fftSize, int32_t sampleRate) {
+    if (fftSize == mFftSize && sampleRate == mSampleRate) return;
+    mFftSize = fftSize;
+    mSampleRate = sampleRate;
+    rebuild();
+}
+
+void SpectralGainTable::setBandLimits(float lowHz, float highHz) {
+    if (lowHz == mLowHz && highHz == mHighHz) return;
+    mLowHz = lowHz;
+    mHighHz = highHz;
+    rebuild();
+}
+
+void SpectralGainTable::setGainCurve(std::vector<GainPoint> points) {
+    std::sort(points.begin(), points.end(), [](const GainPoint &a, const GainPoint &b) {
+        return a.frequencyHz < b.frequencyHz;
+    });
+    points.erase(std::remove_if(points.begin(), points.end(),
+                                [](const GainPoint &p) { return p.frequencyHz <= 0.0f; }),
+                 points.end());
+    mCurve = std::move(points);
+    rebuild();
+}
+
+void SpectralGainTable::setSmoothingOctaves(float octaves) {
+    if (octaves == mSmoothingOctaves) return;
+    mSmoothingOctaves = octaves;
+    rebuild();
+}
+
+void SpectralGainTable::setMaxGainDb(float maxGainDb) {
+    if (maxGainDb == mMaxGainDb) return;
+    mMaxGainDb = maxGainDb;
+    rebuild();
+}
+
+float SpectralGainTable::curveGainDb(float frequencyHz) const {
+    if (mCurve.empty()) return 0.0f;
+    if (frequencyHz <= mCurve.front().frequencyHz) return mCurve.front().gainDb;
+    if (frequencyHz >= mCurve.back().frequencyHz) return mCurve.back().gainDb;
+    auto upper = std::upper_bound(mCurve.begin(), mCurve.end(), frequencyHz,
+                                  [](float f, const GainPoint &p) { return f < p.frequencyHz; });
+    auto lower = upper - 1;
+    float t = log2f(frequencyHz / lower->frequencyHz) /
+              log2f(upper->frequencyHz / lower->frequencyHz);
+    return lower->gainDb + t * (upper->gainDb - lower->gainDb);
+}
+
+void SpectralGainTable::rebuild() {
+    if (mFftSize <= 0 || mSampleRate <= 0) return;
+    const int32_t bins = mFftSize / 2 + 1;
+    const float binHz = (float) mSampleRate / mFftSize;
+
+    std::vector<float> curveDb(bins);
+    for (int32_t k = 0; k < bins; ++k) {
+        // DC has no log-frequency position; give it the lowest point's gain
+        curveDb[k] = curveGainDb(std::max(k, 1) * binHz);
+    }
+
+    // Fractional-octave smoothing: average over bins within +-octaves/2 of each bin
+    std::vector<float> smoothedDb(curveDb);
+    if (mSmoothingOctaves > 0.0f && !mCurve.empty()) {
+        const float halfWidth = exp2f(0.5f * mSmoothingOctaves);
+        for (int32_t k = 1; k < bins; ++k) {
+            int32_t lo = std::max<int32_t>(1, (int32_t) floorf(k / halfWidth));
+            int32_t hi = std::min<int32_t>(bins - 1, (int32_t) ceilf(k * halfWidth));
+            float sum = 0.0f;
+            for (int32_t j = lo; j <= hi; ++j) sum += curveDb[j];
+            smoothedDb[k] = sum / (hi - lo + 1);
+        }
+    }
+
+    Table &table = mTables.writeBuffer();
+    table.gains.resize(2 * bins);
+    table.active = BinRange();
+    mBinGains.resize(bins);
+    for (int32_t k = 0; k < bins; ++k) {
+        float freq = k * binHz;
+        bool inBand = freq >= mLowHz && freq <= mHighHz;
+        float gain = inBand ? powf(10.0f, std::min(smoothedDb[k], mMaxGainDb) / 20.0f) : 0.0f;
+        mBinGains[k] = gain;
+        table.gains[2 * k] = gain;
+        table.gains[2 * k + 1] = gain;
+        if (gain != 0.0f) {
+            if (table.active.end == 0) table.active.begin = k;
+            table.active.end = k + 1;
+        }
+    }
+    mTables.publish();
+}
+
+SpectralGainTable::BinRange SpectralGainTable::apply(kiss_fft_cpx *spectrum) {
+    const Table &table = mTables.read();
+    float *s = reinterpret_cast<float *>(spectrum);
+    const float *g = table.gains.data();
+    const int32_t begin = 2 * table.active.begin;
+    const int32_t end = 2 * table.active.end;
+    std::fill(s, s + begin, 0.0f);
+    int32_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        simd::store(s + i, simd::mul(simd::load(s + i), simd::load(g + i)));
+    }
+    for (; i < end; ++i) {
+        s[i] *= g[i];
+    }
+    std::fill(s + end, s + table.gains.size(), 0.0f);
+    return table.active;
+}
@@ -0,0 +1,76 @@
+#ifndef OBOEPASSTHROUGH_SPECTRALGAINTABLE_H
+#define OBOEPASSTHROUGH_SPECTRALGAINTABLE_H
+
+#include <cstdint>
+#include <vector>
+
+#include "kiss_fft.h"
+#include "TripleBuffer.h"
+
+/**
+ * Per-bin gain for the spectral path, precomputed from a prescription curve.
+ *
+ * The curve is a list of (frequency, gain dB) points, e.g. derived from a user's
+ * audiogram. It is interpolated linearly on a log-frequency axis, smoothed across
+ * bins with a fractional-octave window, capped, and multiplied by the band-pass
+ * mask. Without a curve the table is the plain band-pass mask.
+ *
+ * The table also records the range of bins with nonzero gain. apply() multiplies only
+ * inside it and zero-fills the rest, and returns the range so the inverse FFT can skip
+ * the zeros.
+ *
+ * The setters and rebuild() run on a control thread and publish a new table through a
+ * TripleBuffer; apply() runs on the audio thread and is a single vectorized multiply.
+ */
+class SpectralGainTable {
+public:
+    struct GainPoint {
+        float frequencyHz;
+        float gainDb;
+    };
+
+    // Bins [begin, end); empty when every gain is zero.
+    struct BinRange {
+        int32_t begin = 0;
+        int32_t end = 0;
+    };
+
+    // ---- control thread ----
+    // Each setter rebuilds only if the value actually changed.
+    void setFftSize(int32_t fftSize, int32_t sampleRate);
+    void setBandLimits(float lowHz, float highHz);
+    void setGainCurve(std::vector<GainPoint> points);
+    void setSmoothingOctaves(float octaves);
+    void setMaxGainDb(float maxGainDb);
+
+    // Prescription gain in dB at a frequency, before smoothing, capping and band limits.
+    float curveGainDb(float frequencyHz) const;
+    // Linear gain per bin (fftSize / 2 + 1) as last built, for tables in other formats.
+    const std::vector<float> &getBinGains() const { return mBinGains; }
+
+    // ---- audio thread ----
+    // spectrum has fftSize / 2 + 1 bins; it is zero outside the returned range.
+    BinRange apply(kiss_fft_cpx *spectrum);
+
+private:
+    void rebuild();
+
+    int32_t mFftSize = 0;
+    int32_t mSampleRate = 0;
+    float mLowHz = 125.0f;
+    float mHighHz = 18000.0f;
+    float mSmoothingOctaves = 1.0f / 3.0f;
+    float mMaxGainDb = 40.0f;
+    std::vector<GainPoint> mCurve;
+    std::vector<float> mBinGains;
+
+    struct Table {
+        // Gains duplicated per bin (g0 g0 g1 g1 ...) to line up with interleaved re/im
+        std::vector<float> gains;
+        BinRange active;
+    };
+
+    TripleBuffer<Table> mTables;
+};
+
+#endif //OBOEPASSTHROUGH_SPECTRALGAINTABLE_H
@@ -0,0 +1,273 @@
+#include "SpectralPath.h"
+
+#include <algorithm>
+#include <chrono>
+
+SpectralPath::SpectralPath() :
+        mRetired(8),
+        mNextOutput(kMaxCrossfadeCallback * SpectralProcessor::kMaxChannels) {
+}
+
+void SpectralPath::setChannelCount(int32_t channels) {
+    mChannelCount = std::max(1, std::min(channels, SpectralProcessor::kMaxChannels));
+}
+
+void SpectralPath::configure(const SpectralProcessor::Config &config, int32_t sampleRate,
+                             int32_t maxCompressorBands) {
+    collectRetired();
+    mMaxCompressorBands = maxCompressorBands;
+    auto processor = std::make_unique<SpectralProcessor>(config, sampleRate, mChannelCount);
+    processor->setGainCurve(mGainCurve);
+    processor->setCompressorBands(limitedBands());
+    mConfig = processor->getConfig();
+
+    SpectralProcessor *raw = processor.get();
+    mOwned.push_back(std::move(processor));
+    // A pending processor the audio thread never picked up is simply superseded
+    SpectralProcessor *superseded = mPending.exchange(raw, std::memory_order_acq_rel);
+    if (superseded) {
+        release(superseded);
+    }
+}
+
+void SpectralPath::setGainCurve(std::vector<SpectralGainTable::GainPoint> points) {
+    collectRetired();
+    mGainCurve = std::move(points);
+    for (auto &processor : mOwned) {
+        processor->setGainCurve(mGainCurve);
+    }
+}
+
+void SpectralPath::setCompressorBands(const std::vector<MultibandCompressor::BandParams> &bands) {
+    collectRetired();
+    mCompressorBands = bands;
+    for (auto &processor : mOwned) {
+        processor->setCompressorBands(limitedBands());
+    }
+}
+
+std::vector<MultibandCompressor::BandParams> SpectralPath::limitedBands() const {
+    return MultibandCompressor::mergeBands(mCompressorBands, mMaxCompressorBands);
+}
+
+void SpectralPath::reset() {
+    mPending.store(nullptr, std::memory_order_relaxed);
+    mCurrent = nullptr;
+    mNext = nullptr;
+    mUnretired = nullptr;
+    mBypassed = false;
+    mBypassPosition = mBypass ? kCrossfadeFrames : 0;
+    mRetired.consume(mRetired.availableToRead());
+    mOwned.clear();
+}
+
+void SpectralPath::collectRetired() {
+    SpectralProcessor *processor;
+    while (mRetired.read(&processor, 1) == 1) {
+        release(processor);
+    }
+}
+
+void SpectralPath::release(SpectralProcessor *processor) {
+    mOwned.erase(std::remove_if(mOwned.begin(), mOwned.end(),
+                                [processor](const std::unique_ptr<SpectralProcessor> &p) {
+                                    return p.get() == processor;
+                                }),
+                 mOwned.end());
+}
+
+SpectralProcessor::Config SpectralPath::chooseAutoConfig(const SpectralProcessor::Config &base,
+                                                         int32_t burstFrames, int32_t sampleRate,
+                                                         double budgetShare, int32_t channels) {
+    using Clock = std::chrono::steady_clock;
+    const int32_t burst = std::max(burstFrames, 16);
+    const double budgetNs = budgetShare * 1e9 * burst / sampleRate;
+    std::vector<float> in((size_t) burst * channels), out((size_t) burst * channels);
+    for (size_t i = 0; i < in.size(); ++i) in[i] = (i % 7) * 0.01f;
+
+    const int32_t overlap = base.sanitized().overlap;
+    std::vector<int32_t> sizes;
+    for (int32_t size = kMinAutoFftSize; size <= kMaxAutoFftSize; size += 32) {
+        const int32_t hop = size / overlap;
+        if (fft_backend_next_size(size) == size && (burst % hop == 0 || hop % burst == 0)) {
+            sizes.push_back(size);
+        }
+    }
+    if (sizes.empty()) {
+        for (int32_t size = kMinAutoFftSize; size <= kMaxAutoFftSize; size <<= 1) {
+            sizes.push_back(size);
+        }
+    }
+
+    SpectralProcessor::Config best = base;
+    double bestNs = 1e30;
+    for (int32_t size : sizes) {
+        SpectralProcessor::Config candidate = base;
+        candidate.fftSize = size;
+        SpectralProcessor processor(candidate, sampleRate, channels);
+
+        // Every callback phase relative to the hop, a few times over, after a warm-up
+        const int32_t calls = 4 * std::max(size / burst, 1) + 16;
+        double worstNs = 0.0;
+        for (int32_t i = 0; i < 2 * calls; ++i) {
+            auto t0 = Clock::now();
+            processor.process(in.data(), burst, out.data(), burst);
+            auto t1 = Clock::now();
+            if (i >= calls) {
+                worstNs = std::max(worstNs, std::chrono::duration<double, std::nano>(t1 - t0).count());
+            }
+        }
+        if (worstNs <= budgetNs) {
+            return processor.getConfig();
+        }
+        if (worstNs < bestNs) {
+            bestNs = worstNs;
+            best = processor.getConfig();
+        }
+    }
+    return best;
+}
+
+namespace {
+
+void copyDry(const float *input, int32_t numInput, float *output, int32_t numOutput, int32_t channels) {
+    const size_t n = (size_t) std::min(numInput, numOutput) * channels;
+    std::copy(input, input + n, output);
+    std::fill(output + n, output + (size_t) numOutput * channels, 0.0f);
+}
+
+}
+
+int32_t SpectralPath::process(const float *input, int32_t numInput,
+                              float *output, int32_t numOutput) {
+    if (mBypassed) {
+        if (mBypass) {
+            copyDry(input, numInput, output, numOutput, mChannelCount);
+            return numOutput;
+        }
+        // Coming back: a clean processor (a newly configured one if there is one) has to
+        // prime before fading in
+        SpectralProcessor *pending = takePending();
+        if (pending) {
+            if (mCurrent) retire(mCurrent);
+            mCurrent = pending;
+        } else if (mCurrent) {
+            mCurrent->restart();
+        }
+        mBypassed = false;
+    }
+
+    int32_t delivered = processWet(input, numInput, output, numOutput);
+    if (!mBypass && mBypassPosition == 0) {
+        return delivered;
+    }
+    if (!mBypass && mBypassPosition == kCrossfadeFrames && delivered < numOutput) {
+        copyDry(input, numInput, output, numOutput, mChannelCount);
+        return numOutput;
+    }
+
+    const int32_t channels = mChannelCount;
+    for (int32_t i = 0; i < numOutput; ++i) {
+        if (mBypass) {
+            mBypassPosition += mBypassPosition < kCrossfadeFrames;
+        } else {
+            mBypassPosition -= mBypassPosition > 0;
+        }
+        const float g = (float) mBypassPosition / kCrossfadeFrames;
+        for (int32_t c = 0; c < channels; ++c) {
+            const size_t k = (size_t) i * channels + c;
+            const float dry = i < numInput ? input[k] : 0.0f;
+            output[k] += g * (dry - output[k]);
+        }
+    }
+    if (mBypass && mBypassPosition == kCrossfadeFrames) {
+        // Fully dry: finish any processor swap now, the processor rests until we leave
+        mBypassed = true;
+        if (mNext) {
+            retire(mCurrent);
+            mCurrent = mNext;
+            mNext = nullptr;
+        }
+    }
+    return numOutput;
+}
+
+int32_t SpectralPath::processWet(const float *input, int32_t numInput,
+                                 float *output, int32_t numOutput) {
+    if (!mNext) {
+        SpectralProcessor *pending = takePending();
+        if (pending) {
+            if (mCurrent && numOutput <= kMaxCrossfadeCallback) {
+                mNext = pending;
+                mFadePosition = 0;
+            } else {
+                if (mCurrent) retire(mCurrent);
+                mCurrent = pending;
+            }
+        }
+    }
+
+    const int32_t channels = mChannelCount;
+    if (!mCurrent) {
+        std::fill(output, output + (size_t) numOutput * channels, 0.0f);
+        return 0;
+    }
+
+    int32_t delivered = mCurrent->process(input, numInput, output, numOutput);
+    if (!mNext) {
+        return delivered;
+    }
+
+    if (numOutput > kMaxCrossfadeCallback) {
+        // No room to run both; cut over now
+        retire(mCurrent);
+        mCurrent = mNext;
+        mNext = nullptr;
+        return delivered;
+    }
+
+    // Let the new processor fill before fading to it
+    float *next = mNextOutput.data();
+    int32_t nextDelivered = mNext->process(input, numInput, next, numOutput);
+    if (mFadePosition == 0 && nextDelivered < numOutput) {
+        return delivered;
+    }
+
+    int32_t i = 0;
+    for (; i < numOutput && mFadePosition < kCrossfadeFrames; ++i, ++mFadePosition) {
+        float g = (float) mFadePosition / kCrossfadeFrames;
+        for (int32_t c = 0; c < channels; ++c) {
+            const size_t k = (size_t) i * channels + c;
+            output[k] += g * (next[k] - output[k]);
+        }
+    }
+    if (mFadePosition >= kCrossfadeFrames) {
+        // The rest of this callback is all new output
+        std::copy(next + (size_t) i * channels, next + (size_t) numOutput * channels,
+                  output + (size_t) i * channels);
+        retire(mCurrent);
+        mCurrent = mNext;
+        mNext = nullptr;
+        return nextDelivered;
+    }
+    return delivered;
+}
+
+SpectralProcessor *SpectralPath::takePending() {
+    // Every processor taken replaces one, so it owes the ring one slot, and none is taken
+    // while a swap is still owing. With no slot free the pending one waits for the control
+    // thread to collect, which its next call does.
+    if (mUnretired && mRetired.write(&mUnretired, 1) == 1) mUnretired = nullptr;
+    if (mUnretired || mRetired.availableToWrite() == 0) return nullptr;
+    return mPending.exchange(nullptr, std::memory_order_acq_rel);
+}
+
+void SpectralPath::retire(SpectralProcessor *processor) {
+    // Can't fail after takePending()'s check; if it ever did, hold on to the processor
+    // rather than lose it, and take no other until it is handed back
+    if (mRetired.write(&processor, 1) == 0) mUnretired = processor;
+}
+
+const SpectralProcessor::Flow &SpectralPath::getLastFlow() const {
+    return mCurrent && !mBypassed ? mCurrent->getLastFlow() : mIdleFlow;
+}
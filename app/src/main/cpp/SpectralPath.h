@@ -0,0 +1,129 @@
+#ifndef OBOEPASSTHROUGH_SPECTRALPATH_H
+#define OBOEPASSTHROUGH_SPECTRALPATH_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "MultibandCompressor.h"
+#include "SpectralGainTable.h"
+#include "SpectralProcessor.h"
+#include "SpscRingBuffer.h"
+
+/**
+ * Owns the SpectralProcessor the audio thread runs and swaps in reconfigured ones
+ * (FFT size, overlap, window, sample rate) while audio keeps flowing.
+ *
+ * configure() builds the new processor, with its FFT plans and buffers, on the control
+ * thread and hands it over through an atomic pointer. The audio thread then feeds both
+ * processors until the new one delivers a full callback, crossfades from the old output
+ * to the new over kCrossfadeFrames, and hands the old processor back through a ring for
+ * the control thread to delete. A processor is only taken while the ring has room for the
+ * one it replaces, so none is ever dropped from ownership. The audio thread never
+ * allocates or frees.
+ *
+ * The gain curve and compressor bands are remembered and applied to every processor.
+ * Audio is interleaved frames of getChannelCount() channels, each processed on its own
+ * (see SpectralProcessor).
+ *
+ * setBypass() crossfades to the dry input over kCrossfadeFrames and then stops running
+ * the processor altogether; leaving bypass restarts it (or installs one configured in
+ * the meantime) and fades back once it delivers. The load governor's last rung.
+ */
+class SpectralPath {
+public:
+    static constexpr int32_t kCrossfadeFrames = 512;
+    // Longer callbacks than this switch processors without a crossfade.
+    static constexpr int32_t kMaxCrossfadeCallback = 4096;
+
+    SpectralPath();
+
+    SpectralPath(const SpectralPath &) = delete;
+    SpectralPath &operator=(const SpectralPath &) = delete;
+
+    // ---- control thread ----
+    // maxCompressorBands merges the compressor bands down (see MultibandCompressor::mergeBands)
+    // for this and later processors, without changing the remembered bands.
+    void configure(const SpectralProcessor::Config &config, int32_t sampleRate,
+                   int32_t maxCompressorBands = MultibandCompressor::kMaxBands);
+    void setGainCurve(std::vector<SpectralGainTable::GainPoint> points);
+    void setCompressorBands(const std::vector<MultibandCompressor::BandParams> &bands);
+    // Only while the audio thread is stopped, before configure(): processors built from
+    // then on take this many interleaved channels.
+    void setChannelCount(int32_t channels);
+    int32_t getChannelCount() const { return mChannelCount; }
+    // Config of the most recently configured processor.
+    SpectralProcessor::Config getConfig() const { return mConfig; }
+    // As set, before any merge by configure().
+    int32_t getNumCompressorBands() const { return (int32_t) mCompressorBands.size(); }
+
+    // Only while the audio thread is stopped: drops every processor. The next configure()
+    // is installed by the first callback without a crossfade.
+    void reset();
+
+    /**
+     * Picks the smallest FFT size from kMinAutoFftSize up whose measured worst-case
+     * callback cost fits budgetShare of a burstFrames callback, keeping base's overlap
+     * and window. Runs the candidates on the calling thread for a few hops each; falls
+     * back to the cheapest candidate when none fits.
+     *
+     * Candidates are the burst-aligned sizes, whose hop divides the burst or is a
+     * multiple of it (e.g. 384 for a 192-frame burst at 50% overlap), so every callback
+     * runs the same number of hops or every hop the same number of callbacks, and the
+     * FIFOs need no slack for uneven bursts. Powers of two only when the burst allows none.
+     * Measured with all the channels the processor will run.
+     */
+    static SpectralProcessor::Config chooseAutoConfig(const SpectralProcessor::Config &base,
+                                                      int32_t burstFrames, int32_t sampleRate,
+                                                      double budgetShare = 0.25,
+                                                      int32_t channels = 1);
+    static constexpr int32_t kMinAutoFftSize = 256;
+    static constexpr int32_t kMaxAutoFftSize = 4096;
+
+    // ---- audio thread ----
+    // Same contract as SpectralProcessor::process(); zero output until configured.
+    int32_t process(const float *input, int32_t numInput, float *output, int32_t numOutput);
+    const SpectralProcessor::Flow &getLastFlow() const;
+    // Of the processor currently playing; see SpectralProcessor::getLatencyFrames().
+    int32_t getLatencyFrames() const {
+        return mCurrent && !mBypassed ? mCurrent->getLatencyFrames() : 0;
+    }
+    // Takes effect, crossfaded, from the next process().
+    void setBypass(bool bypass) { mBypass = bypass; }
+    bool isBypassed() const { return mBypassed; }
+
+private:
+    int32_t processWet(const float *input, int32_t numInput, float *output, int32_t numOutput);
+    void collectRetired();
+    void release(SpectralProcessor *processor);
+    SpectralProcessor *takePending();
+    void retire(SpectralProcessor *processor);
+    std::vector<MultibandCompressor::BandParams> limitedBands() const;
+
+    // control thread
+    std::vector<std::unique_ptr<SpectralProcessor>> mOwned;
+    SpectralProcessor::Config mConfig;
+    std::vector<SpectralGainTable::GainPoint> mGainCurve;
+    std::vector<MultibandCompressor::BandParams> mCompressorBands;
+    int32_t mMaxCompressorBands = MultibandCompressor::kMaxBands;
+    int32_t mChannelCount = 1;
+
+    // control -> audio
+    std::atomic<SpectralProcessor *> mPending{nullptr};
+    // audio -> control
+    SpscRingBuffer<SpectralProcessor *> mRetired;
+
+    // audio thread
+    SpectralProcessor *mCurrent = nullptr;
+    SpectralProcessor *mNext = nullptr;
+    SpectralProcessor *mUnretired = nullptr;   // waiting for room in mRetired
+    int32_t mFadePosition = 0;
+    bool mBypass = false;
+    bool mBypassed = false;             // fully dry, processor idle
+    int32_t mBypassPosition = 0;        // 0 = processed .. kCrossfadeFrames = dry
+    std::vector<float> mNextOutput;
+    SpectralProcessor::Flow mIdleFlow;
+};
+
+#endif //OBOEPASSTHROUGH_SPECTRALPATH_H
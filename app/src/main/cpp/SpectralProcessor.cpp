@@ -0,0 +1,336 @@
+#include "SpectralProcessor.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Interleave.h"
+
+namespace {
+
+// With all four lanes full, the x4 kernels beat four single frames up to 128 points
+// (1.1-1.3x in audio-path-bench's catch-up rows), break even at 256 and lose from 512 up,
+// where the single path's fused window and pruned inverse count for more. Scalar builds run the x4 calls as
+// four plain ones, so they never batch.
+int32_t defaultBatchMinFrames(int32_t fftSize) {
+#ifdef PASSTHROUGH_SCALAR_FFT
+    (void) fftSize;
+    return SpectralProcessor::kMaxBatchFrames + 1;
+#else
+    return fftSize <= SpectralProcessor::kMaxBatchFftSize ? SpectralProcessor::kMaxBatchFrames
+                                                         : SpectralProcessor::kMaxBatchFrames + 1;
+#endif
+}
+
+} // namespace
+
+SpectralProcessor::Config SpectralProcessor::Config::sanitized() const {
+    Config c = *this;
+    // Powers of two and the mixed-radix sizes between them (e.g. twice a 240-frame burst)
+    c.fftSize = std::min(fft_backend_next_size(std::max(c.fftSize, kMinFftSize)), kMaxFftSize);
+    c.overlap = c.overlap >= 8 ? 8 : c.overlap >= 4 ? 4 : 2;
+    if (c.window == WindowType::Blackman) {
+        c.overlap = std::max(c.overlap, 4);
+    } else if (c.window != WindowType::Hamming) {
+        c.window = WindowType::Hann;
+    }
+    return c;
+}
+
+SpectralProcessor::SpectralProcessor(const Config &config, int32_t sampleRate, int32_t channels) :
+        mConfig(config.sanitized()),
+        mFftSize(mConfig.fftSize),
+        mHopSize(mConfig.hopSize()),
+        mSampleRate(sampleRate),
+        mChannelCount(std::max(1, std::min(channels, kMaxChannels))),
+        mInputCapacity(SpscRingBuffer<float>::capacityFor(mFftSize * 2)),
+        mOutputCapacity(SpscRingBuffer<float>::capacityFor(mFftSize * 8)) {
+    mChannels.reset(new Channel[mChannelCount]);
+    mArena.build([this](DspArena &arena) { layout(arena); });
+
+    // Periodic windows, so every overlap above adds up to a constant
+    float windowSum = 0.0f;
+    for (int i = 0; i < mFftSize; ++i) {
+        float phase = 2.0f * M_PI * i / mFftSize;
+        switch (mConfig.window) {
+            case WindowType::Hamming:
+                mWindow[i] = 0.54f - 0.46f * cosf(phase);
+                break;
+            case WindowType::Blackman:
+                mWindow[i] = 0.42f - 0.5f * cosf(phase) + 0.08f * cosf(2.0f * phase);
+                break;
+            default:
+                mWindow[i] = 0.5f - 0.5f * cosf(phase);
+                break;
+        }
+        windowSum += mWindow[i];
+        mWindowSumSquares += mWindow[i] * mWindow[i];
+    }
+    // The output normalization (1/N for the inverse FFT, hop / sum(w) for the overlap) is
+    // linear, so it is folded into the analysis window instead of a pass per frame
+    mOutputScale = (float) mHopSize / (windowSum * mFftSize);
+    for (int i = 0; i < mFftSize; ++i) {
+        mWindow[i] *= mOutputScale;
+    }
+    for (int32_t c = 0; c < mChannelCount; ++c) {
+        mChannels[c].gainTable.setFftSize(mFftSize, mSampleRate);
+    }
+    configureCompressor();
+    mBatchMinFrames = defaultBatchMinFrames(mFftSize);
+    reset();
+}
+
+void SpectralProcessor::layout(DspArena &arena) {
+    // Shared by every channel
+    mWindow = arena.take<float>(mFftSize);
+    mWindowedInput = arena.take<float>(kMaxBatchFrames * mFftSize);
+    mFftOutput = arena.take<kiss_fft_cpx>(kMaxBatchFrames * (mFftSize / 2 + 1));
+    mConversionBuffer = arena.take<float>(kMaxBatchFrames * mFftSize);
+    mFftCfg = takeFftPlan(arena, mFftSize, 0);
+    mIfftCfg = takeFftPlan(arena, mFftSize, 1);
+    for (int32_t c = 0; c < mChannelCount; ++c) {
+        Channel &channel = mChannels[c];
+        channel.overlap = arena.take<float>(mFftSize - mHopSize);
+        channel.inputStorage = arena.take<float>(mInputCapacity);
+        channel.outputStorage = arena.take<float>(mOutputCapacity);
+    }
+}
+
+void SpectralProcessor::reset() {
+    for (int32_t c = 0; c < mChannelCount; ++c) {
+        Channel &channel = mChannels[c];
+        channel.inputRing.reset(channel.inputStorage, mInputCapacity);
+        channel.outputFIFO.reset(channel.outputStorage, mOutputCapacity);
+    }
+    restart();
+}
+
+void SpectralProcessor::restart() {
+    // Both rings are produced and consumed on this thread
+    for (int32_t c = 0; c < mChannelCount; ++c) {
+        Channel &channel = mChannels[c];
+        channel.inputRing.consume(channel.inputRing.availableToRead());
+        channel.outputFIFO.consume(channel.outputFIFO.availableToRead());
+        std::fill(channel.overlap, channel.overlap + (mFftSize - mHopSize), 0.0f);
+    }
+    mFlow = Flow();
+    mPrimed = false;
+    mLatencyFrames = 0;
+}
+
+void SpectralProcessor::setCompressorBands(const std::vector<MultibandCompressor::BandParams> &bands) {
+    mCompressorBands = (int32_t) std::min<size_t>(bands.size(), MultibandCompressor::kMaxBands);
+    for (int32_t c = 0; c < mChannelCount; ++c) {
+        for (int32_t b = 0; b < mCompressorBands; ++b) {
+            mChannels[c].compressor.setBand(b, bands[b]);
+        }
+    }
+    configureCompressor();
+}
+
+void SpectralProcessor::setGainCurve(const std::vector<SpectralGainTable::GainPoint> &points) {
+    for (int32_t c = 0; c < mChannelCount; ++c) {
+        mChannels[c].gainTable.setGainCurve(points);
+    }
+}
+
+void SpectralProcessor::configureCompressor() {
+    // Levels are measured on spectra of the scaled window
+    for (int32_t c = 0; c < mChannelCount; ++c) {
+        mChannels[c].compressor.configure(mCompressorBands, mFftSize, mHopSize, mSampleRate,
+                                          mWindowSumSquares * mOutputScale * mOutputScale);
+    }
+}
+
+int32_t SpectralProcessor::process(const float *input, int32_t numInput,
+                                   float *output, int32_t numOutput) {
+    // 1) Write input into the rings. On overrun drop the oldest samples; producer and
+    //    consumer are both this thread, so consuming here is safe.
+    mFlow.inputDropped = 0;
+    mFlow.outputDropped = 0;
+    writeInput(input, numInput);
+
+    // 2) Process full blocks while available, one per hop, batched when enough are pending;
+    //    channel by channel through the shared plans and workspace
+    SpscRingBuffer<float> &ring = mChannels[0].inputRing;
+    while (ring.availableToRead() >= (size_t) mFftSize) {
+        int32_t pending = 1 + (int32_t) (ring.availableToRead() - mFftSize) / mHopSize;
+        for (int32_t c = 0; c < mChannelCount; ++c) {
+            if (pending >= mBatchMinFrames) {
+                processFrames(mChannels[c], std::min(pending, kMaxBatchFrames));
+            } else {
+                processFrame(mChannels[c]);
+            }
+        }
+    }
+
+    // 3) Deliver from the FIFOs. If insufficient, zero-fill
+    int32_t toCopy = readOutput(output, numOutput);
+    if (toCopy < numOutput) {
+        std::fill(output + (size_t) toCopy * mChannelCount, output + (size_t) numOutput * mChannelCount, 0.0f);
+    }
+    mFlow.underrunFrames = mPrimed ? numOutput - toCopy : 0;
+    mLatencyFrames += numOutput - toCopy - mFlow.inputDropped - mFlow.outputDropped;
+    mPrimed = mPrimed || toCopy > 0;
+    mFlow.inputDepth = (int32_t) ring.availableToRead();
+    mFlow.outputDepth = (int32_t) mChannels[0].outputFIFO.availableToRead();
+    return toCopy;
+}
+
+void SpectralProcessor::writeInput(const float *input, int32_t numInput) {
+    if (mChannelCount == 1) {
+        SpscRingBuffer<float> &ring = mChannels[0].inputRing;
+        size_t space = ring.availableToWrite();
+        if ((size_t) numInput > space) {
+            mFlow.inputDropped = (int32_t) ring.consume(numInput - space);
+        }
+        ring.write(input, numInput);
+        return;
+    }
+
+    // The rings move in lockstep, so their free spans split at the same frame
+    size_t space = mChannels[0].inputRing.availableToWrite();
+    if ((size_t) numInput > space) {
+        for (int32_t c = 0; c < mChannelCount; ++c) {
+            mFlow.inputDropped = (int32_t) mChannels[c].inputRing.consume(numInput - space);
+        }
+    }
+    float *first[kMaxChannels];
+    float *second[kMaxChannels];
+    size_t firstSize = 0, total = 0;
+    for (int32_t c = 0; c < mChannelCount; ++c) {
+        auto spans = mChannels[c].inputRing.writeSpans(numInput);
+        first[c] = spans.first;
+        second[c] = spans.second;
+        firstSize = spans.firstSize;
+        total = spans.size();
+    }
+    Interleave::toPlanar(input, mChannelCount, (int32_t) firstSize, first);
+    Interleave::toPlanar(input + firstSize * mChannelCount, mChannelCount, (int32_t) (total - firstSize),
+                         second);
+    for (int32_t c = 0; c < mChannelCount; ++c) {
+        mChannels[c].inputRing.commitWrite(total);
+    }
+}
+
+int32_t SpectralProcessor::readOutput(float *output, int32_t numOutput) {
+    if (mChannelCount == 1) {
+        return static_cast<int32_t>(mChannels[0].outputFIFO.read(output, numOutput));
+    }
+
+    const size_t available = std::min<size_t>(numOutput, mChannels[0].outputFIFO.availableToRead());
+    const float *first[kMaxChannels];
+    const float *second[kMaxChannels];
+    size_t firstSize = 0;
+    for (int32_t c = 0; c < mChannelCount; ++c) {
+        auto spans = mChannels[c].outputFIFO.readSpans(available);
+        first[c] = spans.first;
+        second[c] = spans.second;
+        firstSize = spans.firstSize;
+    }
+    Interleave::fromPlanar(first, mChannelCount, (int32_t) firstSize, output);
+    Interleave::fromPlanar(second, mChannelCount, (int32_t) (available - firstSize),
+                           output + firstSize * mChannelCount);
+    for (int32_t c = 0; c < mChannelCount; ++c) {
+        mChannels[c].outputFIFO.consume(available);
+    }
+    return (int32_t) available;
+}
+
+void SpectralProcessor::windowFrame(Channel &channel, int32_t offset, float *dst) {
+    // copy block from ring to window buffer (at most two contiguous spans)
+    auto block = channel.inputRing.readSpans(mFftSize, offset);
+    const float *w = mWindow;
+    for (size_t n = 0; n < block.firstSize; ++n) {
+        dst[n] = block.first[n] * w[n];
+    }
+    dst += block.firstSize;
+    w += block.firstSize;
+    for (size_t n = 0; n < block.secondSize; ++n) {
+        dst[n] = block.second[n] * w[n];
+    }
+}
+
+void SpectralProcessor::processFrame(Channel &channel) {
+    // Windowed FFT straight from the ring's spans
+    auto block = channel.inputRing.readSpans(mFftSize);
+    fft_backend_fftr_windowed(mFftCfg, mFftSize, block.first, (int) block.firstSize, block.second,
+                              mWindow, mWindowedInput, mFftOutput);
+
+    SpectralGainTable::BinRange active = channel.frameChain.process(mFftOutput, mFftSize / 2 + 1);
+
+    // IFFT, skipping the bins the gain table zeroed
+    fft_backend_fftri_pruned(mIfftCfg, mFftOutput, active.begin, active.end, mConversionBuffer);
+
+    finishFrame(channel, mConversionBuffer);
+}
+
+void SpectralProcessor::processFrames(Channel &channel, int32_t count) {
+    const int32_t bins = mFftSize / 2 + 1;
+    const kiss_fft_scalar *timeIn[kMaxBatchFrames];
+    kiss_fft_cpx *freqOut[kMaxBatchFrames];
+    const kiss_fft_cpx *freqIn[kMaxBatchFrames];
+    kiss_fft_scalar *timeOut[kMaxBatchFrames];
+    for (int32_t j = 0; j < kMaxBatchFrames; ++j) {
+        // Unused lanes repeat frame 0's input and write to their own (ignored) slots
+        const int32_t source = j < count ? j : 0;
+        timeIn[j] = &mWindowedInput[source * mFftSize];
+        freqOut[j] = &mFftOutput[j * bins];
+        freqIn[j] = &mFftOutput[source * bins];
+        timeOut[j] = &mConversionBuffer[j * mFftSize];
+    }
+
+    for (int32_t j = 0; j < count; ++j) {
+        windowFrame(channel, j * mHopSize, &mWindowedInput[j * mFftSize]);
+    }
+    fft_backend_fftr_x4(mFftCfg, timeIn, freqOut);
+
+    // The compressor carries state from frame to frame, so the chains run in frame order
+    for (int32_t j = 0; j < count; ++j) {
+        channel.frameChain.process(freqOut[j], bins);
+    }
+
+    fft_backend_fftri_x4(mIfftCfg, freqIn, timeOut);
+    for (int32_t j = 0; j < count; ++j) {
+        finishFrame(channel, timeOut[j]);
+    }
+}
+
+void SpectralProcessor::finishFrame(Channel &channel, const float *timeDomain) {
+    const int32_t hop = mHopSize;
+    const int32_t tail = mFftSize - hop;
+    float *overlap = channel.overlap;
+    SpscRingBuffer<float> &fifo = channel.outputFIFO;
+
+    // If the output side has stalled, drop the oldest audio rather than letting latency
+    // grow. Every channel drops the same; the first one counts it.
+    size_t room = fifo.availableToWrite();
+    if ((size_t) hop > room) {
+        const int32_t dropped = (int32_t) fifo.consume(hop - room);
+        if (&channel == &mChannels[0]) mFlow.outputDropped += dropped;
+    }
+
+    // Overlap-add the finished hop straight into the FIFO's free spans (hop <= tail at
+    // every supported overlap)
+    auto spans = fifo.writeSpans(hop);
+    const int32_t first = (int32_t) spans.firstSize;
+    for (int32_t i = 0; i < first; ++i) {
+        spans.first[i] = timeDomain[i] + overlap[i];
+    }
+    for (int32_t i = first; i < hop; ++i) {
+        spans.second[i - first] = timeDomain[i] + overlap[i];
+    }
+    fifo.commitWrite(hop);
+
+    // Shift the overlap down by a hop while adding this frame's tail: one pass, reading
+    // ahead of where it writes
+    const int32_t carried = tail - hop;
+    for (int32_t i = 0; i < carried; ++i) {
+        overlap[i] = timeDomain[hop + i] + overlap[hop + i];
+    }
+    for (int32_t i = carried; i < tail; ++i) {
+        overlap[i] = timeDomain[hop + i];
+    }
+
+    // advance read position by hop
+    channel.inputRing.consume(hop);
+}
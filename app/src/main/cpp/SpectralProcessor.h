@@ -0,0 +1,180 @@
+#ifndef OBOEPASSTHROUGH_SPECTRALPROCESSOR_H
+#define OBOEPASSTHROUGH_SPECTRALPROCESSOR_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "DspArena.h"
+#include "fft_backend.h"
+#include "MultibandCompressor.h"
+#include "SpectralGainTable.h"
+#include "ProcessorChain.h"
+#include "SpscRingBuffer.h"
+
+/**
+ * The Spectral processing path with no Oboe dependency: input ring -> analysis window ->
+ * kiss_fftr -> spectral stages (compressor, gain table; see FrameChain) -> kiss_fftri ->
+ * overlap-add -> output FIFO.
+ * The output normalization rides on the analysis window, and the overlap-add writes
+ * into the FIFO's free spans while shifting the overlap, so after the inverse FFT each
+ * frame is a single pass. MicPassthrough drives it (through SpectralPath) from
+ * onAudioReady; host tools drive it from files.
+ *
+ * Output is in input order behind the zero-fill delivered while the first frame fills,
+ * so the latency is just under fftSize frames, depending on the callback size.
+ *
+ * When a callback leaves several hops pending (large bursts, catch-up after a stall),
+ * up to kMaxBatchFrames frames can go through the FFTs together via fft_backend_fftr_x4.
+ * By default that happens only with all four pending and at most kMaxBatchFftSize points,
+ * where it beats one frame at a time; scalar builds never batch.
+ *
+ * Several channels run through one processor on interleaved frames. Each channel gets
+ * its own rings, overlap, gain table and compressor, so left and right are processed
+ * independently. Input is deinterleaved straight into the channels' input rings and
+ * output interleaved straight out of their FIFOs (see Interleave.h). The window, both FFT
+ * plans with their twiddles, and the frame workspace exist once and are shared, since the
+ * channels run one after another on the calling thread. Cost grows linearly with the
+ * channel count and plan memory does not grow at all. All the channels' rings move in
+ * lockstep, so one Flow describes them all.
+ *
+ * The window, spectra, overlap, ring storage and both FFT plans are carved from one
+ * DspArena in the constructor; nothing on the processing path allocates.
+ */
+class SpectralProcessor {
+public:
+    enum class WindowType : int32_t {
+        Hann = 0,
+        Hamming = 1,
+        Blackman = 2,   // overlap-adds flat only at 75% overlap or more
+    };
+
+    struct Config {
+        int32_t fftSize = 1024;     // kMinFftSize..kMaxFftSize, see fft_backend_next_size
+        int32_t overlap = 2;        // frames per fftSize: 2, 4 or 8 (50, 75, 87.5%)
+        WindowType window = WindowType::Hann;
+
+        int32_t hopSize() const { return fftSize / overlap; }
+        // Clamped to what the processor supports.
+        Config sanitized() const;
+    };
+
+    static constexpr int32_t kMinFftSize = 64;
+    static constexpr int32_t kMaxFftSize = 8192;
+    static constexpr int32_t kMaxBatchFrames = 4;
+    static constexpr int32_t kMaxBatchFftSize = 128;
+    static constexpr int32_t kMaxChannels = 8;
+
+    SpectralProcessor(const Config &config, int32_t sampleRate, int32_t channels = 1);
+
+    SpectralProcessor(const SpectralProcessor &) = delete;
+    SpectralProcessor &operator=(const SpectralProcessor &) = delete;
+
+    // Empties the rings and clears all signal history. Real-time safe, but only while
+    // nothing else is using the processor.
+    void reset();
+    // Real-time safe: clears the signal history in place, output primes again from zero.
+    void restart();
+
+    // WDRC, one entry per band (up to 16), on every channel; empty disables it.
+    void setCompressorBands(const std::vector<MultibandCompressor::BandParams> &bands);
+    // The same prescription on every channel; getGainTable(c) sets one channel's.
+    void setGainCurve(const std::vector<SpectralGainTable::GainPoint> &points);
+
+    /**
+     * Push numInput frames, pull numOutput frames, interleaved across getChannelCount()
+     * channels. The two counts may differ (e.g. after a short read); output the pipeline
+     * can't supply yet is zero-filled.
+     * Returns the number of frames that came from the pipeline rather than zero-fill.
+     */
+    int32_t process(const float *input, int32_t numInput, float *output, int32_t numOutput);
+
+    // What the last process() call did to the rings, for the callback instrumentation.
+    struct Flow {
+        int32_t inputDropped = 0;       // oldest input frames dropped on a full ring
+        int32_t outputDropped = 0;      // oldest output frames dropped on a full FIFO
+        int32_t underrunFrames = 0;     // zero-filled output after the first frame was out
+        int32_t inputDepth = 0;         // frames left in each ring afterwards
+        int32_t outputDepth = 0;
+    };
+    const Flow &getLastFlow() const { return mFlow; }
+    // Output delay when every call pushes and pulls the same count: the zero-fill delivered
+    // so far less the frames dropped on overruns. 0 until the first frame is out.
+    int32_t getLatencyFrames() const { return mPrimed ? mLatencyFrames : 0; }
+
+    SpectralGainTable &getGainTable(int32_t channel = 0) { return mChannels[channel].gainTable; }
+    MultibandCompressor &getCompressor(int32_t channel = 0) { return mChannels[channel].compressor; }
+    const Config &getConfig() const { return mConfig; }
+    int32_t getChannelCount() const { return mChannelCount; }
+    int32_t getFftSize() const { return mFftSize; }
+    int32_t getHopSize() const { return mHopSize; }
+    int32_t getSampleRate() const { return mSampleRate; }
+
+    // Fewest pending frames that go through the batched FFTs (above kMaxBatchFrames:
+    // never). The default depends only on the FFT size (see above); override before processing.
+    int32_t getBatchMinFrames() const { return mBatchMinFrames; }
+    void setBatchMinFrames(int32_t frames) { mBatchMinFrames = frames; }
+
+private:
+    // The per-frame spectral stages, composed in FrameChain
+    struct CompressorStage {
+        MultibandCompressor *compressor;
+        void process(kiss_fft_cpx *spectrum, SpectralGainTable::BinRange &) {
+            compressor->process(spectrum);
+        }
+    };
+    struct GainTableStage {
+        SpectralGainTable *table;
+        void process(kiss_fft_cpx *spectrum, SpectralGainTable::BinRange &active) {
+            active = chain::intersect(active, table->apply(spectrum));
+        }
+    };
+    // Level-dependent gain, then the 125-18000 Hz band times the prescription curve
+    using FrameChain = chain::SpectralChain<CompressorStage, GainTableStage>;
+
+    // What each channel has of its own; everything else is shared
+    struct Channel {
+        float *inputStorage = nullptr;
+        float *outputStorage = nullptr;
+        float *overlap = nullptr;       // fftSize - hop frames still to be added to
+        SpscRingBuffer<float> inputRing;
+        SpscRingBuffer<float> outputFIFO;
+        SpectralGainTable gainTable;
+        MultibandCompressor compressor;
+        FrameChain frameChain{CompressorStage{&compressor}, GainTableStage{&gainTable}};
+    };
+
+    void layout(DspArena &arena);
+    void writeInput(const float *input, int32_t numInput);
+    int32_t readOutput(float *output, int32_t numOutput);
+    void processFrame(Channel &channel);
+    void processFrames(Channel &channel, int32_t count);
+    void windowFrame(Channel &channel, int32_t offset, float *dst);
+    void finishFrame(Channel &channel, const float *timeDomain);
+    void configureCompressor();
+
+    const Config mConfig;
+    const int32_t mFftSize;
+    const int32_t mHopSize;
+    const int32_t mSampleRate;
+    const int32_t mChannelCount;
+    const size_t mInputCapacity;
+    const size_t mOutputCapacity;
+    DspArena mArena;                    // backs the buffers, plans and ring storage below
+    float *mWindow = nullptr;           // analysis window times mOutputScale
+    float mWindowSumSquares = 0.0f;
+    float mOutputScale = 0.0f;          // 1/N for the inverse FFT times hop / sum(window)
+    float *mWindowedInput = nullptr;            // kMaxBatchFrames frames of each
+    kiss_fft_cpx *mFftOutput = nullptr;
+    float *mConversionBuffer = nullptr;
+    int32_t mBatchMinFrames = kMaxBatchFrames + 1;
+    fft_backend_cfg mFftCfg = nullptr;
+    fft_backend_cfg mIfftCfg = nullptr;
+    std::unique_ptr<Channel[]> mChannels;
+    int32_t mCompressorBands = 0;
+    Flow mFlow;
+    bool mPrimed = false;
+    int32_t mLatencyFrames = 0;
+};
+
+#endif //OBOEPASSTHROUGH_SPECTRALPROCESSOR_H
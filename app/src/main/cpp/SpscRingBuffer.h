@@ -0,0 +1,171 @@
+#ifndef OBOEPASSTHROUGH_SPSCRINGBUFFER_H
+#define OBOEPASSTHROUGH_SPSCRINGBUFFER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Single-producer / single-consumer ring buffer with power-of-two capacity.
+ *
+ * Read and write positions are free-running counters, so "full" and "empty" never
+ * need a spare slot and the wrap is a mask instead of a modulo. The producer only
+ * stores mWriteIndex and the consumer only stores mReadIndex; each side loads the
+ * other's index with acquire so the data it copies is visible.
+ *
+ * Every region is exposed as at most two contiguous spans (up to the end of storage,
+ * then from the start), so callers can memcpy or run tight loops with no wrap check.
+ *
+ * Only reset(minCapacity) allocates. Storage can also come from the caller (e.g. a
+ * DspArena) through reset(storage, capacity). Everything else is real-time safe.
+ */
+template <typename T>
+class SpscRingBuffer {
+    static_assert(std::is_trivially_copyable<T>::value, "ring elements are memcpy'd");
+
+public:
+    struct Spans {
+        T *first = nullptr;
+        size_t firstSize = 0;
+        T *second = nullptr;
+        size_t secondSize = 0;
+
+        size_t size() const { return firstSize + secondSize; }
+    };
+
+    struct ConstSpans {
+        const T *first = nullptr;
+        size_t firstSize = 0;
+        const T *second = nullptr;
+        size_t secondSize = 0;
+
+        size_t size() const { return firstSize + secondSize; }
+    };
+
+    SpscRingBuffer() = default;
+    explicit SpscRingBuffer(size_t minCapacity) { reset(minCapacity); }
+
+    SpscRingBuffer(const SpscRingBuffer &) = delete;
+    SpscRingBuffer &operator=(const SpscRingBuffer &) = delete;
+
+    // Not real-time safe: (re)allocates storage rounded up to a power of two and empties the ring.
+    void reset(size_t minCapacity) {
+        size_t capacity = capacityFor(minCapacity);
+        mOwned.assign(capacity, T{});
+        reset(mOwned.data(), capacity);
+    }
+
+    // Real-time safe: runs on capacity elements the caller owns (a power of two, see
+    // capacityFor()) and empties the ring. The storage must outlive the ring's use of it.
+    void reset(T *storage, size_t capacity) {
+        mStorage = storage;
+        mCapacity = capacity;
+        mMask = capacity - 1;
+        mWriteIndex.store(0, std::memory_order_relaxed);
+        mReadIndex.store(0, std::memory_order_relaxed);
+    }
+
+    // Power-of-two capacity reset(minCapacity) would allocate.
+    static size_t capacityFor(size_t minCapacity) {
+        size_t capacity = 1;
+        while (capacity < minCapacity) capacity <<= 1;
+        return capacity;
+    }
+
+    size_t capacity() const { return mCapacity; }
+
+    // Consumer side
+    size_t availableToRead() const {
+        return mWriteIndex.load(std::memory_order_acquire) -
+               mReadIndex.load(std::memory_order_relaxed);
+    }
+
+    // Producer side
+    size_t availableToWrite() const {
+        return capacity() - (mWriteIndex.load(std::memory_order_relaxed) -
+                             mReadIndex.load(std::memory_order_acquire));
+    }
+
+    // ---- producer ----
+
+    // Free space starting at the write position, clamped to n.
+    Spans writeSpans(size_t n) {
+        n = std::min(n, availableToWrite());
+        return makeSpans(mWriteIndex.load(std::memory_order_relaxed), n);
+    }
+
+    // Publish n elements previously filled through writeSpans().
+    void commitWrite(size_t n) {
+        mWriteIndex.store(mWriteIndex.load(std::memory_order_relaxed) + n,
+                          std::memory_order_release);
+    }
+
+    // Returns the number of elements actually written (less than n when full).
+    size_t write(const T *src, size_t n) {
+        Spans s = writeSpans(n);
+        copy(s.first, src, s.firstSize);
+        copy(s.second, src + s.firstSize, s.secondSize);
+        commitWrite(s.size());
+        return s.size();
+    }
+
+    // ---- consumer ----
+
+    // Readable data starting offset elements past the read position, clamped to n.
+    ConstSpans readSpans(size_t n, size_t offset = 0) const {
+        size_t available = availableToRead();
+        if (offset >= available) return {};
+        n = std::min(n, available - offset);
+        Spans s = const_cast<SpscRingBuffer *>(this)->makeSpans(
+                mReadIndex.load(std::memory_order_relaxed) + offset, n);
+        return {s.first, s.firstSize, s.second, s.secondSize};
+    }
+
+    // Drop n elements (clamped to what is available).
+    size_t consume(size_t n) {
+        n = std::min(n, availableToRead());
+        mReadIndex.store(mReadIndex.load(std::memory_order_relaxed) + n,
+                         std::memory_order_release);
+        return n;
+    }
+
+    // Copy without consuming.
+    size_t peek(T *dst, size_t n, size_t offset = 0) const {
+        ConstSpans s = readSpans(n, offset);
+        copy(dst, s.first, s.firstSize);
+        copy(dst + s.firstSize, s.second, s.secondSize);
+        return s.size();
+    }
+
+    // Returns the number of elements actually read (less than n when empty).
+    size_t read(T *dst, size_t n) {
+        return consume(peek(dst, n));
+    }
+
+private:
+    // An empty span may be null, which memcpy doesn't accept even for zero bytes
+    static void copy(T *dst, const T *src, size_t n) {
+        if (n > 0) std::memcpy(dst, src, n * sizeof(T));
+    }
+
+    Spans makeSpans(size_t index, size_t n) {
+        size_t start = index & mMask;
+        size_t first = std::min(n, capacity() - start);
+        T *base = mStorage;
+        return {base + start, first, base, n - first};
+    }
+
+    static constexpr size_t kCacheLine = 64;
+
+    std::vector<T> mOwned;      // storage from reset(minCapacity)
+    T *mStorage = nullptr;
+    size_t mCapacity = 0;
+    size_t mMask = 0;
+    alignas(kCacheLine) std::atomic<size_t> mWriteIndex{0};
+    alignas(kCacheLine) std::atomic<size_t> mReadIndex{0};
+};
+
+#endif //OBOEPASSTHROUGH_SPSCRINGBUFFER_H
@@ -0,0 +1,49 @@
+#ifndef OBOEPASSTHROUGH_TRIPLEBUFFER_H
+#define OBOEPASSTHROUGH_TRIPLEBUFFER_H
+
+#include <atomic>
+
+/**
+ * Lock-free triple buffer: one writer thread publishes whole values, one reader thread
+ * always sees the most recently published one. Neither side ever waits or allocates;
+ * the writer owns the back slot, the reader the front slot, and they trade through the
+ * middle slot with a single atomic exchange.
+ *
+ * The writer's slot holds whatever was published two swaps ago, so it must be fully
+ * rewritten before publish().
+ */
+template <typename T>
+class TripleBuffer {
+public:
+    // ---- writer ----
+    T &writeBuffer() { return mSlots[mBack]; }
+
+    void publish() {
+        int previous = mMiddle.exchange(mBack | kFresh, std::memory_order_acq_rel);
+        mBack = previous & kIndexMask;
+    }
+
+    // ---- reader ----
+    // Picks up the latest published value, if any, and returns the reader's slot.
+    const T &read() {
+        if (mMiddle.load(std::memory_order_relaxed) & kFresh) {
+            int previous = mMiddle.exchange(mFront, std::memory_order_acq_rel);
+            mFront = previous & kIndexMask;
+        }
+        return mSlots[mFront];
+    }
+
+    // Reader's current value without checking for a newer one.
+    const T &current() const { return mSlots[mFront]; }
+
+private:
+    static constexpr int kIndexMask = 3;
+    static constexpr int kFresh = 4;
+
+    T mSlots[3];
+    int mBack = 0;                      // writer only
+    std::atomic<int> mMiddle{1};
+    int mFront = 2;                     // reader only
+};
+
+#endif //OBOEPASSTHROUGH_TRIPLEBUFFER_H
@@ -0,0 +1,47 @@
+#ifndef OBOEPASSTHROUGH_BENCHUTIL_H
+#define OBOEPASSTHROUGH_BENCHUTIL_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+namespace bench {
+
+// Keeps the optimizer from discarding a result.
+template <typename T>
+inline void doNotOptimize(const T &value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/**
+ * Runs fn() in batches until minSeconds have elapsed and returns the best (lowest)
+ * per-call time in nanoseconds across the batches. Best-of is used rather than mean
+ * because scheduler noise only ever adds time.
+ */
+template <typename Fn>
+double measureNs(Fn &&fn, int callsPerBatch = 256, double minSeconds = 0.2) {
+    using Clock = std::chrono::steady_clock;
+    for (int i = 0; i < callsPerBatch; ++i) fn();  // warm caches and branch predictors
+
+    double best = 1e30;
+    auto deadline = Clock::now() + std::chrono::duration<double>(minSeconds);
+    do {
+        auto t0 = Clock::now();
+        for (int i = 0; i < callsPerBatch; ++i) fn();
+        auto t1 = Clock::now();
+        double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / callsPerBatch;
+        best = std::min(best, ns);
+    } while (Clock::now() < deadline);
+    return best;
+}
+
+// Fraction of the real-time budget used by one callback of `frames` at `sampleRate`.
+inline double budgetFraction(double nsPerCallback, int frames, int sampleRate) {
+    double budgetNs = 1e9 * frames / sampleRate;
+    return nsPerCallback / budgetNs;
+}
+
+} // namespace bench
+
+#endif //OBOEPASSTHROUGH_BENCHUTIL_H
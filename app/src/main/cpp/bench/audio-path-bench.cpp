@@ -0,0 +1,398 @@
+// Per-stage cost of the Spectral callback path and the full callback at common burst
+// sizes, in ns per audio frame and as a fraction of the real-time budget at 48 kHz.
+//
+// Stages are timed per FFT frame and charged to the hop of audio that triggers them,
+// so the stage rows add up (roughly) to the full-callback mean.
+//
+// The last table puts the Iir mode (biquad cascade) next to the Spectral callback, with
+// the delay from an input impulse to the output's peak as the latency each adds. The one
+// after it runs the same callback through FixedSpectralProcessor on int16, and the last
+// runs it on 1, 2 and 4 interleaved channels sharing one pair of FFT plans.
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "BenchUtil.h"
+#include "BiquadCascade.h"
+#include "fft_backend.h"
+#include "FixedSpectralProcessor.h"
+#include "kiss_fftr.h"
+#include "MultibandCompressor.h"
+#include "SpectralGainTable.h"
+#include "SpectralProcessor.h"
+#include "SpscRingBuffer.h"
+
+namespace {
+
+constexpr int kSampleRate = 48000;
+constexpr int kFftSize = 1024;
+
+void printRow(const char *name, double nsPerCall, int framesPerCall) {
+    printf("%-26s %12.1f %12.2f %11.3f%%\n", name, nsPerCall, nsPerCall / framesPerCall,
+           100.0 * bench::budgetFraction(nsPerCall, framesPerCall, kSampleRate));
+}
+
+void printLatencyRow(const char *name, double nsPerCall, int framesPerCall, int latencyFrames) {
+    printf("%-26s %12.1f %12.2f %11.3f%% %9d\n", name, nsPerCall, nsPerCall / framesPerCall,
+           100.0 * bench::budgetFraction(nsPerCall, framesPerCall, kSampleRate), latencyFrames);
+}
+
+void benchFftSizes() {
+    printf("\nreal FFT forward + inverse (charged to a 50%% hop of nfft / 2 frames)\n");
+    printf("%-26s %12s %12s %12s\n", "stage", "ns/call", "ns/frame", "budget");
+    for (int nfft = 64; nfft <= 4096; nfft *= 2) {
+        std::vector<float> x(nfft), y(nfft);
+        std::vector<kiss_fft_cpx> spectrum(nfft / 2 + 1);
+        for (int i = 0; i < nfft; ++i) x[i] = sinf(0.1f * i);
+
+        kiss_fftr_cfg kissFwd = kiss_fftr_alloc(nfft, 0, nullptr, nullptr);
+        kiss_fftr_cfg kissInv = kiss_fftr_alloc(nfft, 1, nullptr, nullptr);
+        double kissNs = bench::measureNs([&] {
+            kiss_fftr(kissFwd, x.data(), spectrum.data());
+            kiss_fftri(kissInv, spectrum.data(), y.data());
+            bench::doNotOptimize(y[0]);
+        });
+        kiss_fftr_free(kissFwd);
+        kiss_fftr_free(kissInv);
+
+        fft_backend_cfg fwd = fft_backend_alloc(nfft, 0, nullptr, nullptr);
+        fft_backend_cfg inv = fft_backend_alloc(nfft, 1, nullptr, nullptr);
+        double backendNs = bench::measureNs([&] {
+            fft_backend_fftr(fwd, x.data(), spectrum.data());
+            fft_backend_fftri(inv, spectrum.data(), y.data());
+            bench::doNotOptimize(y[0]);
+        });
+        fft_backend_free(fwd);
+        fft_backend_free(inv);
+
+        char name[32];
+        snprintf(name, sizeof(name), "kiss_fftr %d", nfft);
+        printRow(name, kissNs, nfft / 2);
+        snprintf(name, sizeof(name), "backend %d", nfft);
+        printRow(name, backendNs, nfft / 2);
+    }
+}
+
+void benchStages() {
+    const int hop = kFftSize / 2;
+    std::vector<float> window(kFftSize), input(kFftSize), windowed(kFftSize);
+    std::vector<float> timeDomain(kFftSize), overlap(hop, 0.0f);
+    std::vector<kiss_fft_cpx> spectrum(kFftSize / 2 + 1);
+    float windowSum = 0.0f;
+    float windowSumSquares = 0.0f;
+    for (int i = 0; i < kFftSize; ++i) {
+        window[i] = 0.5f - 0.5f * cosf(2.0f * M_PI * i / kFftSize);
+        windowSum += window[i];
+        windowSumSquares += window[i] * window[i];
+        input[i] = 0.1f * sinf(0.05f * i);
+    }
+
+    const float outputScale = hop / (windowSum * kFftSize);
+
+    printf("\nspectral stages, nfft %d, hop %d\n", kFftSize, hop);
+    printf("%-26s %12s %12s %12s\n", "stage", "ns/call", "ns/frame", "budget");
+
+    // Same loops as SpectralProcessor::processFrame
+    printRow("hann window", bench::measureNs([&] {
+        for (int n = 0; n < kFftSize; ++n) windowed[n] = input[n] * window[n];
+        bench::doNotOptimize(windowed[0]);
+    }), hop);
+
+    fft_backend_cfg fwd = fft_backend_alloc(kFftSize, 0, nullptr, nullptr);
+    fft_backend_cfg inv = fft_backend_alloc(kFftSize, 1, nullptr, nullptr);
+    printRow("fftr", bench::measureNs([&] {
+        fft_backend_fftr(fwd, windowed.data(), spectrum.data());
+        bench::doNotOptimize(spectrum[0]);
+    }), hop);
+
+    printRow("fftr windowed (fused)", bench::measureNs([&] {
+        fft_backend_fftr_windowed(fwd, kFftSize, input.data(), kFftSize / 3, input.data() + kFftSize / 3,
+                                  window.data(), windowed.data(), spectrum.data());
+        bench::doNotOptimize(spectrum[0]);
+    }), hop);
+
+    MultibandCompressor compressor;
+    MultibandCompressor::BandParams band;
+    band.ratio = 3.0f;
+    compressor.setAllBands(band);
+    compressor.configure(8, kFftSize, hop, kSampleRate, windowSumSquares);
+    printRow("wdrc (8 bands)", bench::measureNs([&] {
+        compressor.process(spectrum.data());
+        bench::doNotOptimize(spectrum[0]);
+    }), hop);
+
+    SpectralGainTable gains;
+    gains.setFftSize(kFftSize, kSampleRate);
+    gains.setGainCurve({{250.0f, 10.0f}, {1000.0f, 20.0f}, {4000.0f, 30.0f}});
+    printRow("bin gain", bench::measureNs([&] {
+        gains.apply(spectrum.data());
+        bench::doNotOptimize(spectrum[0]);
+    }), hop);
+
+    printRow("fftri", bench::measureNs([&] {
+        fft_backend_fftri(inv, spectrum.data(), timeDomain.data());
+        bench::doNotOptimize(timeDomain[0]);
+    }), hop);
+
+    // The separate passes the frame loop used to make, and the fused pass that replaced
+    // them (normalization folded into the window, overlap-add into the FIFO's spans)
+    SpscRingBuffer<float> fifo(kFftSize * 8);
+    printRow("normalize+OLA+FIFO (old)", bench::measureNs([&] {
+        for (int i = 0; i < kFftSize; ++i) timeDomain[i] *= outputScale;
+        for (int i = 0; i < hop; ++i) timeDomain[i] += overlap[i];
+        fifo.write(timeDomain.data(), hop);
+        std::copy(timeDomain.begin() + hop, timeDomain.end(), overlap.begin());
+        fifo.consume(hop);
+        bench::doNotOptimize(overlap[0]);
+    }), hop);
+    printRow("fused OLA into FIFO", bench::measureNs([&] {
+        auto spans = fifo.writeSpans(hop);
+        const int first = (int) spans.firstSize;
+        for (int i = 0; i < first; ++i) spans.first[i] = timeDomain[i] + overlap[i];
+        for (int i = first; i < hop; ++i) spans.second[i - first] = timeDomain[i] + overlap[i];
+        fifo.commitWrite(hop);
+        for (int i = 0; i < kFftSize - hop; ++i) overlap[i] = timeDomain[hop + i];
+        fifo.consume(hop);
+        bench::doNotOptimize(overlap[0]);
+    }), hop);
+
+    fft_backend_free(fwd);
+    fft_backend_free(inv);
+}
+
+// Bin gain + inverse FFT against the active band: every bin multiplied and a full
+// inverse, vs. the ranged gain and the pruned inverse the frame loop now runs.
+void benchBandwidth() {
+    printf("\nbin gain + fftri vs. active band, nfft %d (ns per FFT frame)\n", kFftSize);
+    printf("%-26s %6s %12s %12s %9s\n", "band", "bins", "full", "pruned", "saving");
+    const int bins = kFftSize / 2 + 1;
+    fft_backend_cfg inv = fft_backend_alloc(kFftSize, 1, nullptr, nullptr);
+    std::vector<kiss_fft_cpx> spectrum(bins), source(bins);
+    std::vector<float> timeDomain(kFftSize), perBin(2 * bins);
+    for (int k = 0; k < bins; ++k) source[k] = {sinf(0.3f * k), cosf(0.7f * k)};
+
+    const float bands[][2] = {{0.0f, 24000.0f}, {125.0f, 18000.0f}, {300.0f, 8000.0f},
+                              {300.0f, 4000.0f}, {300.0f, 2000.0f}, {300.0f, 1000.0f}};
+    for (const auto &band : bands) {
+        SpectralGainTable gains;
+        gains.setFftSize(kFftSize, kSampleRate);
+        gains.setBandLimits(band[0], band[1]);
+        // the table's per-bin gains, read back through a spectrum of ones
+        std::fill(spectrum.begin(), spectrum.end(), kiss_fft_cpx{1.0f, 1.0f});
+        SpectralGainTable::BinRange active = gains.apply(spectrum.data());
+        std::copy((float *) spectrum.data(), (float *) spectrum.data() + 2 * bins, perBin.begin());
+
+        double full = bench::measureNs([&] {
+            std::copy(source.begin(), source.end(), spectrum.begin());
+            float *s = (float *) spectrum.data();
+            for (int i = 0; i < 2 * bins; ++i) s[i] *= perBin[i];
+            fft_backend_fftri(inv, spectrum.data(), timeDomain.data());
+            bench::doNotOptimize(timeDomain[0]);
+        });
+        double pruned = bench::measureNs([&] {
+            std::copy(source.begin(), source.end(), spectrum.begin());
+            SpectralGainTable::BinRange range = gains.apply(spectrum.data());
+            fft_backend_fftri_pruned(inv, spectrum.data(), range.begin, range.end, timeDomain.data());
+            bench::doNotOptimize(timeDomain[0]);
+        });
+        char name[32];
+        snprintf(name, sizeof(name), "%.0f-%.0f Hz", band[0], band[1]);
+        printf("%-26s %6d %12.1f %12.1f %8.1f%%\n", name, active.end - active.begin, full, pruned,
+               100.0 * (1.0 - pruned / full));
+    }
+    fft_backend_free(inv);
+}
+
+void benchCallbacks() {
+    printf("\nfull spectral callback, nfft %d (mean over whole hops)\n", kFftSize);
+    printf("%-26s %12s %12s %12s\n", "burst", "ns/call", "ns/frame", "budget");
+    for (int burst : {48, 96, 192, 256}) {
+        SpectralProcessor::Config config;
+        config.fftSize = kFftSize;
+        SpectralProcessor processor(config, kSampleRate);
+        MultibandCompressor::BandParams band;
+        band.ratio = 3.0f;
+        processor.setCompressorBands(std::vector<MultibandCompressor::BandParams>(8, band));
+        std::vector<float> in(burst), out(burst);
+        for (int i = 0; i < burst; ++i) in[i] = 0.1f * sinf(0.05f * i);
+
+        // A batch spans many hops so frame-triggering and pass-through callbacks average out
+        double ns = bench::measureNs([&] {
+            processor.process(in.data(), burst, out.data(), burst);
+            bench::doNotOptimize(out[0]);
+        }, 64 * kFftSize / burst);
+
+        char name[32];
+        snprintf(name, sizeof(name), "%d frames", burst);
+        printRow(name, ns, burst);
+    }
+}
+
+// A callback that arrives with four hops pending (75% overlap, burst of four hops):
+// one frame at a time vs. the batched FFTs, with the processor's own choice per size.
+void benchCatchUp() {
+    printf("\ncatch-up, 4 hops per callback\n");
+    printf("%-6s %16s %16s %10s %10s\n", "nfft", "frames ns/call", "batched ns/call", "gain",
+           "default");
+    for (int nfft = SpectralProcessor::kMinFftSize; nfft <= 2048; nfft *= 2) {
+        SpectralProcessor::Config config;
+        config.fftSize = nfft;
+        config.overlap = 4;
+        const int burst = 4 * config.hopSize();
+        std::vector<float> in(burst), out(burst);
+        for (int i = 0; i < burst; ++i) in[i] = 0.1f * sinf(0.05f * i);
+        double ns[2];
+        int chosen = 0;
+        for (int batched = 0; batched < 2; ++batched) {
+            SpectralProcessor processor(config, kSampleRate);
+            chosen = processor.getBatchMinFrames();
+            processor.setBatchMinFrames(batched ? SpectralProcessor::kMaxBatchFrames
+                                                : SpectralProcessor::kMaxBatchFrames + 1);
+            ns[batched] = bench::measureNs([&] {
+                processor.process(in.data(), burst, out.data(), burst);
+                bench::doNotOptimize(out[0]);
+            });
+        }
+        printf("%-6d %16.1f %16.1f %9.2fx %10s\n", nfft, ns[0], ns[1], ns[0] / ns[1],
+               chosen <= SpectralProcessor::kMaxBatchFrames ? "batched" : "frames");
+    }
+}
+
+// Frames from an input impulse to the largest output sample, fed one burst at a time.
+template <typename Process>
+int impulsePeakDelay(int burst, Process &&process) {
+    const int total = 4 * kFftSize + 4096;
+    std::vector<float> in(total, 0.0f), out(total, 0.0f);
+    const int at = 2 * kFftSize;    // after any priming
+    in[at] = 1.0f;
+    for (int i = 0; i + burst <= total; i += burst) process(&in[i], &out[i], burst);
+    int peak = at;
+    for (int i = at; i < total; ++i) {
+        if (std::fabs(out[i]) > std::fabs(out[peak])) peak = i;
+    }
+    return peak - at;
+}
+
+void benchIirVsSpectral() {
+    printf("\niir (8 biquads) vs spectral (nfft %d) callback\n", kFftSize);
+    printf("%-26s %12s %12s %12s %9s\n", "burst", "ns/call", "ns/frame", "budget", "latency");
+
+    std::vector<BiquadCascade::Section> sections = BiquadCascade::bandLimit(125.0f, 18000.0f);
+    for (float hz : {500.0f, 1000.0f, 2000.0f, 4000.0f}) {
+        sections.push_back({BiquadCascade::SectionType::Peaking, hz, 1.0f, 6.0f});
+    }
+
+    for (int burst : {48, 96, 192, 256}) {
+        std::vector<float> in(burst), out(burst);
+        for (int i = 0; i < burst; ++i) in[i] = 0.1f * sinf(0.05f * i);
+        char name[32];
+
+        BiquadCascade iir;
+        iir.configure(kSampleRate);
+        iir.setSections(sections);
+        double iirNs = bench::measureNs([&] {
+            iir.process(in.data(), out.data(), burst);
+            bench::doNotOptimize(out[0]);
+        }, 1024);
+        iir.reset();
+        int iirDelay = impulsePeakDelay(burst, [&](const float *x, float *y, int n) {
+            iir.process(x, y, n);
+        });
+        snprintf(name, sizeof(name), "iir %d frames", burst);
+        printLatencyRow(name, iirNs, burst, iirDelay);
+
+        SpectralProcessor::Config config;
+        config.fftSize = kFftSize;
+        SpectralProcessor spectral(config, kSampleRate);
+        double spectralNs = bench::measureNs([&] {
+            spectral.process(in.data(), burst, out.data(), burst);
+            bench::doNotOptimize(out[0]);
+        }, 64 * kFftSize / burst);
+        SpectralProcessor fresh(config, kSampleRate);
+        int spectralDelay = impulsePeakDelay(burst, [&](const float *x, float *y, int n) {
+            fresh.process(x, n, y, n);
+        });
+        snprintf(name, sizeof(name), "spectral %d frames", burst);
+        printLatencyRow(name, spectralNs, burst, spectralDelay);
+    }
+}
+
+// Gain table only, no compressor, on both paths: what FixedSpectralProcessor does
+void benchFixedVsFloat() {
+    const int burst = 192;
+    printf("\nfixed (int16, Q31 fft) vs float spectral callback, %d frames\n", burst);
+    printf("%-26s %12s %12s %12s\n", "path", "ns/call", "ns/frame", "budget");
+    std::vector<float> in(burst), out(burst);
+    std::vector<int16_t> in16(burst), out16(burst);
+    for (int i = 0; i < burst; ++i) {
+        in[i] = 0.1f * sinf(0.05f * i);
+        in16[i] = (int16_t) lrintf(in[i] * 32767.0f);
+    }
+    for (int nfft : {256, 512, 1024, 2048}) {
+        SpectralProcessor::Config config;
+        config.fftSize = nfft;
+        char name[32];
+
+        SpectralProcessor spectral(config, kSampleRate);
+        double floatNs = bench::measureNs([&] {
+            spectral.process(in.data(), burst, out.data(), burst);
+            bench::doNotOptimize(out[0]);
+        }, 64 * nfft / burst);
+        snprintf(name, sizeof(name), "float nfft %d", nfft);
+        printRow(name, floatNs, burst);
+
+        FixedSpectralProcessor fixed(config, kSampleRate);
+        double fixedNs = bench::measureNs([&] {
+            fixed.process(in16.data(), burst, out16.data(), burst);
+            bench::doNotOptimize(out16[0]);
+        }, 64 * nfft / burst);
+        snprintf(name, sizeof(name), "fixed nfft %d", nfft);
+        printRow(name, fixedNs, burst);
+    }
+}
+
+// Interleaved callbacks through one processor; the budget is for the frames, the last
+// column the cost per channel relative to mono.
+void benchChannels() {
+    const int burst = 192;
+    printf("\nspectral callback per channel count, nfft %d, %d frames\n", kFftSize, burst);
+    printf("%-26s %12s %12s %12s %9s\n", "channels", "ns/call", "ns/frame", "budget", "x mono/ch");
+    double monoNs = 0.0;
+    for (int channels : {1, 2, 4}) {
+        SpectralProcessor::Config config;
+        config.fftSize = kFftSize;
+        SpectralProcessor processor(config, kSampleRate, channels);
+        MultibandCompressor::BandParams band;
+        band.ratio = 3.0f;
+        processor.setCompressorBands(std::vector<MultibandCompressor::BandParams>(8, band));
+        std::vector<float> in(burst * channels), out(burst * channels);
+        for (int i = 0; i < burst * channels; ++i) in[i] = 0.1f * sinf(0.05f * i);
+
+        double ns = bench::measureNs([&] {
+            processor.process(in.data(), burst, out.data(), burst);
+            bench::doNotOptimize(out[0]);
+        }, 64 * kFftSize / burst);
+        if (channels == 1) monoNs = ns;
+
+        char name[32];
+        snprintf(name, sizeof(name), "%d ch", channels);
+        printf("%-26s %12.1f %12.2f %11.3f%% %9.2f\n", name, ns, ns / burst,
+               100.0 * bench::budgetFraction(ns, burst, kSampleRate), ns / (channels * monoNs));
+    }
+}
+
+} // namespace
+
+int main() {
+    printf("budget = share of the %d Hz real-time budget for the same frames\n", kSampleRate);
+    benchFftSizes();
+    benchStages();
+    benchBandwidth();
+    benchCallbacks();
+    benchCatchUp();
+    benchIirVsSpectral();
+    benchFixedVsFloat();
+    benchChannels();
+    return 0;
+}
@@ -0,0 +1,91 @@
+// Forward + inverse real FFT cost: scalar kiss_fftr vs. the kiss_fftr_simd backend, and
+// per transform when four frames go through kiss_fftr_simd_x4 together. A second table
+// puts the mixed-radix sizes (twice a device burst) against the powers of two around
+// them, per sample.
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "BenchUtil.h"
+#include "kiss_fftr.h"
+#include "kiss_fftr_simd.h"
+
+namespace {
+
+template <typename Cfg, typename Alloc, typename Fwd, typename Inv>
+double roundTripNs(int nfft, Alloc alloc, Fwd fwd, Inv inv) {
+    Cfg fwdCfg = alloc(nfft, 0, nullptr, nullptr);
+    Cfg invCfg = alloc(nfft, 1, nullptr, nullptr);
+    std::vector<float> x(nfft), y(nfft);
+    std::vector<kiss_fft_cpx> spectrum(nfft / 2 + 1);
+    for (int i = 0; i < nfft; ++i) x[i] = sinf(0.1f * i);
+    double ns = bench::measureNs([&] {
+        fwd(fwdCfg, x.data(), spectrum.data());
+        inv(invCfg, spectrum.data(), y.data());
+        bench::doNotOptimize(y[0]);
+    });
+    free(fwdCfg);
+    free(invCfg);
+    return ns;
+}
+
+double batchRoundTripNs(int nfft) {
+    kiss_fftr_simd_cfg fwd = kiss_fftr_simd_alloc(nfft, 0, nullptr, nullptr);
+    kiss_fftr_simd_cfg inv = kiss_fftr_simd_alloc(nfft, 1, nullptr, nullptr);
+    std::vector<float> x(4 * nfft), y(4 * nfft);
+    std::vector<kiss_fft_cpx> spectrum(4 * (nfft / 2 + 1));
+    for (int i = 0; i < 4 * nfft; ++i) x[i] = sinf(0.1f * i);
+    const kiss_fft_scalar *timeIn[4];
+    kiss_fft_scalar *timeOut[4];
+    kiss_fft_cpx *freqOut[4];
+    const kiss_fft_cpx *freqIn[4];
+    for (int l = 0; l < 4; ++l) {
+        timeIn[l] = &x[l * nfft];
+        timeOut[l] = &y[l * nfft];
+        freqOut[l] = &spectrum[l * (nfft / 2 + 1)];
+        freqIn[l] = freqOut[l];
+    }
+    double ns = bench::measureNs([&] {
+        kiss_fftr_simd_x4(fwd, timeIn, freqOut);
+        kiss_fftri_simd_x4(inv, freqIn, timeOut);
+        bench::doNotOptimize(y[0]);
+    });
+    free(fwd);
+    free(inv);
+    return ns / 4;
+}
+
+} // namespace
+
+int main() {
+    printf("%-6s %14s %14s %10s %14s %14s %10s\n", "nfft", "kiss ns", "simd ns", "speedup",
+           "simd ns/sample", "x4 ns/fft", "x4 gain");
+    for (int nfft = 64; nfft <= 8192; nfft *= 2) {
+        double kiss = roundTripNs<kiss_fftr_cfg>(nfft, kiss_fftr_alloc, kiss_fftr, kiss_fftri);
+        double fast = roundTripNs<kiss_fftr_simd_cfg>(nfft, kiss_fftr_simd_alloc,
+                                                      kiss_fftr_simd, kiss_fftri_simd);
+        double batch = batchRoundTripNs(nfft);
+        printf("%-6d %14.1f %14.1f %9.2fx %14.2f %14.1f %9.2fx\n", nfft, kiss, fast, kiss / fast,
+               fast / nfft, batch, fast / batch);
+    }
+
+    printf("\n%-6s %8s %14s %14s %14s %14s %10s\n", "nfft", "burst", "kiss ns", "simd ns",
+           "simd ns/sample", "pow2 ns/sample", "vs pow2");
+    for (int nfft : {96, 192, 384, 480, 960, 1920, 3840}) {
+        double kiss = roundTripNs<kiss_fftr_cfg>(nfft, kiss_fftr_alloc, kiss_fftr, kiss_fftri);
+        double fast = roundTripNs<kiss_fftr_simd_cfg>(nfft, kiss_fftr_simd_alloc,
+                                                      kiss_fftr_simd, kiss_fftri_simd);
+        // the powers of two either side, per sample
+        int below = 1;
+        while (below * 2 <= nfft) below *= 2;
+        double pow2 = 0.0;
+        for (int size : {below, 2 * below}) {
+            pow2 += 0.5 * roundTripNs<kiss_fftr_simd_cfg>(size, kiss_fftr_simd_alloc, kiss_fftr_simd,
+                                                          kiss_fftri_simd) / size;
+        }
+        printf("%-6d %8d %14.1f %14.1f %14.2f %14.2f %9.2fx\n", nfft, nfft / 2, kiss, fast,
+               fast / nfft, pow2, fast / nfft / pow2);
+    }
+    return 0;
+}
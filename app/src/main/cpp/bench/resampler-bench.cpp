@@ -0,0 +1,44 @@
+// Throughput of PolyphaseResampler for the rate pairs the engine meets, per output
+// frame and as a share of the callback budget, driven the way the engine drives it:
+// push mode for the microphone side, pull mode for 192 frames of the speaker side.
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "BenchUtil.h"
+#include "PolyphaseResampler.h"
+
+namespace {
+
+constexpr int32_t kBurst = 192;
+
+void benchPair(int32_t inputRate, int32_t outputRate) {
+    PolyphaseResampler resampler;
+    resampler.configure(inputRate, outputRate, 4096);
+    std::vector<float> input(4096), output(4096);
+    for (size_t i = 0; i < input.size(); ++i) input[i] = (float) ((i * 7919) % 1000) * 1e-3f - 0.5f;
+
+    // Pull: exactly kBurst outputs per call
+    double ns = bench::measureNs([&] {
+        const int32_t need = resampler.inputFramesFor(kBurst);
+        bench::doNotOptimize(resampler.process(input.data(), need, output.data(), kBurst));
+    }, 1024);
+    printf("%6d -> %6d %5d/%-5d %6d %10.1f %10.2f %9.2f%%\n", inputRate, outputRate,
+           resampler.getUpFactor(), resampler.getDownFactor(), resampler.getTapsPerPhase(), ns,
+           ns / kBurst, 100.0 * bench::budgetFraction(ns, kBurst, outputRate));
+}
+
+} // namespace
+
+int main() {
+    printf("%d output frames per call\n", kBurst);
+    printf("%6s    %6s %11s %6s %10s %10s %10s\n", "in", "out", "L/M", "taps", "ns/call",
+           "ns/frame", "budget");
+    benchPair(44100, 48000);
+    benchPair(48000, 44100);
+    benchPair(16000, 48000);
+    benchPair(48000, 16000);
+    benchPair(48000, 96000);
+    return 0;
+}
@@ -0,0 +1,123 @@
+// Cost per callback of the MicPassthrough buffering path: the old vector FIFO with
+// front erase and modulo-indexed input ring vs. SpscRingBuffer. The spectral
+// processing is replaced by a plain windowed copy so only the buffering is measured.
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "BenchUtil.h"
+#include "SpscRingBuffer.h"
+
+namespace {
+
+constexpr int kFrameSize = 1024;
+constexpr int kHop = kFrameSize / 2;
+
+std::vector<float> makeWindow() {
+    std::vector<float> window(kFrameSize);
+    for (int i = 0; i < kFrameSize; ++i) {
+        window[i] = 0.5f - 0.5f * cosf(2.0f * M_PI * i / (kFrameSize - 1));
+    }
+    return window;
+}
+
+// Mirrors the pre-SpscRingBuffer onAudioReady buffering.
+class LegacyPath {
+public:
+    LegacyPath() : mWindow(makeWindow()), mFrame(kFrameSize), mRing(kFrameSize * 2) {
+        mFifo.reserve(kFrameSize * 8);
+    }
+
+    void callback(const float *in, float *out, int numFrames) {
+        for (int i = 0; i < numFrames; ++i) {
+            mRing[mWriteIndex] = in[i];
+            mWriteIndex = (mWriteIndex + 1) % mRing.size();
+            if (mSize < (int)mRing.size()) {
+                ++mSize;
+            } else {
+                mReadIndex = (mReadIndex + 1) % mRing.size();
+            }
+        }
+        while (mSize >= kFrameSize) {
+            for (int n = 0; n < kFrameSize; ++n) {
+                int idx = (mReadIndex + n) % mRing.size();
+                mFrame[n] = mRing[idx] * mWindow[n];
+            }
+            mFifo.insert(mFifo.end(), mFrame.begin(), mFrame.begin() + kHop);
+            mReadIndex = (mReadIndex + kHop) % mRing.size();
+            mSize -= kHop;
+        }
+        int toCopy = std::min((int)mFifo.size(), numFrames);
+        if (toCopy > 0) {
+            std::copy(mFifo.begin(), mFifo.begin() + toCopy, out);
+            mFifo.erase(mFifo.begin(), mFifo.begin() + toCopy);
+        }
+        std::fill(out + toCopy, out + numFrames, 0.0f);
+    }
+
+private:
+    std::vector<float> mWindow;
+    std::vector<float> mFrame;
+    std::vector<float> mRing;
+    std::vector<float> mFifo;
+    int mWriteIndex = 0;
+    int mReadIndex = 0;
+    int mSize = 0;
+};
+
+// Mirrors the current onAudioReady buffering.
+class RingPath {
+public:
+    RingPath() : mWindow(makeWindow()), mFrame(kFrameSize),
+                 mInputRing(kFrameSize * 2), mOutputFifo(kFrameSize * 8) {}
+
+    void callback(const float *in, float *out, int numFrames) {
+        size_t space = mInputRing.availableToWrite();
+        if ((size_t)numFrames > space) mInputRing.consume(numFrames - space);
+        mInputRing.write(in, numFrames);
+
+        while (mInputRing.availableToRead() >= (size_t)kFrameSize) {
+            auto block = mInputRing.readSpans(kFrameSize);
+            const float *w = mWindow.data();
+            float *dst = mFrame.data();
+            for (size_t n = 0; n < block.firstSize; ++n) dst[n] = block.first[n] * w[n];
+            for (size_t n = 0; n < block.secondSize; ++n) {
+                dst[block.firstSize + n] = block.second[n] * w[block.firstSize + n];
+            }
+            mOutputFifo.write(mFrame.data(), kHop);
+            mInputRing.consume(kHop);
+        }
+        int toCopy = (int)mOutputFifo.read(out, numFrames);
+        std::fill(out + toCopy, out + numFrames, 0.0f);
+    }
+
+private:
+    std::vector<float> mWindow;
+    std::vector<float> mFrame;
+    SpscRingBuffer<float> mInputRing;
+    SpscRingBuffer<float> mOutputFifo;
+};
+
+template <typename Path>
+double run(int burst) {
+    Path path;
+    std::vector<float> in(burst), out(burst);
+    for (int i = 0; i < burst; ++i) in[i] = sinf(0.01f * i);
+    return bench::measureNs([&] {
+        path.callback(in.data(), out.data(), burst);
+        bench::doNotOptimize(out[0]);
+    }, 1024);
+}
+
+} // namespace
+
+int main() {
+    printf("%-8s %16s %16s %10s\n", "burst", "legacy ns/cb", "spsc ns/cb", "speedup");
+    for (int burst : {48, 96, 192, 256, 480}) {
+        double legacy = run<LegacyPath>(burst);
+        double ring = run<RingPath>(burst);
+        printf("%-8d %16.1f %16.1f %9.2fx\n", burst, legacy, ring, legacy / ring);
+    }
+    return 0;
+}
@@ -0,0 +1,125 @@
+// Throughput of SampleConverter per device format, in and out, next to a plain scalar
+// loop doing the same scaling, rounding and saturation (no dither), at one 192-frame
+// callback and at the largest callback the engine takes.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "BenchUtil.h"
+#include "SampleConverter.h"
+
+namespace {
+
+using Format = SampleConverter::Format;
+
+const char *formatName(Format format) {
+    switch (format) {
+        case Format::I16:
+            return "i16";
+        case Format::I24:
+            return "i24";
+        case Format::I32:
+            return "i32";
+        default:
+            return "float";
+    }
+}
+
+// What the converters replace: one sample at a time
+void scalarFromFloat(Format format, const float *input, void *output, int32_t n) {
+    const double scale = format == Format::I16 ? 32768.0 : format == Format::I24 ? 8388608.0 : 2147483648.0;
+    for (int32_t i = 0; i < n; ++i) {
+        const double v = std::min(std::max(input[i] * scale, -scale), scale - 1.0);
+        const int32_t x = (int32_t) lrint(v);
+        if (format == Format::I16) {
+            static_cast<int16_t *>(output)[i] = (int16_t) x;
+        } else if (format == Format::I24) {
+            uint8_t *p = static_cast<uint8_t *>(output) + 3 * i;
+            p[0] = (uint8_t) x;
+            p[1] = (uint8_t) (x >> 8);
+            p[2] = (uint8_t) (x >> 16);
+        } else {
+            static_cast<int32_t *>(output)[i] = x;
+        }
+    }
+}
+
+void scalarToFloat(Format format, const void *input, float *output, int32_t n) {
+    for (int32_t i = 0; i < n; ++i) {
+        if (format == Format::I16) {
+            output[i] = static_cast<const int16_t *>(input)[i] / 32768.0f;
+        } else if (format == Format::I24) {
+            const uint8_t *p = static_cast<const uint8_t *>(input) + 3 * i;
+            const int32_t x = (int32_t) ((uint32_t) p[0] << 8 | (uint32_t) p[1] << 16 |
+                                         (uint32_t) p[2] << 24) >> 8;
+            output[i] = x / 8388608.0f;
+        } else {
+            output[i] = static_cast<const int32_t *>(input)[i] / 2147483648.0f;
+        }
+    }
+}
+
+void printRow(const char *name, double ns, int32_t samples) {
+    printf("%-26s %12.1f %12.3f %12.0f\n", name, ns, ns / samples, 1e3 * samples / ns);
+}
+
+void benchFormats(int32_t samples) {
+    printf("\n%d samples per call\n", samples);
+    printf("%-26s %12s %12s %12s\n", "conversion", "ns/call", "ns/sample", "Msamples/s");
+    std::vector<float> floats(samples), back(samples);
+    for (int32_t i = 0; i < samples; ++i) floats[i] = 0.8f * sinf(0.01f * i);
+    std::vector<uint8_t> device(samples * 4);
+    const int calls = std::max(65536 / samples, 4);
+    char name[48];
+
+    for (Format format : {Format::I16, Format::I24, Format::I32}) {
+        SampleConverter converter;
+        converter.configure(format, false);
+        double ns = bench::measureNs([&] {
+            scalarFromFloat(format, floats.data(), device.data(), samples);
+            bench::doNotOptimize(device[0]);
+        }, calls);
+        snprintf(name, sizeof(name), "float -> %s scalar", formatName(format));
+        printRow(name, ns, samples);
+        ns = bench::measureNs([&] {
+            converter.fromFloat(floats.data(), device.data(), samples);
+            bench::doNotOptimize(device[0]);
+        }, calls);
+        snprintf(name, sizeof(name), "float -> %s", formatName(format));
+        printRow(name, ns, samples);
+        if (format != Format::I32) {
+            converter.configure(format, true);
+            ns = bench::measureNs([&] {
+                converter.fromFloat(floats.data(), device.data(), samples);
+                bench::doNotOptimize(device[0]);
+            }, calls);
+            snprintf(name, sizeof(name), "float -> %s dithered", formatName(format));
+            printRow(name, ns, samples);
+        }
+
+        ns = bench::measureNs([&] {
+            scalarToFloat(format, device.data(), back.data(), samples);
+            bench::doNotOptimize(back[0]);
+        }, calls);
+        snprintf(name, sizeof(name), "%s -> float scalar", formatName(format));
+        printRow(name, ns, samples);
+        ns = bench::measureNs([&] {
+            converter.toFloat(device.data(), back.data(), samples);
+            bench::doNotOptimize(back[0]);
+        }, calls);
+        snprintf(name, sizeof(name), "%s -> float", formatName(format));
+        printRow(name, ns, samples);
+    }
+}
+
+} // namespace
+
+int main() {
+    benchFormats(192);
+    benchFormats(4096);
+    return 0;
+}
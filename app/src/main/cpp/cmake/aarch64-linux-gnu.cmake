@@ -0,0 +1,22 @@
+# Cross-compiles the host build for 64-bit ARM Linux, so the real NEON kernels (rather than
+# the emulated ones) build with the GNU toolchain, and ctest runs them under qemu-user:
+#
+#   cmake -S . -B build-arm64 -DCMAKE_TOOLCHAIN_FILE=cmake/aarch64-linux-gnu.cmake
+#   cmake --build build-arm64 -j && ctest --test-dir build-arm64 --output-on-failure
+#
+# Needs g++-aarch64-linux-gnu and qemu-user (Debian/Ubuntu package names).
+
+set(CMAKE_SYSTEM_NAME Linux)
+set(CMAKE_SYSTEM_PROCESSOR aarch64)
+
+set(PASSTHROUGH_CROSS_PREFIX aarch64-linux-gnu)
+set(CMAKE_C_COMPILER ${PASSTHROUGH_CROSS_PREFIX}-gcc)
+set(CMAKE_CXX_COMPILER ${PASSTHROUGH_CROSS_PREFIX}-g++)
+
+set(CMAKE_FIND_ROOT_PATH /usr/${PASSTHROUGH_CROSS_PREFIX})
+set(CMAKE_FIND_ROOT_PATH_MODE_PROGRAM NEVER)
+set(CMAKE_FIND_ROOT_PATH_MODE_LIBRARY ONLY)
+set(CMAKE_FIND_ROOT_PATH_MODE_INCLUDE ONLY)
+
+# add_test() commands run through this, with the target's loader and libc from the sysroot
+set(CMAKE_CROSSCOMPILING_EMULATOR qemu-aarch64 -L /usr/${PASSTHROUGH_CROSS_PREFIX})
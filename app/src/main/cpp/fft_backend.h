@@ -0,0 +1,105 @@
+#ifndef FFT_BACKEND_H
+#define FFT_BACKEND_H
+
+/*
+ Real FFT backend used by the engine, with the kiss_fftr calling conventions.
+
+ Defaults to the vectorized kiss_fftr_simd; build with PASSTHROUGH_SCALAR_FFT to use
+ the plain scalar kiss_fftr. kiss_fftr_simd also falls back to scalar kiss at run
+ time for sizes its vector kernels don't cover.
+
+ fft_backend_fftr_windowed transforms a windowed frame held in two spans; scratch
+ (nfft floats) is only used by the scalar backend. fft_backend_fftri_pruned inverts a
+ spectrum that is zero outside a bin range; the scalar backend ignores the range. The
+ _x4 calls run four transforms of the same size at once (see kiss_fftr_simd_x4).
+
+ fft_backend_next_size rounds up to a size the vector kernels cover (32 * 2^a * 3^b *
+ 5^c); both backends use it so a config picks the same size either way.
+ */
+
+#ifdef PASSTHROUGH_SCALAR_FFT
+
+#include "kiss_fftr.h"
+#include "kiss_fftr_simd.h"
+
+typedef kiss_fftr_cfg fft_backend_cfg;
+
+static inline fft_backend_cfg fft_backend_alloc(int nfft, int inverse_fft, void *mem, size_t *lenmem) {
+    return kiss_fftr_alloc(nfft, inverse_fft, mem, lenmem);
+}
+static inline void fft_backend_fftr(fft_backend_cfg cfg, const kiss_fft_scalar *timedata, kiss_fft_cpx *freqdata) {
+    kiss_fftr(cfg, timedata, freqdata);
+}
+static inline void fft_backend_fftri(fft_backend_cfg cfg, const kiss_fft_cpx *freqdata, kiss_fft_scalar *timedata) {
+    kiss_fftri(cfg, freqdata, timedata);
+}
+static inline void fft_backend_fftr_windowed(fft_backend_cfg cfg, int nfft, const kiss_fft_scalar *first, int firstSize,
+                                             const kiss_fft_scalar *second, const kiss_fft_scalar *window,
+                                             kiss_fft_scalar *scratch, kiss_fft_cpx *freqdata) {
+    for (int n = 0; n < firstSize; ++n) scratch[n] = first[n] * window[n];
+    for (int n = firstSize; n < nfft; ++n) {
+        scratch[n] = second[n - firstSize] * window[n];
+    }
+    kiss_fftr(cfg, scratch, freqdata);
+}
+static inline void fft_backend_fftri_pruned(fft_backend_cfg cfg, const kiss_fft_cpx *freqdata, int firstBin,
+                                            int endBin, kiss_fft_scalar *timedata) {
+    (void) firstBin;
+    (void) endBin;
+    kiss_fftri(cfg, freqdata, timedata);
+}
+static inline void fft_backend_fftr_x4(fft_backend_cfg cfg, const kiss_fft_scalar *const timedata[4],
+                                       kiss_fft_cpx *const freqdata[4]) {
+    for (int i = 0; i < 4; ++i) kiss_fftr(cfg, timedata[i], freqdata[i]);
+}
+static inline void fft_backend_fftri_x4(fft_backend_cfg cfg, const kiss_fft_cpx *const freqdata[4],
+                                        kiss_fft_scalar *const timedata[4]) {
+    for (int i = 0; i < 4; ++i) kiss_fftri(cfg, freqdata[i], timedata[i]);
+}
+static inline int fft_backend_next_size(int n) {
+    return kiss_fftr_simd_next_size(n);
+}
+#define fft_backend_free kiss_fftr_free
+
+#else
+
+#include "kiss_fftr_simd.h"
+
+typedef kiss_fftr_simd_cfg fft_backend_cfg;
+
+static inline fft_backend_cfg fft_backend_alloc(int nfft, int inverse_fft, void *mem, size_t *lenmem) {
+    return kiss_fftr_simd_alloc(nfft, inverse_fft, mem, lenmem);
+}
+static inline void fft_backend_fftr(fft_backend_cfg cfg, const kiss_fft_scalar *timedata, kiss_fft_cpx *freqdata) {
+    kiss_fftr_simd(cfg, timedata, freqdata);
+}
+static inline void fft_backend_fftri(fft_backend_cfg cfg, const kiss_fft_cpx *freqdata, kiss_fft_scalar *timedata) {
+    kiss_fftri_simd(cfg, freqdata, timedata);
+}
+static inline void fft_backend_fftr_windowed(fft_backend_cfg cfg, int nfft, const kiss_fft_scalar *first, int firstSize,
+                                             const kiss_fft_scalar *second, const kiss_fft_scalar *window,
+                                             kiss_fft_scalar *scratch, kiss_fft_cpx *freqdata) {
+    (void) nfft;
+    (void) scratch;
+    kiss_fftr_simd_windowed(cfg, first, firstSize, second, window, freqdata);
+}
+static inline void fft_backend_fftri_pruned(fft_backend_cfg cfg, const kiss_fft_cpx *freqdata, int firstBin,
+                                            int endBin, kiss_fft_scalar *timedata) {
+    kiss_fftri_simd_pruned(cfg, freqdata, firstBin, endBin, timedata);
+}
+static inline void fft_backend_fftr_x4(fft_backend_cfg cfg, const kiss_fft_scalar *const timedata[4],
+                                       kiss_fft_cpx *const freqdata[4]) {
+    kiss_fftr_simd_x4(cfg, timedata, freqdata);
+}
+static inline void fft_backend_fftri_x4(fft_backend_cfg cfg, const kiss_fft_cpx *const freqdata[4],
+                                        kiss_fft_scalar *const timedata[4]) {
+    kiss_fftri_simd_x4(cfg, freqdata, timedata);
+}
+static inline int fft_backend_next_size(int n) {
+    return kiss_fftr_simd_next_size(n);
+}
+#define fft_backend_free kiss_fftr_simd_free
+
+#endif
+
+#endif
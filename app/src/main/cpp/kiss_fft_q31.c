@@ -0,0 +1,18 @@
+/*
+ kiss_fft and kiss_fftr built a second time with FIXED_POINT=32, under _q31 names so the
+ float build links alongside. See kiss_fftr_q31.h.
+ */
+
+#define FIXED_POINT 32
+
+#define kiss_fft_alloc kiss_fft_q31_alloc
+#define kiss_fft kiss_fft_q31
+#define kiss_fft_stride kiss_fft_q31_stride
+#define kiss_fft_cleanup kiss_fft_q31_cleanup
+#define kiss_fft_next_fast_size kiss_fft_q31_next_fast_size
+#define kiss_fftr_alloc kiss_fftr_q31_alloc
+#define kiss_fftr kiss_fftr_q31
+#define kiss_fftri kiss_fftri_q31
+
+#include "kiss_fft.c"
+#include "kiss_fftr.c"
@@ -0,0 +1,38 @@
+#ifndef KISS_FFTR_Q31_H
+#define KISS_FFTR_Q31_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ kiss_fftr in 32-bit fixed point (kiss_fft_q31.c: kiss built with FIXED_POINT=32), with
+ its own type names so it can sit next to the float kiss_fft.h in one translation unit.
+
+ Same mem/lenmem contract as kiss_fftr_alloc. Samples and spectra are int32 with Q31
+ twiddles and 64-bit products. Unlike the float build both directions scale, so nothing
+ can overflow: every butterfly stage divides by its radix, so the forward transform
+ returns the spectrum divided by nfft, and the inverse returns 1/nfft of what kiss_fftri
+ would. A forward/inverse round trip therefore gives back the input divided by nfft.
+ */
+
+typedef struct {
+    int32_t r;
+    int32_t i;
+} kiss_fft_q31_cpx;
+
+typedef struct kiss_fftr_q31_state *kiss_fftr_q31_cfg;
+
+kiss_fftr_q31_cfg kiss_fftr_q31_alloc(int nfft, int inverse_fft, void *mem, size_t *lenmem);
+
+void kiss_fftr_q31(kiss_fftr_q31_cfg cfg, const int32_t *timedata, kiss_fft_q31_cpx *freqdata);
+
+void kiss_fftri_q31(kiss_fftr_q31_cfg cfg, const kiss_fft_q31_cpx *freqdata, int32_t *timedata);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
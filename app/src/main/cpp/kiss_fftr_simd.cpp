@@ -0,0 +1,945 @@
+#include "kiss_fftr_simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "SimdVec4.h"
+#include "kiss_fft_log.h"
+
+using simd::vec4;
+
+namespace {
+
+constexpr int kMaxStages = 32;
+
+// The vector kernels handle complex sizes that are multiples of this: the first (stride
+// 1, radix 4) pass is vectorized across butterflies, four at a time.
+constexpr int kMinVectorSize = 16;
+
+/*
+ One Stockham pass: n is the length of the sub-transforms entering the pass, s their
+ stride (n * s == ncfft), m = n / radix butterflies per sub-transform. tw holds
+ w^(j*p) for j = 1..radix-1, p < m, as (radix-1) pairs of re[m], im[m] rows.
+ */
+struct Stage {
+    int radix;
+    int n;
+    int s;
+    const float *tw;
+};
+
+size_t alignFloats(size_t count) {
+    return (count + 3) & ~size_t(3);
+}
+
+} // namespace
+
+struct kiss_fftr_simd_state {
+    int nfft;
+    int ncfft;
+    int inverse;
+    int numStages;
+    kiss_fftr_cfg fallback;     // non-null when the vector path doesn't support ncfft
+    Stage stages[kMaxStages];
+    float *superRe;             // exp(-i*pi*k/ncfft), k < ncfft
+    float *superIm;
+    float *work[4];             // re/im ping, re/im pong
+    float *batch[4];            // the same for four lane-interleaved transforms
+    float *batchTw;             // first pass twiddles, each repeated across four lanes
+    float *fallbackScratch;     // nfft floats for the windowed entry on the fallback path
+};
+
+namespace {
+
+// ---------------------------------------------------------------------------
+// Complex butterflies. Everything is a forward transform; the inverse real FFT uses
+// ifft(Z) = conj(fft(conj(Z))), folded into its pre and post loops.
+
+inline void cmul(float ar, float ai, float br, float bi, float &r, float &i) {
+    r = ar * br - ai * bi;
+    i = ar * bi + ai * br;
+}
+
+inline void cmul(vec4 ar, vec4 ai, vec4 br, vec4 bi, vec4 &r, vec4 &i) {
+    r = simd::sub(simd::mul(ar, br), simd::mul(ai, bi));
+    i = simd::madd(ar, bi, simd::mul(ai, br));
+}
+
+void radix4Scalar(const Stage &st, const float *xr, const float *xi, float *yr, float *yi) {
+    const int s = st.s;
+    const int m = st.n / 4;
+    const float *tw = st.tw;
+    for (int p = 0; p < m; ++p) {
+        const float w1r = tw[p], w1i = tw[m + p];
+        const float w2r = tw[2 * m + p], w2i = tw[3 * m + p];
+        const float w3r = tw[4 * m + p], w3i = tw[5 * m + p];
+        for (int q = 0; q < s; ++q) {
+            const int ia = q + s * p, ib = ia + s * m, ic = ib + s * m, id = ic + s * m;
+            float apcR = xr[ia] + xr[ic], apcI = xi[ia] + xi[ic];
+            float amcR = xr[ia] - xr[ic], amcI = xi[ia] - xi[ic];
+            float bpdR = xr[ib] + xr[id], bpdI = xi[ib] + xi[id];
+            float bmdR = xr[ib] - xr[id], bmdI = xi[ib] - xi[id];
+
+            const int o = q + s * 4 * p;
+            yr[o] = apcR + bpdR;
+            yi[o] = apcI + bpdI;
+            // (a - c) - j(b - d)
+            cmul(amcR + bmdI, amcI - bmdR, w1r, w1i, yr[o + s], yi[o + s]);
+            cmul(apcR - bpdR, apcI - bpdI, w2r, w2i, yr[o + 2 * s], yi[o + 2 * s]);
+            // (a - c) + j(b - d)
+            cmul(amcR - bmdI, amcI + bmdR, w3r, w3i, yr[o + 3 * s], yi[o + 3 * s]);
+        }
+    }
+}
+
+// Stride >= 4: vectorize across q, twiddles are broadcast per butterfly.
+void radix4VectorQ(const Stage &st, const float *xr, const float *xi, float *yr, float *yi) {
+    const int s = st.s;
+    const int m = st.n / 4;
+    const float *tw = st.tw;
+    for (int p = 0; p < m; ++p) {
+        const vec4 w1r = simd::set1(tw[p]), w1i = simd::set1(tw[m + p]);
+        const vec4 w2r = simd::set1(tw[2 * m + p]), w2i = simd::set1(tw[3 * m + p]);
+        const vec4 w3r = simd::set1(tw[4 * m + p]), w3i = simd::set1(tw[5 * m + p]);
+        const float *ar = xr + s * p, *ai = xi + s * p;
+        const float *br = ar + s * m, *bi = ai + s * m;
+        const float *cr = br + s * m, *ci = bi + s * m;
+        const float *dr = cr + s * m, *di = ci + s * m;
+        float *y0r = yr + s * 4 * p, *y0i = yi + s * 4 * p;
+        for (int q = 0; q < s; q += 4) {
+            vec4 a_r = simd::load(ar + q), a_i = simd::load(ai + q);
+            vec4 b_r = simd::load(br + q), b_i = simd::load(bi + q);
+            vec4 c_r = simd::load(cr + q), c_i = simd::load(ci + q);
+            vec4 d_r = simd::load(dr + q), d_i = simd::load(di + q);
+            vec4 apcR = simd::add(a_r, c_r), apcI = simd::add(a_i, c_i);
+            vec4 amcR = simd::sub(a_r, c_r), amcI = simd::sub(a_i, c_i);
+            vec4 bpdR = simd::add(b_r, d_r), bpdI = simd::add(b_i, d_i);
+            vec4 bmdR = simd::sub(b_r, d_r), bmdI = simd::sub(b_i, d_i);
+
+            simd::store(y0r + q, simd::add(apcR, bpdR));
+            simd::store(y0i + q, simd::add(apcI, bpdI));
+            vec4 r, i;
+            cmul(simd::add(amcR, bmdI), simd::sub(amcI, bmdR), w1r, w1i, r, i);
+            simd::store(y0r + s + q, r);
+            simd::store(y0i + s + q, i);
+            cmul(simd::sub(apcR, bpdR), simd::sub(apcI, bpdI), w2r, w2i, r, i);
+            simd::store(y0r + 2 * s + q, r);
+            simd::store(y0i + 2 * s + q, i);
+            cmul(simd::sub(amcR, bmdI), simd::add(amcI, bmdR), w3r, w3i, r, i);
+            simd::store(y0r + 3 * s + q, r);
+            simd::store(y0i + 3 * s + q, i);
+        }
+    }
+}
+
+// Stride 1 (first pass): vectorize across four butterflies p..p+3 and transpose the
+// results so each butterfly's four outputs land contiguously.
+// pBegin and pEnd (multiples of four) restrict it to a range of butterflies.
+void radix4VectorP(const Stage &st, const float *xr, const float *xi, float *yr, float *yi,
+                   int pBegin, int pEnd) {
+    const int m = st.n / 4;
+    const float *tw = st.tw;
+    for (int p = pBegin; p < pEnd; p += 4) {
+        vec4 a_r = simd::load(xr + p), a_i = simd::load(xi + p);
+        vec4 b_r = simd::load(xr + m + p), b_i = simd::load(xi + m + p);
+        vec4 c_r = simd::load(xr + 2 * m + p), c_i = simd::load(xi + 2 * m + p);
+        vec4 d_r = simd::load(xr + 3 * m + p), d_i = simd::load(xi + 3 * m + p);
+        vec4 apcR = simd::add(a_r, c_r), apcI = simd::add(a_i, c_i);
+        vec4 amcR = simd::sub(a_r, c_r), amcI = simd::sub(a_i, c_i);
+        vec4 bpdR = simd::add(b_r, d_r), bpdI = simd::add(b_i, d_i);
+        vec4 bmdR = simd::sub(b_r, d_r), bmdI = simd::sub(b_i, d_i);
+
+        vec4 y0r = simd::add(apcR, bpdR), y0i = simd::add(apcI, bpdI);
+        vec4 y1r, y1i, y2r, y2i, y3r, y3i;
+        cmul(simd::add(amcR, bmdI), simd::sub(amcI, bmdR),
+             simd::load(tw + p), simd::load(tw + m + p), y1r, y1i);
+        cmul(simd::sub(apcR, bpdR), simd::sub(apcI, bpdI),
+             simd::load(tw + 2 * m + p), simd::load(tw + 3 * m + p), y2r, y2i);
+        cmul(simd::sub(amcR, bmdI), simd::add(amcI, bmdR),
+             simd::load(tw + 4 * m + p), simd::load(tw + 5 * m + p), y3r, y3i);
+
+        simd::transpose(y0r, y1r, y2r, y3r);
+        simd::transpose(y0i, y1i, y2i, y3i);
+        float *outR = yr + 4 * p, *outI = yi + 4 * p;
+        simd::store(outR, y0r);
+        simd::store(outR + 4, y1r);
+        simd::store(outR + 8, y2r);
+        simd::store(outR + 12, y3r);
+        simd::store(outI, y0i);
+        simd::store(outI + 4, y1i);
+        simd::store(outI + 8, y2i);
+        simd::store(outI + 12, y3i);
+    }
+}
+
+// Radix 3 and 5 only ever follow the first radix-4 pass, so their stride is a multiple
+// of four and they vectorize across q like radix4VectorQ.
+void radix3VectorQ(const Stage &st, const float *xr, const float *xi, float *yr, float *yi) {
+    const int s = st.s;
+    const int m = st.n / 3;
+    const float *tw = st.tw;
+    const vec4 minusHalf = simd::set1(-0.5f);
+    const vec4 sin60 = simd::set1(0.86602540378f);
+    for (int p = 0; p < m; ++p) {
+        const vec4 w1r = simd::set1(tw[p]), w1i = simd::set1(tw[m + p]);
+        const vec4 w2r = simd::set1(tw[2 * m + p]), w2i = simd::set1(tw[3 * m + p]);
+        const float *ar = xr + s * p, *ai = xi + s * p;
+        const float *br = ar + s * m, *bi = ai + s * m;
+        const float *cr = br + s * m, *ci = bi + s * m;
+        float *y0r = yr + s * 3 * p, *y0i = yi + s * 3 * p;
+        for (int q = 0; q < s; q += 4) {
+            vec4 a_r = simd::load(ar + q), a_i = simd::load(ai + q);
+            vec4 b_r = simd::load(br + q), b_i = simd::load(bi + q);
+            vec4 c_r = simd::load(cr + q), c_i = simd::load(ci + q);
+            vec4 sumR = simd::add(b_r, c_r), sumI = simd::add(b_i, c_i);
+            // a + w b + w^2 c = (a - (b + c) / 2) -+ j sin(60) (b - c), w = exp(-2 pi j / 3)
+            vec4 midR = simd::madd(minusHalf, sumR, a_r), midI = simd::madd(minusHalf, sumI, a_i);
+            vec4 rotR = simd::mul(sin60, simd::sub(b_r, c_r));
+            vec4 rotI = simd::mul(sin60, simd::sub(b_i, c_i));
+
+            simd::store(y0r + q, simd::add(a_r, sumR));
+            simd::store(y0i + q, simd::add(a_i, sumI));
+            vec4 r, i;
+            cmul(simd::add(midR, rotI), simd::sub(midI, rotR), w1r, w1i, r, i);
+            simd::store(y0r + s + q, r);
+            simd::store(y0i + s + q, i);
+            cmul(simd::sub(midR, rotI), simd::add(midI, rotR), w2r, w2i, r, i);
+            simd::store(y0r + 2 * s + q, r);
+            simd::store(y0i + 2 * s + q, i);
+        }
+    }
+}
+
+void radix5VectorQ(const Stage &st, const float *xr, const float *xi, float *yr, float *yi) {
+    const int s = st.s;
+    const int m = st.n / 5;
+    const float *tw = st.tw;
+    // cos and sin of 2 pi / 5 and 4 pi / 5
+    const vec4 c1 = simd::set1(0.30901699437f), c2 = simd::set1(-0.80901699437f);
+    const vec4 s1 = simd::set1(0.95105651630f), s2 = simd::set1(0.58778525229f);
+    for (int p = 0; p < m; ++p) {
+        vec4 wr[4], wi[4];
+        for (int j = 0; j < 4; ++j) {
+            wr[j] = simd::set1(tw[2 * j * m + p]);
+            wi[j] = simd::set1(tw[(2 * j + 1) * m + p]);
+        }
+        const float *ar = xr + s * p, *ai = xi + s * p;
+        float *y0r = yr + s * 5 * p, *y0i = yi + s * 5 * p;
+        for (int q = 0; q < s; q += 4) {
+            vec4 x_r[5], x_i[5];
+            for (int j = 0; j < 5; ++j) {
+                x_r[j] = simd::load(ar + j * s * m + q);
+                x_i[j] = simd::load(ai + j * s * m + q);
+            }
+            // Pairs symmetric about the middle share cosines and take opposite sines
+            vec4 t1r = simd::add(x_r[1], x_r[4]), t1i = simd::add(x_i[1], x_i[4]);
+            vec4 t2r = simd::add(x_r[2], x_r[3]), t2i = simd::add(x_i[2], x_i[3]);
+            vec4 t3r = simd::sub(x_r[1], x_r[4]), t3i = simd::sub(x_i[1], x_i[4]);
+            vec4 t4r = simd::sub(x_r[2], x_r[3]), t4i = simd::sub(x_i[2], x_i[3]);
+
+            vec4 m1r = simd::madd(c2, t2r, simd::madd(c1, t1r, x_r[0]));
+            vec4 m1i = simd::madd(c2, t2i, simd::madd(c1, t1i, x_i[0]));
+            vec4 m2r = simd::madd(c1, t2r, simd::madd(c2, t1r, x_r[0]));
+            vec4 m2i = simd::madd(c1, t2i, simd::madd(c2, t1i, x_i[0]));
+            vec4 n1r = simd::madd(s2, t4r, simd::mul(s1, t3r));
+            vec4 n1i = simd::madd(s2, t4i, simd::mul(s1, t3i));
+            vec4 n2r = simd::sub(simd::mul(s2, t3r), simd::mul(s1, t4r));
+            vec4 n2i = simd::sub(simd::mul(s2, t3i), simd::mul(s1, t4i));
+
+            simd::store(y0r + q, simd::add(x_r[0], simd::add(t1r, t2r)));
+            simd::store(y0i + q, simd::add(x_i[0], simd::add(t1i, t2i)));
+            // outputs 1 and 4 are m1 -+ j n1, outputs 2 and 3 are m2 -+ j n2
+            const vec4 outR[4] = {simd::add(m1r, n1i), simd::add(m2r, n2i),
+                                  simd::sub(m2r, n2i), simd::sub(m1r, n1i)};
+            const vec4 outI[4] = {simd::sub(m1i, n1r), simd::sub(m2i, n2r),
+                                  simd::add(m2i, n2r), simd::add(m1i, n1r)};
+            for (int j = 0; j < 4; ++j) {
+                vec4 r, i;
+                cmul(outR[j], outI[j], wr[j], wi[j], r, i);
+                simd::store(y0r + (j + 1) * s + q, r);
+                simd::store(y0i + (j + 1) * s + q, i);
+            }
+        }
+    }
+}
+
+void radix2Scalar(const Stage &st, const float *xr, const float *xi, float *yr, float *yi) {
+    const int s = st.s;
+    const int m = st.n / 2;
+    for (int p = 0; p < m; ++p) {
+        const float wr = st.tw[p], wi = st.tw[m + p];
+        for (int q = 0; q < s; ++q) {
+            const int ia = q + s * p, ib = ia + s * m;
+            const int o = q + s * 2 * p;
+            yr[o] = xr[ia] + xr[ib];
+            yi[o] = xi[ia] + xi[ib];
+            cmul(xr[ia] - xr[ib], xi[ia] - xi[ib], wr, wi, yr[o + s], yi[o + s]);
+        }
+    }
+}
+
+// Final radix-2 pass (n == 2, a single twiddle-free butterfly per q).
+void radix2VectorLast(const Stage &st, const float *xr, const float *xi, float *yr, float *yi) {
+    const int s = st.s;
+    for (int q = 0; q < s; q += 4) {
+        vec4 a_r = simd::load(xr + q), a_i = simd::load(xi + q);
+        vec4 b_r = simd::load(xr + s + q), b_i = simd::load(xi + s + q);
+        simd::store(yr + q, simd::add(a_r, b_r));
+        simd::store(yi + q, simd::add(a_i, b_i));
+        simd::store(yr + s + q, simd::sub(a_r, b_r));
+        simd::store(yi + s + q, simd::sub(a_i, b_i));
+    }
+}
+
+void runStage(const Stage &st, const float *xr, const float *xi, float *yr, float *yi) {
+    const int m = st.n / st.radix;
+    if (st.radix == 3) {
+        radix3VectorQ(st, xr, xi, yr, yi);
+    } else if (st.radix == 5) {
+        radix5VectorQ(st, xr, xi, yr, yi);
+    } else if (st.radix == 4) {
+        if (st.s % 4 == 0) {
+            radix4VectorQ(st, xr, xi, yr, yi);
+        } else if (st.s == 1 && m % 4 == 0) {
+            radix4VectorP(st, xr, xi, yr, yi, 0, m);
+        } else {
+            radix4Scalar(st, xr, xi, yr, yi);
+        }
+    } else {
+        if (m == 1 && st.s % 4 == 0) {
+            radix2VectorLast(st, xr, xi, yr, yi);
+        } else {
+            radix2Scalar(st, xr, xi, yr, yi);
+        }
+    }
+}
+
+// Forward complex FFT of work[0]/work[1]; returns the buffer pair holding the result.
+// A nonzero first skips stages the caller already ran, whose output alternates between
+// the pong and ping pairs.
+float *const *complexForward(kiss_fftr_simd_cfg st, int first = 0) {
+    float *const *in = st->work + 2 * (first & 1);
+    float *const *out = st->work + 2 - 2 * (first & 1);
+    for (int i = first; i < st->numStages; ++i) {
+        runStage(st->stages[i], in[0], in[1], out[0], out[1]);
+        float *const *tmp = in;
+        in = out;
+        out = tmp;
+    }
+    return in;
+}
+
+// First pass of four interleaved transforms (stride 4, radix 4): one butterfly per
+// twiddle set, so the twiddles come pre-broadcast rather than set1 each time.
+void radix4VectorFirstX4(const Stage &st, const float *tw4, const float *xr, const float *xi,
+                         float *yr, float *yi) {
+    const int m = st.n / 4;
+    for (int p = 0; p < m; ++p, tw4 += 24) {
+        const int ia = 4 * p, ib = ia + 4 * m, ic = ib + 4 * m, id = ic + 4 * m;
+        vec4 a_r = simd::load(xr + ia), a_i = simd::load(xi + ia);
+        vec4 b_r = simd::load(xr + ib), b_i = simd::load(xi + ib);
+        vec4 c_r = simd::load(xr + ic), c_i = simd::load(xi + ic);
+        vec4 d_r = simd::load(xr + id), d_i = simd::load(xi + id);
+        vec4 apcR = simd::add(a_r, c_r), apcI = simd::add(a_i, c_i);
+        vec4 amcR = simd::sub(a_r, c_r), amcI = simd::sub(a_i, c_i);
+        vec4 bpdR = simd::add(b_r, d_r), bpdI = simd::add(b_i, d_i);
+        vec4 bmdR = simd::sub(b_r, d_r), bmdI = simd::sub(b_i, d_i);
+
+        float *y0r = yr + 16 * p, *y0i = yi + 16 * p;
+        simd::store(y0r, simd::add(apcR, bpdR));
+        simd::store(y0i, simd::add(apcI, bpdI));
+        vec4 r, i;
+        cmul(simd::add(amcR, bmdI), simd::sub(amcI, bmdR), simd::load(tw4), simd::load(tw4 + 4), r, i);
+        simd::store(y0r + 4, r);
+        simd::store(y0i + 4, i);
+        cmul(simd::sub(apcR, bpdR), simd::sub(apcI, bpdI), simd::load(tw4 + 8), simd::load(tw4 + 12), r, i);
+        simd::store(y0r + 8, r);
+        simd::store(y0i + 8, i);
+        cmul(simd::sub(amcR, bmdI), simd::add(amcI, bmdR), simd::load(tw4 + 16), simd::load(tw4 + 20), r, i);
+        simd::store(y0r + 12, r);
+        simd::store(y0i + 12, i);
+    }
+}
+
+// Four transforms interleaved lane by lane (element e of transform l at [4 * e + l]) look
+// like one transform with every stride four times wider, so each pass is the
+// stride-vectorized kernel whatever its position; no transposes between passes.
+float *const *complexForwardX4(kiss_fftr_simd_cfg st) {
+    float *const *in = st->batch;
+    float *const *out = st->batch + 2;
+    for (int i = 0; i < st->numStages; ++i) {
+        Stage wide = st->stages[i];
+        wide.s *= 4;
+        if (i == 0 && wide.radix == 4) {
+            radix4VectorFirstX4(wide, st->batchTw, in[0], in[1], out[0], out[1]);
+        } else if (wide.radix == 4) {
+            radix4VectorQ(wide, in[0], in[1], out[0], out[1]);
+        } else if (wide.radix == 3) {
+            radix3VectorQ(wide, in[0], in[1], out[0], out[1]);
+        } else if (wide.radix == 5) {
+            radix5VectorQ(wide, in[0], in[1], out[0], out[1]);
+        } else {
+            radix2VectorLast(wide, in[0], in[1], out[0], out[1]);
+        }
+        float *const *tmp = in;
+        in = out;
+        out = tmp;
+    }
+    return in;
+}
+
+// Radix-4 passes, then radix 3 and 5, then at most one radix-2 pass, which stays last
+// so it is the twiddle-free one. Returns -1 for sizes with other prime factors.
+int planStages(int ncfft, int *radices) {
+    int count = 0;
+    int n = ncfft;
+    while (n % 4 == 0) {
+        radices[count++] = 4;
+        n /= 4;
+    }
+    const bool radix2 = n % 2 == 0;
+    if (radix2) n /= 2;
+    for (int radix : {3, 5}) {
+        while (n % radix == 0) {
+            radices[count++] = radix;
+            n /= radix;
+        }
+    }
+    if (radix2) radices[count++] = 2;
+    return n == 1 ? count : -1;
+}
+
+// Complex FFT of the packed work[0]/work[1] and the real-spectrum merge.
+void forwardFromPacked(kiss_fftr_simd_cfg st, kiss_fft_cpx *freqdata) {
+    const int M = st->ncfft;
+    float *const *z = complexForward(st);
+    const float *zr = z[0];
+    const float *zi = z[1];
+
+    // X[k] = (Z[k] + conj Z[M-k]) / 2 + W^k (Z[k] - conj Z[M-k]) / 2i
+    float *out = (float *) freqdata;
+    out[0] = zr[0] + zi[0];
+    out[1] = 0.0f;
+    out[2 * M] = zr[0] - zi[0];
+    out[2 * M + 1] = 0.0f;
+
+    const vec4 half = simd::set1(0.5f);
+    int k = 1;
+    for (; k + 3 <= M - 1; k += 4) {
+        vec4 ar = simd::load(zr + k), ai = simd::load(zi + k);
+        vec4 br = simd::reverse(simd::load(zr + M - k - 3));
+        vec4 bi = simd::reverse(simd::load(zi + M - k - 3));
+        vec4 evenR = simd::mul(half, simd::add(ar, br));
+        vec4 evenI = simd::mul(half, simd::sub(ai, bi));
+        vec4 oddR = simd::mul(half, simd::add(ai, bi));
+        vec4 oddI = simd::mul(half, simd::sub(br, ar));
+        vec4 tr, ti;
+        cmul(oddR, oddI, simd::load(st->superRe + k), simd::load(st->superIm + k), tr, ti);
+        simd::storeInterleave(out + 2 * k, simd::add(evenR, tr), simd::add(evenI, ti));
+    }
+    for (; k < M; ++k) {
+        float ar = zr[k], ai = zi[k], br = zr[M - k], bi = zi[M - k];
+        float tr, ti;
+        cmul(0.5f * (ai + bi), 0.5f * (br - ar), st->superRe[k], st->superIm[k], tr, ti);
+        out[2 * k] = 0.5f * (ar + br) + tr;
+        out[2 * k + 1] = 0.5f * (ai - bi) + ti;
+    }
+}
+
+// Inverse pre-processing for bins k in [kBegin, kEnd) within [1, M):
+// Z[k] = (X[k] + conj X[M-k]) + i (X[k] - conj X[M-k]) conj(W^k), stored conjugated
+// so the forward kernels compute the inverse transform.
+void inverseMerge(kiss_fftr_simd_cfg st, const float *in, int kBegin, int kEnd) {
+    const int M = st->ncfft;
+    float *zr = st->work[0], *zi = st->work[1];
+    int k = kBegin;
+    for (; k + 4 <= kEnd; k += 4) {
+        vec4 ar, ai, br, bi;
+        simd::loadDeinterleave(in + 2 * k, ar, ai);
+        simd::loadDeinterleave(in + 2 * (M - k - 3), br, bi);
+        br = simd::reverse(br);
+        bi = simd::reverse(bi);
+        vec4 er = simd::add(ar, br), ei = simd::sub(ai, bi);
+        vec4 dr = simd::sub(ar, br), di = simd::add(ai, bi);
+        vec4 fr, fi;
+        cmul(dr, di, simd::load(st->superRe + k), simd::neg(simd::load(st->superIm + k)), fr, fi);
+        simd::store(zr + k, simd::sub(er, fi));
+        simd::store(zi + k, simd::neg(simd::add(ei, fr)));
+    }
+    for (; k < kEnd; ++k) {
+        float ar = in[2 * k], ai = in[2 * k + 1];
+        float br = in[2 * (M - k)], bi = in[2 * (M - k) + 1];
+        float fr, fi;
+        cmul(ar - br, ai + bi, st->superRe[k], -st->superIm[k], fr, fi);
+        zr[k] = (ar + br) - fi;
+        zi[k] = -((ai - bi) + fr);
+    }
+}
+
+// Z[0] takes X[0] and X[M] (the DC and Nyquist bins)
+void inverseMergeEnds(kiss_fftr_simd_cfg st, const float *in) {
+    const int M = st->ncfft;
+    float ar = in[0], ai = in[1], br = in[2 * M], bi = in[2 * M + 1];
+    st->work[0][0] = (ar + br) - (ai + bi);
+    st->work[1][0] = -((ai - bi) + (ar - br));
+}
+
+// Undo the conjugation and unpack re/im back into even/odd samples
+void inverseUnpack(float *const *z, int M, kiss_fft_scalar *timedata) {
+    for (int n = 0; n < M; n += 4) {
+        simd::storeInterleave(timedata + 2 * n, simd::load(z[0] + n), simd::neg(simd::load(z[1] + n)));
+    }
+}
+
+struct Span {
+    int begin;
+    int end;
+};
+
+// Sorts spans and merges the overlapping or touching ones; returns the new count.
+int mergeSpans(Span *spans, int count) {
+    // insertion sort: there are never more than a handful
+    for (int i = 1; i < count; ++i) {
+        Span key = spans[i];
+        int j = i;
+        for (; j > 0 && spans[j - 1].begin > key.begin; --j) spans[j] = spans[j - 1];
+        spans[j] = key;
+    }
+    int merged = 0;
+    for (int i = 0; i < count; ++i) {
+        if (spans[i].begin >= spans[i].end) continue;
+        if (merged > 0 && spans[i].begin <= spans[merged - 1].end) {
+            spans[merged - 1].end = std::max(spans[merged - 1].end, spans[i].end);
+        } else {
+            spans[merged++] = spans[i];
+        }
+    }
+    return merged;
+}
+
+} // namespace
+
+extern "C" {
+
+kiss_fftr_simd_cfg kiss_fftr_simd_alloc(int nfft, int inverse_fft, void *mem, size_t *lenmem) {
+    if (nfft & 1) {
+        return nullptr;
+    }
+    const int ncfft = nfft / 2;
+    int radices[kMaxStages];
+    int numStages = ncfft >= kMinVectorSize && ncfft % kMinVectorSize == 0
+                    ? planStages(ncfft, radices) : -1;
+
+    const size_t header = alignFloats((sizeof(kiss_fftr_simd_state) + 3) / 4) * sizeof(float);
+    size_t memneeded;
+    size_t fallbackSize = 0;
+    size_t twiddleFloats = 0;
+    if (numStages < 0) {
+        kiss_fftr_alloc(nfft, inverse_fft, nullptr, &fallbackSize);
+        memneeded = header + sizeof(float) * alignFloats(nfft) + fallbackSize;
+    } else {
+        int n = ncfft;
+        for (int i = 0; i < numStages; ++i) {
+            twiddleFloats += alignFloats(2 * (radices[i] - 1) * (n / radices[i]));
+            n /= radices[i];
+        }
+        // the batch adds four lane-interleaved work buffers and 6 * ncfft first-pass twiddles
+        memneeded = header + sizeof(float) * (twiddleFloats + 6 * alignFloats(ncfft) + 22 * ncfft);
+    }
+
+    kiss_fftr_simd_cfg st = nullptr;
+    if (lenmem == nullptr) {
+        st = (kiss_fftr_simd_cfg) KISS_FFT_MALLOC(memneeded);
+    } else {
+        if (mem != nullptr && *lenmem >= memneeded) st = (kiss_fftr_simd_cfg) mem;
+        *lenmem = memneeded;
+    }
+    if (!st) return nullptr;
+
+    memset(st, 0, sizeof(*st));
+    st->nfft = nfft;
+    st->ncfft = ncfft;
+    st->inverse = inverse_fft;
+    char *cursor = (char *) st + header;
+
+    if (numStages < 0) {
+        st->fallbackScratch = (float *) cursor;
+        cursor += sizeof(float) * alignFloats(nfft);
+        st->fallback = kiss_fftr_alloc(nfft, inverse_fft, cursor, &fallbackSize);
+        return st;
+    }
+
+    float *f = (float *) cursor;
+    int n = ncfft;
+    int s = 1;
+    const double pi = 3.14159265358979323846;
+    st->numStages = numStages;
+    for (int i = 0; i < numStages; ++i) {
+        const int radix = radices[i];
+        const int m = n / radix;
+        for (int j = 1; j < radix; ++j) {
+            float *re = f + 2 * (j - 1) * m;
+            float *im = re + m;
+            for (int p = 0; p < m; ++p) {
+                double phase = -2.0 * pi * j * p / n;
+                re[p] = (float) cos(phase);
+                im[p] = (float) sin(phase);
+            }
+        }
+        st->stages[i] = {radix, n, s, f};
+        f += alignFloats(2 * (radix - 1) * m);
+        n = m;
+        s *= radix;
+    }
+
+    st->superRe = f;
+    st->superIm = f + alignFloats(ncfft);
+    for (int k = 0; k < ncfft; ++k) {
+        double phase = -pi * k / ncfft;
+        st->superRe[k] = (float) cos(phase);
+        st->superIm[k] = (float) sin(phase);
+    }
+    f += 2 * alignFloats(ncfft);
+    for (int i = 0; i < 4; ++i) {
+        st->work[i] = f;
+        f += alignFloats(ncfft);
+    }
+    for (int i = 0; i < 4; ++i) {
+        st->batch[i] = f;
+        f += 4 * ncfft;
+    }
+    st->batchTw = f;
+    if (st->stages[0].radix == 4) {
+        const int m = ncfft / 4;
+        const float *tw = st->stages[0].tw;
+        for (int p = 0; p < m; ++p) {
+            for (int row = 0; row < 6; ++row) {
+                for (int l = 0; l < 4; ++l) f[24 * p + 4 * row + l] = tw[row * m + p];
+            }
+        }
+    }
+    return st;
+}
+
+int kiss_fftr_simd_next_size(int n) {
+    int radices[kMaxStages];
+    int nfft = std::max(n + 31, 32) & ~31;
+    while (planStages(nfft / 2, radices) < 0) nfft += 32;
+    return nfft;
+}
+
+int kiss_fftr_simd_is_vectorized(kiss_fftr_simd_cfg st) {
+    return st->fallback == nullptr;
+}
+
+void kiss_fftr_simd(kiss_fftr_simd_cfg st, const kiss_fft_scalar *timedata, kiss_fft_cpx *freqdata) {
+    if (st->inverse) {
+        KISS_FFT_ERROR("kiss fft usage error: improper alloc");
+        return;
+    }
+    if (st->fallback) {
+        kiss_fftr(st->fallback, timedata, freqdata);
+        return;
+    }
+    const int M = st->ncfft;
+    float *zr = st->work[0], *zi = st->work[1];
+
+    // Pack even samples as re, odd samples as im of an M-point complex sequence
+    for (int n = 0; n < M; n += 4) {
+        vec4 even, odd;
+        simd::loadDeinterleave(timedata + 2 * n, even, odd);
+        simd::store(zr + n, even);
+        simd::store(zi + n, odd);
+    }
+
+    forwardFromPacked(st, freqdata);
+}
+
+void kiss_fftr_simd_windowed(kiss_fftr_simd_cfg st, const kiss_fft_scalar *first, int firstSize,
+                             const kiss_fft_scalar *second, const kiss_fft_scalar *window,
+                             kiss_fft_cpx *freqdata) {
+    if (st->inverse) {
+        KISS_FFT_ERROR("kiss fft usage error: improper alloc");
+        return;
+    }
+    if (st->fallback) {
+        float *x = st->fallbackScratch;
+        for (int n = 0; n < st->nfft; ++n) {
+            x[n] = (n < firstSize ? first[n] : second[n - firstSize]) * window[n];
+        }
+        kiss_fftr(st->fallback, x, freqdata);
+        return;
+    }
+    const int M = st->ncfft;
+    float *zr = st->work[0], *zi = st->work[1];
+
+    // The same pack, multiplying by the window on the way: groups of eight samples from
+    // the first span, the one group straddling the spans (if any), then the second span
+    const int straddle = std::min(firstSize, 2 * M) / 8 * 4;
+    auto pack = [&](const float *x, int n) {
+        vec4 even, odd, we, wo;
+        simd::loadDeinterleave(x, even, odd);
+        simd::loadDeinterleave(window + 2 * n, we, wo);
+        simd::store(zr + n, simd::mul(even, we));
+        simd::store(zi + n, simd::mul(odd, wo));
+    };
+    int n = 0;
+    for (; n < straddle; n += 4) {
+        pack(first + 2 * n, n);
+    }
+    if (n < M && 2 * n < firstSize) {
+        float x[8];
+        for (int j = 0; j < 8; ++j) {
+            x[j] = 2 * n + j < firstSize ? first[2 * n + j] : second[2 * n + j - firstSize];
+        }
+        pack(x, n);
+        n += 4;
+    }
+    for (; n < M; n += 4) {
+        pack(second + 2 * n - firstSize, n);
+    }
+
+    forwardFromPacked(st, freqdata);
+}
+
+void kiss_fftri_simd(kiss_fftr_simd_cfg st, const kiss_fft_cpx *freqdata, kiss_fft_scalar *timedata) {
+    if (!st->inverse) {
+        KISS_FFT_ERROR("kiss fft usage error: improper alloc");
+        return;
+    }
+    if (st->fallback) {
+        kiss_fftri(st->fallback, freqdata, timedata);
+        return;
+    }
+    const int M = st->ncfft;
+    const float *in = (const float *) freqdata;
+    inverseMergeEnds(st, in);
+    inverseMerge(st, in, 1, M);
+    inverseUnpack(complexForward(st), M, timedata);
+}
+
+void kiss_fftri_simd_pruned(kiss_fftr_simd_cfg st, const kiss_fft_cpx *freqdata, int firstBin, int endBin,
+                            kiss_fft_scalar *timedata) {
+    if (!st->inverse) {
+        KISS_FFT_ERROR("kiss fft usage error: improper alloc");
+        return;
+    }
+    if (st->fallback) {
+        kiss_fftri(st->fallback, freqdata, timedata);
+        return;
+    }
+    const int M = st->ncfft;
+    const float *in = (const float *) freqdata;
+    float *zr = st->work[0], *zi = st->work[1];
+    firstBin = std::max(firstBin, 0);
+    endBin = std::min(endBin, M + 1);
+    if (firstBin >= endBin) {
+        std::fill(timedata, timedata + 2 * M, 0.0f);
+        return;
+    }
+
+    // Z[k] for 0 < k < M reads X[k] and X[M-k], so it is nonzero only on the band and
+    // its mirror; the rest of Z is zero-filled instead of merged
+    Span band[2] = {
+            {std::max(firstBin, 1), std::min(endBin, M)},
+            {std::max(M - endBin + 1, 1), std::min(M - firstBin + 1, M)},
+    };
+    const int bandSpans = mergeSpans(band, 2);
+    int k = 1;
+    for (int i = 0; i < bandSpans; ++i) {
+        std::fill(zr + k, zr + band[i].begin, 0.0f);
+        std::fill(zi + k, zi + band[i].begin, 0.0f);
+        inverseMerge(st, in, band[i].begin, band[i].end);
+        k = band[i].end;
+    }
+    std::fill(zr + k, zr + M, 0.0f);
+    std::fill(zi + k, zi + M, 0.0f);
+    inverseMergeEnds(st, in);
+
+    // The first pass (radix 4, stride 1) reads Z[p + j m], j < 4: butterflies whose four
+    // inputs all fall outside those spans write zeros instead. Live butterflies are
+    // rounded out to the kernel's groups of four.
+    const Stage &first = st->stages[0];
+    const int m = first.n / 4;
+    Span live[9];
+    int count = 0;
+    if (firstBin == 0 || endBin > M) live[count++] = {0, 4};
+    for (int j = 0; j < 4; ++j) {
+        for (int i = 0; i < bandSpans; ++i) {
+            const int begin = std::max(band[i].begin - j * m, 0);
+            const int end = std::min(band[i].end - j * m, m);
+            if (begin < end) live[count++] = {begin & ~3, std::min((end + 3) & ~3, m)};
+        }
+    }
+    count = mergeSpans(live, count);
+    if (count == 1 && live[0].begin == 0 && live[0].end == m) {
+        // wide band: nothing to skip, take the plain kernels
+        inverseUnpack(complexForward(st), M, timedata);
+        return;
+    }
+
+    float *yr = st->work[2], *yi = st->work[3];
+    int p = 0;
+    for (int i = 0; i < count; ++i) {
+        std::fill(yr + 4 * p, yr + 4 * live[i].begin, 0.0f);
+        std::fill(yi + 4 * p, yi + 4 * live[i].begin, 0.0f);
+        radix4VectorP(first, zr, zi, yr, yi, live[i].begin, live[i].end);
+        p = live[i].end;
+    }
+    std::fill(yr + 4 * p, yr + 4 * m, 0.0f);
+    std::fill(yi + 4 * p, yi + 4 * m, 0.0f);
+
+    inverseUnpack(complexForward(st, 1), M, timedata);
+}
+
+void kiss_fftr_simd_x4(kiss_fftr_simd_cfg st, const kiss_fft_scalar *const timedata[4],
+                       kiss_fft_cpx *const freqdata[4]) {
+    if (st->inverse) {
+        KISS_FFT_ERROR("kiss fft usage error: improper alloc");
+        return;
+    }
+    if (st->fallback) {
+        for (int l = 0; l < 4; ++l) kiss_fftr(st->fallback, timedata[l], freqdata[l]);
+        return;
+    }
+    const int M = st->ncfft;
+    float *zr = st->batch[0], *zi = st->batch[1];
+
+    // Even/odd split as in kiss_fftr_simd, then transpose four elements of each
+    // transform into four lane-interleaved elements
+    for (int n = 0; n < M; n += 4) {
+        vec4 e[4], o[4];
+        for (int l = 0; l < 4; ++l) simd::loadDeinterleave(timedata[l] + 2 * n, e[l], o[l]);
+        simd::transpose(e[0], e[1], e[2], e[3]);
+        simd::transpose(o[0], o[1], o[2], o[3]);
+        for (int j = 0; j < 4; ++j) {
+            simd::store(zr + 4 * (n + j), e[j]);
+            simd::store(zi + 4 * (n + j), o[j]);
+        }
+    }
+
+    float *const *z = complexForwardX4(st);
+    zr = z[0];
+    zi = z[1];
+
+    float *out[4];
+    for (int l = 0; l < 4; ++l) {
+        out[l] = (float *) freqdata[l];
+        out[l][0] = zr[l] + zi[l];
+        out[l][1] = 0.0f;
+        out[l][2 * M] = zr[l] - zi[l];
+        out[l][2 * M + 1] = 0.0f;
+    }
+
+    // Same merge as the single transform, with the lanes being transforms: four bins
+    // at a time, then transposed back to each transform's own bins
+    const vec4 half = simd::set1(0.5f);
+    int k = 1;
+    for (; k + 3 <= M - 1; k += 4) {
+        vec4 xr[4], xi[4];
+        for (int j = 0; j < 4; ++j) {
+            const int kk = k + j;
+            vec4 ar = simd::load(zr + 4 * kk), ai = simd::load(zi + 4 * kk);
+            vec4 br = simd::load(zr + 4 * (M - kk)), bi = simd::load(zi + 4 * (M - kk));
+            vec4 evenR = simd::mul(half, simd::add(ar, br));
+            vec4 evenI = simd::mul(half, simd::sub(ai, bi));
+            vec4 oddR = simd::mul(half, simd::add(ai, bi));
+            vec4 oddI = simd::mul(half, simd::sub(br, ar));
+            vec4 tr, ti;
+            cmul(oddR, oddI, simd::set1(st->superRe[kk]), simd::set1(st->superIm[kk]), tr, ti);
+            xr[j] = simd::add(evenR, tr);
+            xi[j] = simd::add(evenI, ti);
+        }
+        simd::transpose(xr[0], xr[1], xr[2], xr[3]);
+        simd::transpose(xi[0], xi[1], xi[2], xi[3]);
+        for (int l = 0; l < 4; ++l) simd::storeInterleave(out[l] + 2 * k, xr[l], xi[l]);
+    }
+    for (; k < M; ++k) {
+        for (int l = 0; l < 4; ++l) {
+            float ar = zr[4 * k + l], ai = zi[4 * k + l];
+            float br = zr[4 * (M - k) + l], bi = zi[4 * (M - k) + l];
+            float tr, ti;
+            cmul(0.5f * (ai + bi), 0.5f * (br - ar), st->superRe[k], st->superIm[k], tr, ti);
+            out[l][2 * k] = 0.5f * (ar + br) + tr;
+            out[l][2 * k + 1] = 0.5f * (ai - bi) + ti;
+        }
+    }
+}
+
+void kiss_fftri_simd_x4(kiss_fftr_simd_cfg st, const kiss_fft_cpx *const freqdata[4],
+                        kiss_fft_scalar *const timedata[4]) {
+    if (!st->inverse) {
+        KISS_FFT_ERROR("kiss fft usage error: improper alloc");
+        return;
+    }
+    if (st->fallback) {
+        for (int l = 0; l < 4; ++l) kiss_fftri(st->fallback, freqdata[l], timedata[l]);
+        return;
+    }
+    const int M = st->ncfft;
+    const float *in[4];
+    float *zr = st->batch[0], *zi = st->batch[1];
+    for (int l = 0; l < 4; ++l) {
+        in[l] = (const float *) freqdata[l];
+        float ar = in[l][0], ai = in[l][1], br = in[l][2 * M], bi = in[l][2 * M + 1];
+        zr[l] = (ar + br) - (ai + bi);
+        zi[l] = -((ai - bi) + (ar - br));
+    }
+
+    // Gather four bins of each transform and transpose them into lanes, then the same
+    // pre-twiddle as kiss_fftri_simd
+    int k = 1;
+    for (; k + 3 <= M - 1; k += 4) {
+        vec4 ar[4], ai[4], br[4], bi[4];
+        for (int l = 0; l < 4; ++l) {
+            simd::loadDeinterleave(in[l] + 2 * k, ar[l], ai[l]);
+            simd::loadDeinterleave(in[l] + 2 * (M - k - 3), br[l], bi[l]);
+            br[l] = simd::reverse(br[l]);
+            bi[l] = simd::reverse(bi[l]);
+        }
+        simd::transpose(ar[0], ar[1], ar[2], ar[3]);
+        simd::transpose(ai[0], ai[1], ai[2], ai[3]);
+        simd::transpose(br[0], br[1], br[2], br[3]);
+        simd::transpose(bi[0], bi[1], bi[2], bi[3]);
+        for (int j = 0; j < 4; ++j) {
+            const int kk = k + j;
+            vec4 er = simd::add(ar[j], br[j]), ei = simd::sub(ai[j], bi[j]);
+            vec4 dr = simd::sub(ar[j], br[j]), di = simd::add(ai[j], bi[j]);
+            vec4 fr, fi;
+            cmul(dr, di, simd::set1(st->superRe[kk]), simd::set1(-st->superIm[kk]), fr, fi);
+            simd::store(zr + 4 * kk, simd::sub(er, fi));
+            simd::store(zi + 4 * kk, simd::neg(simd::add(ei, fr)));
+        }
+    }
+    for (; k < M; ++k) {
+        for (int l = 0; l < 4; ++l) {
+            float ar = in[l][2 * k], ai = in[l][2 * k + 1];
+            float br = in[l][2 * (M - k)], bi = in[l][2 * (M - k) + 1];
+            float fr, fi;
+            cmul(ar - br, ai + bi, st->superRe[k], -st->superIm[k], fr, fi);
+            zr[4 * k + l] = (ar + br) - fi;
+            zi[4 * k + l] = -((ai - bi) + fr);
+        }
+    }
+
+    float *const *z = complexForwardX4(st);
+    zr = z[0];
+    zi = z[1];
+
+    for (int n = 0; n < M; n += 4) {
+        vec4 r[4], i[4];
+        for (int j = 0; j < 4; ++j) {
+            r[j] = simd::load(zr + 4 * (n + j));
+            i[j] = simd::load(zi + 4 * (n + j));
+        }
+        simd::transpose(r[0], r[1], r[2], r[3]);
+        simd::transpose(i[0], i[1], i[2], i[3]);
+        for (int l = 0; l < 4; ++l) {
+            simd::storeInterleave(timedata[l] + 2 * n, r[l], simd::neg(i[l]));
+        }
+    }
+}
+
+} // extern "C"
@@ -0,0 +1,76 @@
+#ifndef KISS_FFTR_SIMD_H
+#define KISS_FFTR_SIMD_H
+
+#include "kiss_fftr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ Drop-in replacement for kiss_fftr with intrinsic-based kernels (NEON on ARM, SSE2 on x86).
+
+ Same calling conventions as kiss_fftr.h: same input/output layout and scaling
+ (neither direction normalizes), same mem/lenmem contract, and the cfg is one
+ contiguous block that can be released with kiss_fftr_simd_free.
+
+ The real transform is a complex FFT of nfft/2 points on split re/im arrays using
+ Stockham autosort passes of radix 4, 3 and 5 (plus one radix-2 pass when needed),
+ wrapped by vectorized even/odd split and real-to-complex merge loops. The vector
+ kernels cover nfft = 32 * 2^a * 3^b * 5^c, so sizes such as twice a 96, 240 or 480
+ frame burst run about as fast per sample as the powers of two. Other sizes
+ transparently fall back to the scalar kiss_fftr.
+ */
+
+typedef struct kiss_fftr_simd_state *kiss_fftr_simd_cfg;
+
+kiss_fftr_simd_cfg KISS_FFT_API kiss_fftr_simd_alloc(int nfft, int inverse_fft, void *mem, size_t *lenmem);
+
+void KISS_FFT_API kiss_fftr_simd(kiss_fftr_simd_cfg cfg, const kiss_fft_scalar *timedata, kiss_fft_cpx *freqdata);
+
+void KISS_FFT_API kiss_fftri_simd(kiss_fftr_simd_cfg cfg, const kiss_fft_cpx *freqdata, kiss_fft_scalar *timedata);
+
+/*
+ Forward transform of (first[0..firstSize) ++ second) * window without a staging copy:
+ the window multiply rides on the even/odd pack. For reading a frame straight out of
+ the two contiguous spans of a ring buffer; second may be null when firstSize == nfft.
+ */
+void KISS_FFT_API kiss_fftr_simd_windowed(kiss_fftr_simd_cfg cfg, const kiss_fft_scalar *first, int firstSize,
+                                          const kiss_fft_scalar *second, const kiss_fft_scalar *window,
+                                          kiss_fft_cpx *freqdata);
+
+/*
+ Inverse transform of a spectrum known to be zero outside bins [firstBin, endBin), such
+ as one masked to a pass band (the zeros must be there). The real-spectrum split runs only
+ on the band and its mirror, and first-pass butterflies whose inputs are all zero are
+ skipped, so the cost falls with the bandwidth (mostly below a quarter of Nyquist).
+ */
+void KISS_FFT_API kiss_fftri_simd_pruned(kiss_fftr_simd_cfg cfg, const kiss_fft_cpx *freqdata, int firstBin,
+                                         int endBin, kiss_fft_scalar *timedata);
+
+/*
+ Four transforms of the same size and direction in one call. The transforms are
+ interleaved lane by lane through the complex passes (the layout of kiss_fft's USE_SIMD
+ build), so every pass runs fully vectorized. That beats four single calls only for small
+ sizes (up to 128 points with SSE2); above that the lane shuffles cost more. Any of
+ the pointers may repeat when fewer than four transforms are pending, but an output
+ must not alias an input. Scalar-fallback cfgs loop over the single transform.
+ */
+void KISS_FFT_API kiss_fftr_simd_x4(kiss_fftr_simd_cfg cfg, const kiss_fft_scalar *const timedata[4],
+                                    kiss_fft_cpx *const freqdata[4]);
+
+void KISS_FFT_API kiss_fftri_simd_x4(kiss_fftr_simd_cfg cfg, const kiss_fft_cpx *const freqdata[4],
+                                     kiss_fft_scalar *const timedata[4]);
+
+/* smallest nfft >= n that runs the vector kernels */
+int KISS_FFT_API kiss_fftr_simd_next_size(int n);
+
+/* nonzero when cfg runs the vector kernels rather than the scalar fallback */
+int KISS_FFT_API kiss_fftr_simd_is_vectorized(kiss_fftr_simd_cfg cfg);
+
+#define kiss_fftr_simd_free KISS_FFT_FREE
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -1,56 +1,232 @@
 #include <jni.h>
 #include <oboe/Oboe.h>
 #include <android/log.h>
+#include <semaphore.h>
+#include <atomic>
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstring>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 
-#include "kiss_fft.h"
-#include "kiss_fftr.h"
+#include "AsyncProcessor.h"
+#include "BiquadCascade.h"
+#include "CallbackStats.h"
+#include "DriftCompensator.h"
+#include "DspArena.h"
+#include "FirDesign.h"
+#include "FixedSpectralProcessor.h"
+#include "Interleave.h"
+#include "LoadGovernor.h"
+#include "NonUniformConvolver.h"
+#include "PolyphaseResampler.h"
+#include "ProcessorChain.h"
+#include "SampleConverter.h"
+#include "SpectralPath.h"
 
 #define TAG "OboeNative"
 #define LOGI(...) __android_log_print(ANDROID_LOG_INFO, TAG, __VA_ARGS__)
 
+enum class ProcessingMode : int32_t {
+    Spectral = 0,       // SpectralProcessor STFT chain, one FFT frame of delay
+    Convolution = 1,    // partitioned FIR (long tails on a worker thread), one burst of delay
+    Iir = 2,            // biquad cascade on the callback buffer, no block delay
+};
+
+// Time-domain stages over the engine's processors (see ProcessorChain.h)
+struct SpectralStage {
+    SpectralPath *path;
+    void process(const float *input, float *output, int32_t numFrames) {
+        path->process(input, numFrames, output, numFrames);
+    }
+};
+
+// Channels the engine opens at most; SpectralPath takes up to SpectralProcessor::kMaxChannels
+constexpr int32_t kMaxChannels = 4;
+
+// A mono processor per channel over interleaved frames: deinterleaved into planar scratch,
+// processed out of place, interleaved back. One channel runs straight through.
+template <typename Processor>
+struct PerChannelStage {
+    Processor *processors;              // one per channel
+    const int32_t *channels;            // the engine's count, as of start()
+    float *const *planarIn;             // kMaxChannels buffers of kMaxCallbackFrames
+    float *const *planarOut;
+    void process(const float *input, float *output, int32_t numFrames) {
+        const int32_t count = *channels;
+        if (count == 1) {
+            processors[0].process(input, output, numFrames);
+            return;
+        }
+        Interleave::toPlanar(input, count, numFrames, planarIn);
+        for (int32_t c = 0; c < count; ++c) {
+            processors[c].process(planarIn[c], planarOut[c], numFrames);
+        }
+        Interleave::fromPlanar(planarOut, count, numFrames, output);
+    }
+};
+
+using ConvolutionStage = PerChannelStage<NonUniformConvolver>;
+using IirStage = PerChannelStage<BiquadCascade>;
+
+// The converter format for a stream's device format
+static SampleConverter::Format converterFormat(oboe::AudioFormat format) {
+    switch (format) {
+        case oboe::AudioFormat::I16:
+            return SampleConverter::Format::I16;
+        case oboe::AudioFormat::I24:
+            return SampleConverter::Format::I24;
+        case oboe::AudioFormat::I32:
+            return SampleConverter::Format::I32;
+        default:
+            return SampleConverter::Format::Float;
+    }
+}
+
+// One prebuilt chain per ProcessingMode, in enum order; each is a single stage for now.
+// Only same-length float stages fit a TimeChain, so the drift read, the resamplers and the
+// format converters around the chain stay outside it, as do the fixed-point path's int16
+// stages. The multi-stage composition today is SpectralProcessor's per-frame FrameChain.
+using EngineChains = chain::ChainSet<chain::TimeChain<SpectralStage>,
+                                     chain::TimeChain<ConvolutionStage>,
+                                     chain::TimeChain<IirStage>>;
+
 class MicPassthrough : public oboe::AudioStreamCallback {
 public:
     MicPassthrough(int32_t bufferSize, int32_t sampleRate) :
-            mBufferSize(bufferSize),
             mSampleRate(sampleRate) {
-        mWindow.resize(mBufferSize);
-        for (int i = 0; i < mBufferSize; ++i) {
-            mWindow[i] = 0.5f - 0.5f * cosf(2.0f * M_PI * i / (mBufferSize - 1));
+        // Callback buffers for the largest callback at the most channels, sized once
+        constexpr int32_t kMaxSamples = kMaxCallbackFrames * kMaxChannels;
+        mArena.build([this](DspArena &arena) {
+            mMicBuffer = arena.take<float>(kMaxSamples);
+            mInputReadBuffer = arena.take<float>(kMaxSamples);
+            mMicRaw = arena.take<uint8_t>(kMaxSamples * sizeof(int32_t));
+            mFloatOutput = arena.take<float>(kMaxSamples);
+            mMicResampled = arena.take<float>(kMaxSamples);
+            mCoreOutput = arena.take<float>(kMaxSamples);
+            mFixedInput = arena.take<int16_t>(kMaxCallbackFrames);
+            mFixedOutput = arena.take<int16_t>(kMaxCallbackFrames);
+            for (int32_t c = 0; c < kMaxChannels; ++c) {
+                mPlanarIn[c] = arena.take<float>(kMaxCallbackFrames);
+                mPlanarOut[c] = arena.take<float>(kMaxCallbackFrames);
+            }
+        });
+        mSpectralConfig.fftSize = bufferSize;
+        for (auto &iir : mIirs) {
+            iir.configure(mSampleRate);
+            iir.setSections(BiquadCascade::bandLimit(125.0f, 18000.0f));
         }
-        mWindowedInput.resize(mBufferSize);
-        mFftOutput.resize(mBufferSize / 2 + 1);
-        mFftCfg = kiss_fftr_alloc(mBufferSize, 0, nullptr, nullptr);
-        mIfftCfg = kiss_fftr_alloc(mBufferSize, 1, nullptr, nullptr);
-        mConversionBuffer.resize(mBufferSize);
-
-        mOverlapBuffer.resize(mBufferSize / 2, 0.0f);
+        sem_init(&mLadderWake, 0, 0);
     }
 
     ~MicPassthrough() {
         stop();
-        kiss_fftr_free(mFftCfg);
-        kiss_fftr_free(mIfftCfg);
+        sem_destroy(&mLadderWake);
+    }
+
+    void setProcessingMode(ProcessingMode mode) {
+        mProcessingMode.store(mode, std::memory_order_relaxed);
+    }
+
+    // Custom FIR for Convolution mode (e.g. a room/ear-canal correction of up to 32k taps);
+    // empty restores the default band-pass. Applied on start().
+    void setFilterCoefficients(std::vector<float> taps) {
+        mFilterTaps = std::move(taps);
+    }
+
+    // Per-user prescription for the Spectral path; rebuilt here, picked up by the next frame.
+    void setGainCurve(std::vector<SpectralGainTable::GainPoint> points) {
+        std::lock_guard<std::mutex> lock(mSpectralMutex);
+        mGainCurve = points;
+        if (mFixedSpectral) mFixedSpectral->setGainCurve(points);
+        mSpectral.setGainCurve(std::move(points));
+    }
+
+    // WDRC on the Spectral path, one entry per band (up to 16); empty disables it.
+    void setCompressorBands(const std::vector<MultibandCompressor::BandParams> &bands) {
+        std::lock_guard<std::mutex> lock(mSpectralMutex);
+        mSpectral.setCompressorBands(bands);
+        publishLadderRungs();
+    }
+
+    // Sections for Iir mode; empty restores the default 125-18000 Hz band limit. Takes effect
+    // at the next callback.
+    void setIirSections(const std::vector<BiquadCascade::Section> &sections) {
+        for (auto &iir : mIirs) {
+            iir.setSections(sections.empty() ? BiquadCascade::bandLimit(125.0f, 18000.0f)
+                                             : sections);
+        }
+    }
+
+    // FFT size, overlap and window for the Spectral path. With autoFftSize the size is picked
+    // against the device burst on start(). While running, the new processor is built here
+    // and crossfaded in by the audio thread.
+    void setSpectralConfig(const SpectralProcessor::Config &config, bool autoFftSize) {
+        std::lock_guard<std::mutex> lock(mSpectralMutex);
+        mSpectralConfig = config;
+        mAutoFftSize = autoFftSize;
+        if (mOutputStream) {
+            chooseSpectralConfig();
+            applySpectralConfig();
+        }
+    }
+
+    // Sheds Spectral-path stages when callbacks run close to the deadline (see LoadGovernor),
+    // or with the async worker, when its rendering does. On by default. Applied on start().
+    void setLoadGovernor(bool enabled) {
+        mGovernorEnabled = enabled;
+    }
+
+    // Extra output latency (ms) for running the processing chain on a worker thread, so the
+    // callback only moves samples between rings; rounded up to whole bursts. 0 keeps the
+    // chain on the callback thread. Applied on start().
+    void setAsyncLatency(float extraLatencyMs) {
+        mAsyncLatencyMs = std::max(extraLatencyMs, 0.0f);
+    }
+
+    // int16 streams, with Spectral mode run by FixedSpectralProcessor (gain curve only, no
+    // compressor) and the other modes converting at the stream edges. No async worker or
+    // load governor; the spectral config is taken as of start(). Applied on start().
+    void setFixedPoint(bool enabled) {
+        mFixedPointRequested = enabled;
+    }
+
+    // Channels to open both streams with (1..kMaxChannels), each processed independently.
+    // Falls back to mono when a device won't open the count, with fixed point, or with
+    // the async worker. Applied on start().
+    void setChannelCount(int32_t channels) {
+        mRequestedChannels = std::max(1, std::min(channels, kMaxChannels));
     }
 
     void start() {
         stop();
 
-        mInputRingBuffer.resize(mBufferSize * 2, 0.0f);
-        mRingWriteIndex = mRingReadIndex = mRingSize = 0;
-        mOutputFIFO.clear();
-        mOutputFIFO.reserve(mBufferSize * 8);  // avoid reallocation
-        mInputReadBuffer.resize(std::max<int32_t>(mFramesPerBurst, 256));
+        mSpectral.reset();
+        mSpectral.setBypass(false);
+        mLadderLevel.store(0, std::memory_order_relaxed);
+        mStats.requestReset();
+        // Whatever the device's fast path uses (SampleConverter converts at the edges);
+        // the fixed-point variant asks for int16
+        mFixedPoint = mFixedPointRequested;
+        const oboe::AudioFormat format = mFixedPoint ? oboe::AudioFormat::I16
+                                                     : oboe::AudioFormat::Unspecified;
+        mChannelCount = mFixedPoint || mAsyncLatencyMs > 0.0f ? 1 : mRequestedChannels;
+        if (mChannelCount != mRequestedChannels) {
+            LOGI("%d channels not supported with fixed point or async DSP, running mono",
+                 mRequestedChannels);
+        }
 
+        // Both streams at the device's native rate, so neither is converted behind our back;
+        // PolyphaseResampler bridges each to the core rate the DSP runs at
         oboe::AudioStreamBuilder inBuilder;
         inBuilder.setDirection(oboe::Direction::Input)
                 ->setPerformanceMode(oboe::PerformanceMode::LowLatency)
                 ->setSharingMode(oboe::SharingMode::Exclusive)
-                ->setFormat(oboe::AudioFormat::Float)
-                ->setChannelCount(oboe::ChannelCount::Mono)
-                ->setSampleRate(mSampleRate) // device chooses sample rate
+                ->setFormat(format)
+                ->setChannelCount(mChannelCount)
                 ->setCallback(nullptr);
 
         oboe::Result r = inBuilder.openStream(mInputStream);
@@ -58,20 +234,16 @@ public:
             LOGI("Failed to open input: %s", oboe::convertToText(r));
             return;
         }
+        if (!opensChannelCount(*mInputStream, "Input")) return;
+        mInputConverter.configure(converterFormat(mInputStream->getFormat()), false);
 
-        // Align our internal rate to the real device rate
-        mSampleRate = mInputStream->getSampleRate();
-        mFramesPerBurst = mInputStream->getFramesPerBurst();
-
-        // 2) Open OUTPUT stream (with callback = this)
+        // 2) Open OUTPUT stream (with callback = this); callbacks follow its own burst
         oboe::AudioStreamBuilder outBuilder;
         outBuilder.setDirection(oboe::Direction::Output)
                 ->setPerformanceMode(oboe::PerformanceMode::LowLatency)
                 ->setSharingMode(oboe::SharingMode::Exclusive)
-                ->setFormat(oboe::AudioFormat::Float)
-                ->setChannelCount(oboe::ChannelCount::Mono)
-                ->setSampleRate(mSampleRate)
-                ->setFramesPerDataCallback(mFramesPerBurst) // helps alignment
+                ->setFormat(format)
+                ->setChannelCount(mChannelCount)
                 ->setCallback(this);
 
         r = outBuilder.openStream(mOutputStream);
@@ -79,18 +251,103 @@ public:
             LOGI("Failed to open output: %s", oboe::convertToText(r));
             return;
         }
+        if (!opensChannelCount(*mOutputStream, "Output")) return;
+        mOutputConverter.configure(converterFormat(mOutputStream->getFormat()), true);
+        mFixedConverter.configure(SampleConverter::Format::I16, true);
+
+        // Mic audio is pushed through as it arrives; speaker audio is pulled, one callback
+        // of core frames per callback of device frames
+        mInputResampler.configure(mInputStream->getSampleRate(), mSampleRate, kMaxCallbackFrames,
+                                  mChannelCount);
+        mOutputResampler.configure(mSampleRate, mOutputStream->getSampleRate(), kMaxCallbackFrames,
+                                   mChannelCount);
+        mMicReadFrames = std::min(kMaxCallbackFrames, mInputResampler.maxInputFor(kMaxCallbackFrames));
+        // The output burst in core frames
+        mFramesPerBurst = (int32_t) std::lround((double) mOutputStream->getFramesPerBurst() *
+                                                mSampleRate / mOutputStream->getSampleRate());
+        {
+            std::lock_guard<std::mutex> lock(mSpectralMutex);
+            mSpectral.setChannelCount(mChannelCount);
+            chooseSpectralConfig();
+            applySpectralConfig();
+            mFixedSpectral.reset();
+            if (mFixedPoint) {
+                mFixedSpectral = std::make_unique<FixedSpectralProcessor>(mFullSpectralConfig,
+                                                                          mSampleRate);
+                mFixedSpectral->setGainCurve(mGainCurve);
+                LOGI("Fixed-point spectral path: %d headroom bits",
+                     mFixedSpectral->getHeadroomBits());
+            }
+        }
+        mGovernor.configure(mSampleRate);
+        mGovernorRungs = ~0u;
+        publishQuality();
+        if (mGovernorEnabled && !mFixedPoint) {
+            mLadderRunning.store(true, std::memory_order_release);
+            mLadderThread = std::thread(&MicPassthrough::ladderLoop, this);
+        }
+        for (auto &iir : mIirs) {
+            iir.configure(mSampleRate);
+            iir.reset();
+        }
+
+        // Partitions follow the burst so Convolution mode adds one burst of delay. Only the
+        // channels in use are configured, since each convolver runs its own tail worker; the
+        // rest are released, so a lower count doesn't leave workers and tails behind.
+        int32_t partitionSize = mFramesPerBurst > 0 ? mFramesPerBurst : 192;
+        std::vector<float> taps = mFilterTaps;
+        if (taps.empty()) {
+            taps = FirDesign::bandPass(125.0f, 18000.0f, mSampleRate, kDefaultFirTaps);
+        }
+        for (int32_t c = 0; c < kMaxChannels; ++c) {
+            if (c < mChannelCount) {
+                mConvolvers[c].configure(partitionSize, taps.data(), (int32_t) taps.size());
+            } else {
+                mConvolvers[c].release();
+            }
+        }
+
+        if (mAsyncLatencyMs > 0.0f && !mFixedPoint) {
+            const int32_t burst = std::max<int32_t>(mFramesPerBurst, 48);
+            const int32_t bursts = std::max<int32_t>(
+                    (int32_t) std::ceil(mAsyncLatencyMs * 0.001f * mSampleRate / burst), 1);
+            mChainLatency.store(0, std::memory_order_relaxed);
+            mAsync.start([this](const float *input, float *output, int32_t numFrames) {
+                             renderChain(input, output, numFrames);
+                         }, kMaxCallbackFrames, bursts * burst, kMaxChainLatency);
+            LOGI("Async DSP worker: +%d frames", mAsync.getLatencyFrames());
+        }
+
+        // The two streams run on separate clocks; hold two bursts of mic audio between them
+        mDrift.configure(mSampleRate, 2 * std::max<int32_t>(mFramesPerBurst, 48), kMaxCallbackFrames,
+                         mChannelCount);
+        mDriftUnderruns = 0;
 
         // 3) Start streams: input first, then output
         mInputStream->requestStart();
         mOutputStream->requestStart();
 
-        // 4) Prep helper buffers
-        mInputReadBuffer.resize(std::max<int32_t>(mFramesPerBurst, 256));
-        mOutputFIFO.clear();
+        LOGI("Duplex (two-stream) passthrough started at %d Hz, %d ch, burst=%d, formats in=%s out=%s",
+             mSampleRate, mChannelCount, mFramesPerBurst, oboe::convertToText(mInputStream->getFormat()),
+             oboe::convertToText(mOutputStream->getFormat()));
+        LOGI("Device rates in=%d out=%d Hz, resampler delay %.1f + %.1f core frames",
+             mInputStream->getSampleRate(), mOutputStream->getSampleRate(),
+             mInputResampler.getLatencyFrames() * mSampleRate / mInputStream->getSampleRate(),
+             mOutputResampler.getLatencyFrames());
+    }
 
-        LOGI("Duplex (two-stream) passthrough started at %d Hz, burst=%d",
-             mSampleRate, mFramesPerBurst);
+    // Control thread. Callers serialize through getCallbackStats() below.
+    const CallbackStats::Snapshot &readStats() { return mStats.read(); }
+    void resetStats() { mStats.requestReset(); }
+    // Over every convolver, so the channel count start() may be changing isn't read here;
+    // released ones count zero.
+    int64_t getTailDeadlineMisses() const {
+        int64_t misses = 0;
+        for (const auto &convolver : mConvolvers) misses += convolver.getDeadlineMisses();
+        return misses;
     }
+    int64_t getWorkerDeadlineMisses() const { return mAsync.getDeadlineMisses(); }
+    int32_t getSampleRate() const { return mSampleRate; }
 
     void stop() {
         if (mInputStream) {
@@ -103,141 +360,550 @@ public:
             mOutputStream->close();
             mOutputStream.reset();
         }
+        mAsync.stop();
+        if (mLadderThread.joinable()) {
+            mLadderRunning.store(false, std::memory_order_release);
+            sem_post(&mLadderWake);
+            mLadderThread.join();
+        }
         LOGI("Passthrough stopped");
     }
 
     oboe::DataCallbackResult onAudioReady(
             oboe::AudioStream *stream, void *audioData, int32_t numFrames) override {
 
-        float *out = static_cast<float*>(audioData);
+        mStats.beginCallback();
 
-        // 1) Read mic (non-blocking)
-        if (mInputReadBuffer.size() < (size_t)numFrames) {
-            mInputReadBuffer.resize(numFrames);
+        // Core-rate frames behind this callback's device frames
+        const int32_t coreFrames = mOutputResampler.inputFramesFor(numFrames);
+        if (numFrames > kMaxCallbackFrames || coreFrames > kMaxCallbackFrames) {
+            std::memset(audioData, 0, (size_t) numFrames * stream->getBytesPerFrame());
+            mStats.endCallback(numFrames);
+            return oboe::DataCallbackResult::Continue;
         }
-        int32_t framesRead = 0;
+
+        // 1) Drain whatever the mic has (non-blocking) into the drift compensator, in float
+        // at the core rate whatever the device format and rate (a float stream reads
+        // straight into mMicBuffer)
         if (mInputStream) {
-            auto res = mInputStream->read(mInputReadBuffer.data(), numFrames, 0);
+            const bool isFloat = mInputConverter.getFormat() == SampleConverter::Format::Float;
+            void *raw = isFloat ? static_cast<void *>(mMicBuffer) : mMicRaw;
+            auto res = mInputStream->read(raw, mMicReadFrames, 0);
             if (res) {
-                framesRead = res.value();
-            } else {
-                framesRead = 0;
-                // avoid logging every callback
+                mInputConverter.toFloat(raw, mMicBuffer, res.value() * mChannelCount);
+                if (mInputResampler.isPassthrough()) {
+                    mDrift.write(mMicBuffer, res.value());
+                } else {
+                    const int32_t frames = mInputResampler.process(mMicBuffer, res.value(),
+                                                                   mMicResampled, kMaxCallbackFrames);
+                    mDrift.write(mMicResampled, frames);
+                }
             }
+            // avoid logging every callback
         }
 
-        // 2) Write mic samples into ring buffer (real-time safe, O(1) per sample)
-        for (int i = 0; i < framesRead; ++i) {
-            mInputRingBuffer[mRingWriteIndex] = mInputReadBuffer[i];
-            mRingWriteIndex = (mRingWriteIndex + 1) % mInputRingBuffer.size();
+        // 2) Take exactly one callback of core-rate mic audio, resampled onto the output
+        // clock (silence while it first fills to its target isn't counted)
+        mDrift.read(mInputReadBuffer, coreFrames);
+        if (mDrift.getUnderruns() != mDriftUnderruns) {
+            mDriftUnderruns = mDrift.getUnderruns();
+            mStats.addShortRead();
+        }
+        mStats.noteDrift(mDrift.getCorrectionPpm(), mDrift.getFillFrames(), mDrift.getSlips());
+        mStats.noteLatency(mDrift.getTargetFrames(), mDrift.getMarginFrames(), mDrift.getDrops());
+
+        if (mFixedPoint) {
+            renderFixed(mProcessingMode.load(std::memory_order_relaxed), audioData, coreFrames,
+                        numFrames);
+            mStats.endCallback(coreFrames);
+            return oboe::DataCallbackResult::Continue;
+        }
 
-            if (mRingSize < (int)mInputRingBuffer.size()) {
-                ++mRingSize;
-            } else {
-                // Overrun: advance read pointer to avoid overwriting unread data
-                mRingReadIndex = (mRingReadIndex + 1) % mInputRingBuffer.size();
-            }
+        // Float output streams at the core rate are rendered in place, the others
+        // resampled and converted after
+        float *out = mCoreOutput;
+        if (mOutputResampler.isPassthrough()) {
+            const bool isFloat = mOutputConverter.getFormat() == SampleConverter::Format::Float;
+            out = isFloat ? static_cast<float *>(audioData) : mFloatOutput;
+        }
+        if (mAsync.isRunning()) {
+            // The chain runs on the worker; a late callback's worth plays dry
+            mAsync.setDryDelay(mChainLatency.load(std::memory_order_relaxed));
+            mAsync.process(mInputReadBuffer, out, coreFrames);
+            writeOutput(out, audioData, coreFrames, numFrames);
+            noteQuality();
+            mStats.endCallback(coreFrames);
+            return oboe::DataCallbackResult::Continue;
         }
 
-        // 3) Process full blocks while available (50% overlap)
-        const int hop = mBufferSize / 2;
-        while (mRingSize >= mBufferSize) {
-            // copy block from ring to window buffer
-            for (int n = 0; n < mBufferSize; ++n) {
-                int idx = (mRingReadIndex + n) % mInputRingBuffer.size();
-                mWindowedInput[n] = mInputRingBuffer[idx] * mWindow[n]; // window here
-            }
+        ProcessingMode mode = mProcessingMode.load(std::memory_order_relaxed);
+        render(mode, mInputReadBuffer, out, coreFrames);
+        writeOutput(out, audioData, coreFrames, numFrames);
+        if (mode == ProcessingMode::Spectral) {
+            noteSpectralFlow(mSpectral.getLastFlow());
+        }
+        noteQuality();
 
-            // FFT
-            kiss_fftr(mFftCfg, mWindowedInput.data(), mFftOutput.data());
+        int64_t callbackNs = mStats.endCallback(coreFrames);
+        if (mode == ProcessingMode::Spectral && mLadderThread.joinable()) {
+            updateGovernor(callbackNs, coreFrames);
+        }
+        return oboe::DataCallbackResult::Continue;
+    }
 
-            // Filter (keep 125-18000 Hz)
-            for (int k = 0; k < static_cast<int>(mFftOutput.size()); ++k) {
-                float freq = (static_cast<float>(k) * mSampleRate) / mBufferSize;
-                float gain = (freq < 125.0f || freq > 18000.0f) ? 0.0f : 1.0f;
-                mFftOutput[k].r *= gain;
-                mFftOutput[k].i *= gain;
-            }
+private:
+    static constexpr int32_t kDefaultFirTaps = 1025;
+    static constexpr int32_t kMaxCallbackFrames = 4096;
+    // Longest chain delay the async dry fallback lines up with (a full 8192-point frame)
+    static constexpr int32_t kMaxChainLatency = 8192;
+    // Smallest FFT the governor's SmallerFft rung goes down to
+    static constexpr int32_t kMinLadderFftSize = 256;
+
+    // start(): true if the stream has mChannelCount channels. Otherwise starts over in mono
+    // and returns false; mono is taken as the device gives it, as before.
+    bool opensChannelCount(const oboe::AudioStream &stream, const char *direction) {
+        if (stream.getChannelCount() == mChannelCount || mChannelCount == 1) return true;
+        LOGI("%s opened %d channels for %d, running mono", direction, stream.getChannelCount(),
+             mChannelCount);
+        const int32_t requested = mRequestedChannels;
+        mRequestedChannels = 1;
+        start();
+        mRequestedChannels = requested;
+        return false;
+    }
+
+    // Caller holds mSpectralMutex. Resolves the auto FFT size once, so the ladder thread
+    // can rebuild rungs without re-measuring.
+    void chooseSpectralConfig() {
+        mFullSpectralConfig = mSpectralConfig;
+        if (mAutoFftSize) {
+            mFullSpectralConfig = SpectralPath::chooseAutoConfig(mSpectralConfig, mFramesPerBurst,
+                                                                 mSampleRate, 0.25f, mChannelCount);
+        }
+        publishLadderRungs();
+    }
 
-            // IFFT
-            kiss_fftri(mIfftCfg, mFftOutput.data(), mConversionBuffer.data());
+    // Caller holds mSpectralMutex. The rungs applySpectralConfig() can make cheaper than the
+    // one above, for the governor to step over the rest.
+    void publishLadderRungs() {
+        const int32_t bands = mSpectral.getNumCompressorBands();
+        uint32_t rungs = 1u << (int32_t) LoadGovernor::Level::Full |
+                         1u << (int32_t) LoadGovernor::Level::Bypass;
+        if (mFullSpectralConfig.fftSize > kMinLadderFftSize) {
+            rungs |= 1u << (int32_t) LoadGovernor::Level::SmallerFft;
+        }
+        if (bands > 1) rungs |= 1u << (int32_t) LoadGovernor::Level::FewerBands;
+        if (bands > 0) rungs |= 1u << (int32_t) LoadGovernor::Level::NoCompressor;
+        mLadderRungs.store(rungs, std::memory_order_relaxed);
+    }
+
+    // Caller holds mSpectralMutex. Builds the full config scaled down to the governor's rung.
+    void applySpectralConfig() {
+        const auto level = static_cast<LoadGovernor::Level>(mLadderLevel.load(std::memory_order_relaxed));
+        SpectralProcessor::Config config = mFullSpectralConfig;
+        int32_t maxBands = MultibandCompressor::kMaxBands;
+        if (level >= LoadGovernor::Level::SmallerFft) {
+            config.fftSize = std::max(config.fftSize / 2, std::min(config.fftSize, kMinLadderFftSize));
+        }
+        if (level >= LoadGovernor::Level::FewerBands) {
+            maxBands = (mSpectral.getNumCompressorBands() + 1) / 2;
+        }
+        if (level >= LoadGovernor::Level::NoCompressor) {
+            maxBands = 0;
+        }
+        mSpectral.configure(config, mSampleRate, maxBands);
+        mAppliedLadderLevel = level;
+        config = mSpectral.getConfig();
+        LOGI("Spectral path: fft=%d hop=%d window=%d%s, quality level %d", config.fftSize,
+             config.hopSize(), (int) config.window, mAutoFftSize ? " (auto)" : "", (int) level);
+    }
 
-            // Normalize
-            for (int i = 0; i < mBufferSize; ++i) {
-                mConversionBuffer[i] /= mBufferSize;
+    // The thread running the Spectral path: the audio thread, or the async worker with the
+    // worker's own render time. Bypass is crossfaded right here; the other rungs need new
+    // processors, which the ladder thread builds and SpectralPath crossfades in.
+    void updateGovernor(int64_t renderNs, int32_t numFrames) {
+        const uint32_t rungs = mLadderRungs.load(std::memory_order_relaxed);
+        if (rungs != mGovernorRungs) {
+            mGovernorRungs = rungs;
+            for (int32_t level = 0; level < LoadGovernor::kNumLevels; ++level) {
+                mGovernor.setAvailable(static_cast<LoadGovernor::Level>(level), (rungs >> level) & 1u);
             }
+        }
+        if (!mGovernor.update(renderNs, numFrames)) return;
+        publishQuality();
+        const LoadGovernor::Level level = mGovernor.getLevel();
+        mSpectral.setBypass(level == LoadGovernor::Level::Bypass);
+        const int32_t rung = std::min((int32_t) level, (int32_t) LoadGovernor::Level::NoCompressor);
+        if (rung != mLadderLevel.load(std::memory_order_relaxed)) {
+            mLadderLevel.store(rung, std::memory_order_relaxed);
+            sem_post(&mLadderWake);
+        }
+    }
 
-            // Overlap-add (50% hop)
-            int half = hop;
-            for (int i = 0; i < half; ++i) {
-                mConversionBuffer[i] += mOverlapBuffer[i];
+    void ladderLoop() {
+        while (true) {
+            sem_wait(&mLadderWake);
+            if (!mLadderRunning.load(std::memory_order_acquire)) break;
+            std::lock_guard<std::mutex> lock(mSpectralMutex);
+            // Several steps may have queued up; only the latest rung matters
+            if ((int32_t) mAppliedLadderLevel != mLadderLevel.load(std::memory_order_relaxed)) {
+                applySpectralConfig();
             }
+        }
+    }
 
-            // push first half to output FIFO
-            mOutputFIFO.insert(mOutputFIFO.end(),
-                               mConversionBuffer.begin(),
-                               mConversionBuffer.begin() + half);
+    // All paths see exactly numFrames of input per callback, so they stay locked to the
+    // output clock; a starved mic has already been padded with silence. Runs on the audio
+    // thread, or on the async worker when that is running.
+    void render(ProcessingMode mode, const float *input, float *out, int32_t numFrames) {
+        mChains.process(static_cast<size_t>(mode), input, out, numFrames);
+    }
 
-            // save second half to overlap buffer
-            std::copy(mConversionBuffer.begin() + half,
-                      mConversionBuffer.end(),
-                      mOverlapBuffer.begin());
+    // Audio thread: coreFrames of core-rate output to numFrames in the device's rate and
+    // format. Float at the core rate was rendered in place already.
+    void writeOutput(float *core, void *audioData, int32_t coreFrames, int32_t numFrames) {
+        float *out = core;
+        if (!mOutputResampler.isPassthrough()) {
+            const bool isFloat = mOutputConverter.getFormat() == SampleConverter::Format::Float;
+            out = isFloat ? static_cast<float *>(audioData) : mFloatOutput;
+            mOutputResampler.process(core, coreFrames, out, numFrames);
+        }
+        mOutputConverter.fromFloat(out, audioData, numFrames * mChannelCount);
+    }
 
-            // advance read index & reduce available size by hop
-            mRingReadIndex = (mRingReadIndex + hop) % mInputRingBuffer.size();
-            mRingSize -= hop;
+    // Audio thread, fixed-point variant: Spectral mode in int16 from the drift
+    // compensator's output on, the others in float. Straight into an int16 stream at the
+    // core rate, through the resampler and output converter otherwise.
+    void renderFixed(ProcessingMode mode, void *audioData, int32_t coreFrames, int32_t numFrames) {
+        float *core = mOutputResampler.isPassthrough() ? mFloatOutput : mCoreOutput;
+        if (mode == ProcessingMode::Spectral && mFixedSpectral) {
+            const bool direct = mOutputResampler.isPassthrough() &&
+                                mOutputConverter.getFormat() == SampleConverter::Format::I16;
+            int16_t *out = direct ? static_cast<int16_t *>(audioData) : mFixedOutput;
+            mFixedConverter.fromFloat(mInputReadBuffer, mFixedInput, coreFrames);
+            mFixedSpectral->process(mFixedInput, coreFrames, out, coreFrames);
+            noteSpectralFlow(mFixedSpectral->getLastFlow());
+            if (direct) return;
+            mFixedConverter.toFloat(out, core, coreFrames);
+        } else {
+            render(mode, mInputReadBuffer, core, coreFrames);
         }
+        writeOutput(core, audioData, coreFrames, numFrames);
+    }
 
-        // 4) Deliver to output (from FIFO). If insufficient, zero-fill
-        int available = static_cast<int>(mOutputFIFO.size());
-        int toCopy = std::min(available, numFrames);
-        if (toCopy > 0) {
-            std::copy(mOutputFIFO.begin(), mOutputFIFO.begin() + toCopy, out);
-            // remove copied samples (this is O(n) per erase; for production replace FIFO with ring)
-            mOutputFIFO.erase(mOutputFIFO.begin(), mOutputFIFO.begin() + toCopy);
+    // Async worker: render, then publish the chain's delay for the dry fallback. The worker
+    // runs the Spectral path here, so it also feeds the governor its render time.
+    void renderChain(const float *input, float *out, int32_t numFrames) {
+        ProcessingMode mode = mProcessingMode.load(std::memory_order_relaxed);
+        const auto begin = std::chrono::steady_clock::now();
+        render(mode, input, out, numFrames);
+        if (mode == ProcessingMode::Spectral && mLadderThread.joinable()) {
+            const auto elapsed = std::chrono::steady_clock::now() - begin;
+            updateGovernor(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+                           numFrames);
         }
-        if (toCopy < numFrames) {
-            std::fill(out + toCopy, out + numFrames, 0.0f);
+        int32_t latency = 0;
+        if (mode == ProcessingMode::Spectral) {
+            latency = mSpectral.getLatencyFrames();
+        } else if (mode == ProcessingMode::Convolution) {
+            latency = mConvolvers[0].getLatencyFrames();
         }
+        mChainLatency.store(latency, std::memory_order_relaxed);
+    }
 
-        return oboe::DataCallbackResult::Continue;
+    // Whoever runs the governor publishes its state; the audio thread hands it to mStats.
+    void publishQuality() {
+        mQualityLevel.store((int32_t) mGovernor.getLevel(), std::memory_order_relaxed);
+        mQualityStepDowns.store(mGovernor.getStepDowns(), std::memory_order_relaxed);
+        mQualityStepUps.store(mGovernor.getStepUps(), std::memory_order_relaxed);
     }
 
+    void noteQuality() {
+        mStats.noteQuality(mQualityLevel.load(std::memory_order_relaxed),
+                           mQualityStepDowns.load(std::memory_order_relaxed),
+                           mQualityStepUps.load(std::memory_order_relaxed));
+    }
 
+    // Audio thread, synchronous processing only: the worker owns the flow in async mode.
+    void noteSpectralFlow(const SpectralProcessor::Flow &flow) {
+        if (flow.inputDropped > 0) mStats.addInputOverrun();
+        if (flow.outputDropped > 0) mStats.addOutputOverflow();
+        if (flow.underrunFrames > 0) mStats.addOutputUnderrun();
+        mStats.noteDepths(flow.inputDepth, flow.outputDepth);
+    }
 
-private:
     std::shared_ptr<oboe::AudioStream> mInputStream;
     std::shared_ptr<oboe::AudioStream> mOutputStream;
-    const int32_t mBufferSize;
-    int mSampleRate;
-    std::vector<float> mWindow;
-    std::vector<float> mWindowedInput;
-    std::vector<kiss_fft_cpx> mFftOutput;
-    std::vector<float> mConversionBuffer;
-    std::vector<float> mOverlapBuffer;
-    kiss_fftr_cfg mFftCfg;
-    kiss_fftr_cfg mIfftCfg;
-    std::vector<float> mInputReadBuffer;   // temp mic reads per callback
-    std::vector<float> mOutputFIFO;
+    int mSampleRate;                       // core rate the DSP runs at
+    DspArena mArena;
+    float *mMicBuffer = nullptr;           // raw mic reads per callback
+    float *mInputReadBuffer = nullptr;     // mic audio on the output clock
+    uint8_t *mMicRaw = nullptr;            // mic reads in a non-float device format
+    float *mFloatOutput = nullptr;         // output before a non-float device format
+    float *mMicResampled = nullptr;        // mic reads at the core rate
+    float *mCoreOutput = nullptr;          // output at the core rate, before resampling
+    int16_t *mFixedInput = nullptr;        // fixed point: mInputReadBuffer requantized
+    int16_t *mFixedOutput = nullptr;       // fixed point: before a non-I16 device format
+    SampleConverter mInputConverter;       // device format <-> float, per stream
+    SampleConverter mOutputConverter;
+    SampleConverter mFixedConverter;       // fixed point: float <-> int16 inside the engine
+    PolyphaseResampler mInputResampler;    // mic rate -> core rate, push
+    PolyphaseResampler mOutputResampler;   // core rate -> speaker rate, pull
+    int32_t mMicReadFrames = kMaxCallbackFrames;   // largest read that fits once resampled
+    DriftCompensator mDrift;
+    int64_t mDriftUnderruns = 0;
     int32_t mFramesPerBurst = 0;
-    int mAccumWriteIndex;
-    int32_t mAccumSize;
-    std::vector<float> mInputRingBuffer;
-    int mRingWriteIndex = 0;
-    int mRingReadIndex = 0;
-    int mRingSize = 0;
-
+    std::atomic<ProcessingMode> mProcessingMode{ProcessingMode::Spectral};
+    SpectralPath mSpectral;
+    SpectralProcessor::Config mSpectralConfig;
+    SpectralProcessor::Config mFullSpectralConfig;    // auto size resolved
+    bool mAutoFftSize = false;
+    std::vector<SpectralGainTable::GainPoint> mGainCurve;     // for the fixed-point path
+    std::mutex mSpectralMutex;      // JNI and ladder thread configuring mSpectral
+    std::vector<float> mFilterTaps;
+    int32_t mRequestedChannels = 1;
+    int32_t mChannelCount = 1;                 // as of start()
+    float *mPlanarIn[kMaxChannels] = {};       // per-channel stages' scratch
+    float *mPlanarOut[kMaxChannels] = {};
+    NonUniformConvolver mConvolvers[kMaxChannels];
+    BiquadCascade mIirs[kMaxChannels];
+    EngineChains mChains{
+            chain::TimeChain<SpectralStage>(SpectralStage{&mSpectral}),
+            chain::TimeChain<ConvolutionStage>(
+                    ConvolutionStage{mConvolvers, &mChannelCount, mPlanarIn, mPlanarOut}),
+            chain::TimeChain<IirStage>(IirStage{mIirs, &mChannelCount, mPlanarIn, mPlanarOut})};
+    bool mFixedPointRequested = false;
+    bool mFixedPoint = false;                  // as of start()
+    std::unique_ptr<FixedSpectralProcessor> mFixedSpectral;
+    float mAsyncLatencyMs = 0.0f;
+    AsyncProcessor mAsync;
+    std::atomic<int32_t> mChainLatency{0};     // worker -> audio thread
+    bool mGovernorEnabled = true;
+    LoadGovernor mGovernor;                    // audio thread, or the async worker
+    uint32_t mGovernorRungs = ~0u;             // last applied to mGovernor
+    std::atomic<uint32_t> mLadderRungs{~0u};   // available levels, bit per level
+    std::atomic<int32_t> mQualityLevel{0};     // mGovernor's state for mStats
+    std::atomic<int64_t> mQualityStepDowns{0};
+    std::atomic<int64_t> mQualityStepUps{0};
+    std::atomic<int32_t> mLadderLevel{0};      // rung below Bypass, audio -> ladder thread
+    LoadGovernor::Level mAppliedLadderLevel = LoadGovernor::Level::Full;
+    sem_t mLadderWake;
+    std::thread mLadderThread;
+    std::atomic<bool> mLadderRunning{false};
+    CallbackStats mStats;
 };
 
 std::unique_ptr<MicPassthrough> passthroughEngine = nullptr;
 
+static MicPassthrough &getEngine() {
+    if (!passthroughEngine) {
+        passthroughEngine = std::make_unique<MicPassthrough>(1024, 48000);
+    }
+    return *passthroughEngine;
+}
+
 extern "C"
 JNIEXPORT void JNICALL
 Java_com_example_oboepassthrough_AudioProcessingService_startPassthrough(JNIEnv *, jobject) {
-    if (!passthroughEngine) {
-        passthroughEngine = std::make_unique<MicPassthrough>(1024, 48000);
+    getEngine().start();
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_example_oboepassthrough_AudioProcessingService_setGainCurve(JNIEnv *env, jobject,
+                                                                      jfloatArray frequenciesHz,
+                                                                      jfloatArray gainsDb) {
+    jsize count = std::min(env->GetArrayLength(frequenciesHz), env->GetArrayLength(gainsDb));
+    std::vector<jfloat> freqs(count), gains(count);
+    env->GetFloatArrayRegion(frequenciesHz, 0, count, freqs.data());
+    env->GetFloatArrayRegion(gainsDb, 0, count, gains.data());
+    std::vector<SpectralGainTable::GainPoint> points(count);
+    for (jsize i = 0; i < count; ++i) {
+        points[i] = {freqs[i], gains[i]};
+    }
+    getEngine().setGainCurve(std::move(points));
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_example_oboepassthrough_AudioProcessingService_setCompressor(JNIEnv *env, jobject,
+                                                                       jfloatArray thresholdsDb,
+                                                                       jfloatArray ratios,
+                                                                       jfloatArray attackMs,
+                                                                       jfloatArray releaseMs) {
+    jsize count = std::min(std::min(env->GetArrayLength(thresholdsDb), env->GetArrayLength(ratios)),
+                           std::min(env->GetArrayLength(attackMs), env->GetArrayLength(releaseMs)));
+    std::vector<jfloat> thresholds(count), ratio(count), attack(count), release(count);
+    env->GetFloatArrayRegion(thresholdsDb, 0, count, thresholds.data());
+    env->GetFloatArrayRegion(ratios, 0, count, ratio.data());
+    env->GetFloatArrayRegion(attackMs, 0, count, attack.data());
+    env->GetFloatArrayRegion(releaseMs, 0, count, release.data());
+    std::vector<MultibandCompressor::BandParams> bands(count);
+    for (jsize i = 0; i < count; ++i) {
+        bands[i].thresholdDb = thresholds[i];
+        bands[i].ratio = ratio[i];
+        bands[i].attackMs = attack[i];
+        bands[i].releaseMs = release[i];
+    }
+    getEngine().setCompressorBands(std::move(bands));
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_example_oboepassthrough_AudioProcessingService_setSpectralConfig(JNIEnv *, jobject,
+                                                                           jint fftSize,
+                                                                           jint overlap,
+                                                                           jint windowType) {
+    // fftSize 0 selects a burst-aligned size automatically from the measured cost
+    SpectralProcessor::Config config;
+    config.fftSize = fftSize > 0 ? fftSize : 1024;
+    config.overlap = overlap;
+    config.window = static_cast<SpectralProcessor::WindowType>(windowType);
+    getEngine().setSpectralConfig(config, fftSize <= 0);
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_example_oboepassthrough_AudioProcessingService_setIirSections(JNIEnv *env, jobject,
+                                                                        jintArray types,
+                                                                        jfloatArray frequenciesHz,
+                                                                        jfloatArray qs,
+                                                                        jfloatArray gainsDb) {
+    jsize count = std::min(std::min(env->GetArrayLength(types), env->GetArrayLength(frequenciesHz)),
+                           std::min(env->GetArrayLength(qs), env->GetArrayLength(gainsDb)));
+    std::vector<jint> type(count);
+    std::vector<jfloat> freqs(count), q(count), gains(count);
+    env->GetIntArrayRegion(types, 0, count, type.data());
+    env->GetFloatArrayRegion(frequenciesHz, 0, count, freqs.data());
+    env->GetFloatArrayRegion(qs, 0, count, q.data());
+    env->GetFloatArrayRegion(gainsDb, 0, count, gains.data());
+    std::vector<BiquadCascade::Section> sections(count);
+    for (jsize i = 0; i < count; ++i) {
+        sections[i].type = static_cast<BiquadCascade::SectionType>(type[i]);
+        sections[i].frequencyHz = freqs[i];
+        sections[i].q = q[i];
+        sections[i].gainDb = gains[i];
+    }
+    getEngine().setIirSections(sections);
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_example_oboepassthrough_AudioProcessingService_setAsyncLatency(JNIEnv *, jobject,
+                                                                         jfloat extraLatencyMs) {
+    getEngine().setAsyncLatency(extraLatencyMs);
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_example_oboepassthrough_AudioProcessingService_setLoadGovernor(JNIEnv *, jobject,
+                                                                         jboolean enabled) {
+    getEngine().setLoadGovernor(enabled);
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_example_oboepassthrough_AudioProcessingService_setFixedPoint(JNIEnv *, jobject,
+                                                                       jboolean enabled) {
+    getEngine().setFixedPoint(enabled);
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_example_oboepassthrough_AudioProcessingService_setChannelCount(JNIEnv *, jobject,
+                                                                         jint channels) {
+    getEngine().setChannelCount(channels);
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_example_oboepassthrough_AudioProcessingService_setProcessingMode(JNIEnv *, jobject,
+                                                                           jint mode) {
+    getEngine().setProcessingMode(static_cast<ProcessingMode>(mode));
+}
+
+// Layout mirrors the STATS_* constants in AudioProcessingService.kt
+enum StatsIndex : jsize {
+    kStatsCallbacks = 0,
+    kStatsFrames,
+    kStatsMinNs,
+    kStatsMeanNs,
+    kStatsP50Ns,
+    kStatsP90Ns,
+    kStatsP99Ns,
+    kStatsMaxNs,
+    kStatsShortReads,
+    kStatsInputOverruns,
+    kStatsOutputOverflows,
+    kStatsOutputUnderruns,
+    kStatsInputHighWater,
+    kStatsOutputHighWater,
+    kStatsTailDeadlineMisses,
+    kStatsSampleRate,
+    kStatsDriftPpb,         // resampling correction, parts per billion
+    kStatsDriftFillFrames,
+    kStatsDriftSlips,
+    kStatsLatencyTargetFrames,  // mic backlog held by the jitter controller
+    kStatsLatencyMarginFrames,
+    kStatsLatencyDrops,
+    kStatsWorkerDeadlineMisses,     // async mode: callbacks that fell back to dry audio
+    kStatsQualityLevel,             // LoadGovernor::Level
+    kStatsQualityStepDowns,
+    kStatsQualityStepUps,
+    kStatsHistogram,    // CallbackStats::kNumBuckets counts, bucket i ends at 1 us * 2^((i + 1) / 4)
+};
+
+static std::mutex statsMutex;   // TripleBuffer has a single reader
+
+extern "C"
+JNIEXPORT jlongArray JNICALL
+Java_com_example_oboepassthrough_AudioProcessingService_getCallbackStats(JNIEnv *env, jclass) {
+    jlong values[kStatsHistogram + CallbackStats::kNumBuckets] = {};
+    if (passthroughEngine) {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        const CallbackStats::Snapshot &s = passthroughEngine->readStats();
+        values[kStatsCallbacks] = s.callbacks;
+        values[kStatsFrames] = s.frames;
+        values[kStatsMinNs] = s.minNs;
+        values[kStatsMeanNs] = s.callbacks > 0 ? s.totalNs / s.callbacks : 0;
+        values[kStatsP50Ns] = s.percentileNs(0.5);
+        values[kStatsP90Ns] = s.percentileNs(0.9);
+        values[kStatsP99Ns] = s.percentileNs(0.99);
+        values[kStatsMaxNs] = s.maxNs;
+        values[kStatsShortReads] = s.shortReads;
+        values[kStatsInputOverruns] = s.inputOverruns;
+        values[kStatsOutputOverflows] = s.outputOverflows;
+        values[kStatsOutputUnderruns] = s.outputUnderruns;
+        values[kStatsInputHighWater] = s.inputHighWater;
+        values[kStatsOutputHighWater] = s.outputHighWater;
+        values[kStatsTailDeadlineMisses] = passthroughEngine->getTailDeadlineMisses();
+        values[kStatsSampleRate] = passthroughEngine->getSampleRate();
+        values[kStatsDriftPpb] = (jlong) llround(s.driftPpm * 1000.0);
+        values[kStatsDriftFillFrames] = (jlong) llround(s.driftFillFrames);
+        values[kStatsDriftSlips] = s.driftSlips;
+        values[kStatsLatencyTargetFrames] = s.latencyTargetFrames;
+        values[kStatsLatencyMarginFrames] = s.latencyMarginFrames;
+        values[kStatsLatencyDrops] = s.latencyDrops;
+        values[kStatsWorkerDeadlineMisses] = passthroughEngine->getWorkerDeadlineMisses();
+        values[kStatsQualityLevel] = s.qualityLevel;
+        values[kStatsQualityStepDowns] = s.qualityStepDowns;
+        values[kStatsQualityStepUps] = s.qualityStepUps;
+        for (int i = 0; i < CallbackStats::kNumBuckets; ++i) {
+            values[kStatsHistogram + i] = s.histogram[i];
+        }
+    }
+    const jsize count = kStatsHistogram + CallbackStats::kNumBuckets;
+    jlongArray result = env->NewLongArray(count);
+    env->SetLongArrayRegion(result, 0, count, values);
+    return result;
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_example_oboepassthrough_AudioProcessingService_resetCallbackStats(JNIEnv *, jclass) {
+    if (passthroughEngine) {
+        passthroughEngine->resetStats();
     }
-    passthroughEngine->start();
 }
 
 extern "C"
@@ -0,0 +1,116 @@
+#include "AllocationTrap.h"
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+// Plain thread_locals in the executable: static TLS, so touching them never allocates
+thread_local bool tArmed = false;
+thread_local int64_t tCount = 0;
+
+inline void note() {
+    if (tArmed) ++tCount;
+}
+
+} // namespace
+
+namespace test {
+
+AllocationTrap::AllocationTrap() {
+    tCount = 0;
+    tArmed = true;
+}
+
+AllocationTrap::~AllocationTrap() {
+    tArmed = false;
+}
+
+int64_t AllocationTrap::getCount() const {
+    return tCount;
+}
+
+} // namespace test
+
+#if defined(__GLIBC__)
+
+// Every allocation in the process goes through these, operator new included
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+void __libc_free(void *ptr);
+
+void *malloc(size_t size) {
+    note();
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+    note();
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+    note();
+    return __libc_realloc(ptr, size);
+}
+
+void *memalign(size_t alignment, size_t size) {
+    note();
+    return __libc_memalign(alignment, size);
+}
+
+void *aligned_alloc(size_t alignment, size_t size) {
+    note();
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void **out, size_t alignment, size_t size) {
+    note();
+    if (alignment < sizeof(void *) || (alignment & (alignment - 1)) != 0) return EINVAL;
+    void *p = __libc_memalign(alignment, size);
+    if (!p) return ENOMEM;
+    *out = p;
+    return 0;
+}
+
+void free(void *ptr) {
+    if (ptr) note();
+    __libc_free(ptr);
+}
+} // extern "C"
+
+#else
+
+void *operator new(size_t size) {
+    note();
+    if (void *p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void *ptr) noexcept {
+    if (ptr) note();
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept {
+    operator delete(ptr);
+}
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef OBOEPASSTHROUGH_ALLOCATIONTRAP_H
+#define OBOEPASSTHROUGH_ALLOCATIONTRAP_H
+
+#include <cstdint>
+
+namespace test {
+
+/**
+ * Counts heap calls made on the constructing thread while the trap is alive: malloc,
+ * calloc, realloc, the aligned variants and free (so operator new/delete too). Other
+ * threads are not watched, so a test can arm it around the audio-thread calls while the
+ * control side configures freely.
+ *
+ * Link AllocationTrap.cpp into the test. On glibc it interposes the malloc family; on
+ * other hosts it only replaces the global operator new/delete.
+ */
+class AllocationTrap {
+public:
+    AllocationTrap();
+    ~AllocationTrap();
+
+    AllocationTrap(const AllocationTrap &) = delete;
+    AllocationTrap &operator=(const AllocationTrap &) = delete;
+
+    // Calls so far while armed.
+    int64_t getCount() const;
+};
+
+} // namespace test
+
+#endif //OBOEPASSTHROUGH_ALLOCATIONTRAP_H
@@ -0,0 +1,42 @@
+#ifndef OBOEPASSTHROUGH_TESTUTIL_H
+#define OBOEPASSTHROUGH_TESTUTIL_H
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+// Minimal assertions for the host tests: report, count, keep going; main() returns
+// test::failures() so ctest sees a non-zero exit.
+namespace test {
+
+inline int &failureCount() {
+    static int count = 0;
+    return count;
+}
+
+inline int failures() {
+    if (failureCount() == 0) printf("PASS\n");
+    return failureCount() == 0 ? 0 : 1;
+}
+
+} // namespace test
+
+#define EXPECT_TRUE(cond)                                                       \
+    do {                                                                        \
+        if (!(cond)) {                                                          \
+            printf("%s:%d: expected %s\n", __FILE__, __LINE__, #cond);          \
+            ++test::failureCount();                                             \
+        }                                                                       \
+    } while (0)
+
+#define EXPECT_NEAR(a, b, tol)                                                  \
+    do {                                                                        \
+        double _a = (a), _b = (b);                                              \
+        if (!(std::fabs(_a - _b) <= (tol))) {                                   \
+            printf("%s:%d: %s = %g, expected %g (tol %g)\n",                    \
+                   __FILE__, __LINE__, #a, _a, _b, (double) (tol));             \
+            ++test::failureCount();                                             \
+        }                                                                       \
+    } while (0)
+
+#endif //OBOEPASSTHROUGH_TESTUTIL_H
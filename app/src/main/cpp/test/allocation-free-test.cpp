@@ -0,0 +1,262 @@
+// The audio-thread path under an allocation trap: the engine's callback sequence (format
+// conversion and sample-rate conversion at both ends, drift compensator, spectral,
+// convolution and IIR chains, stats, load governor, async handoff, the fixed-point
+// spectral path) must make no heap call at any burst size, mono or stereo, including
+// across processor swaps, bypass fades and mode switches. Also checks the DspArena layout
+// and that the trap itself fires.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "AllocationTrap.h"
+#include "AsyncProcessor.h"
+#include "BiquadCascade.h"
+#include "CallbackStats.h"
+#include "DriftCompensator.h"
+#include "DspArena.h"
+#include "FirDesign.h"
+#include "FixedSpectralProcessor.h"
+#include "Interleave.h"
+#include "LoadGovernor.h"
+#include "NonUniformConvolver.h"
+#include "PolyphaseResampler.h"
+#include "ProcessorChain.h"
+#include "SampleConverter.h"
+#include "SpectralPath.h"
+#include "TestUtil.h"
+
+namespace {
+
+constexpr int32_t kSampleRate = 48000;
+constexpr int32_t kMaxCallbackFrames = 4096;
+constexpr int32_t kDeviceRate = 44100;      // both streams, around the 48 kHz core
+constexpr int32_t kMaxChannels = 2;
+
+void *volatile gSink = nullptr;
+
+// Same stages as the engine's
+struct SpectralStage {
+    SpectralPath *path;
+    void process(const float *input, float *output, int32_t numFrames) {
+        path->process(input, numFrames, output, numFrames);
+    }
+};
+
+template <typename Processor>
+struct PerChannelStage {
+    Processor *processors;
+    const int32_t *channels;
+    float *const *planarIn;
+    float *const *planarOut;
+    void process(const float *input, float *output, int32_t numFrames) {
+        const int32_t count = *channels;
+        if (count == 1) {
+            processors[0].process(input, output, numFrames);
+            return;
+        }
+        Interleave::toPlanar(input, count, numFrames, planarIn);
+        for (int32_t c = 0; c < count; ++c) {
+            processors[c].process(planarIn[c], planarOut[c], numFrames);
+        }
+        Interleave::fromPlanar(planarOut, count, numFrames, output);
+    }
+};
+
+using ConvolutionStage = PerChannelStage<NonUniformConvolver>;
+using IirStage = PerChannelStage<BiquadCascade>;
+
+using Chains = chain::ChainSet<chain::TimeChain<SpectralStage>, chain::TimeChain<ConvolutionStage>,
+                               chain::TimeChain<IirStage>>;
+
+void checkTrapFires() {
+    test::AllocationTrap trap;
+    gSink = std::malloc(64);
+    std::free(gSink);
+    gSink = new float[16];
+    delete[] static_cast<float *>(gSink);
+    EXPECT_TRUE(trap.getCount() == 4);
+}
+
+void checkArenaLayout() {
+    DspArena arena;
+    float *a = nullptr;
+    kiss_fft_cpx *b = nullptr;
+    fft_backend_cfg plan = nullptr;
+    auto layout = [&](DspArena &ar) {
+        a = ar.take<float>(3);
+        b = ar.take<kiss_fft_cpx>(5);
+        plan = takeFftPlan(ar, 512, 0);
+    };
+
+    DspArena sizing;
+    layout(sizing);
+    EXPECT_TRUE(sizing.isSizing() && a == nullptr && plan == nullptr);
+
+    arena.build(layout);
+    EXPECT_TRUE(arena.used() == sizing.used() && arena.capacity() >= arena.used());
+    EXPECT_TRUE(reinterpret_cast<uintptr_t>(a) % DspArena::kAlignment == 0);
+    EXPECT_TRUE(reinterpret_cast<uintptr_t>(b) % DspArena::kAlignment == 0);
+    EXPECT_TRUE(reinterpret_cast<uintptr_t>(plan) % DspArena::kAlignment == 0);
+    EXPECT_TRUE((char *) b >= (char *) (a + 3) && (char *) plan >= (char *) (b + 5));
+    EXPECT_TRUE(a[0] == 0.0f && b[4].i == 0.0f);
+
+    // A real transform through the placed plan
+    std::vector<float> in(512, 1.0f);
+    std::vector<kiss_fft_cpx> out(257);
+    fft_backend_fftr(plan, in.data(), out.data());
+    EXPECT_NEAR(out[0].r, 512.0, 1e-3);
+
+    // Past the end is refused rather than overrun
+    EXPECT_TRUE(arena.takeBytes(1) == nullptr);
+}
+
+// The engine's callback on one burst size and channel count. Control-thread calls
+// (reconfiguring) run between callbacks with the trap disarmed.
+int64_t runCallbacks(int32_t burst, int32_t channels) {
+    // An I16 mic and an I24 output at 44.1 kHz, as an MMAP device might open them
+    SampleConverter micFormat, outFormat;
+    micFormat.configure(SampleConverter::Format::I16);
+    outFormat.configure(SampleConverter::Format::I24);
+    PolyphaseResampler micRate, outRate;
+    micRate.configure(kDeviceRate, kSampleRate, kMaxCallbackFrames, channels);
+    outRate.configure(kSampleRate, kDeviceRate, kMaxCallbackFrames, channels);
+    // Core frames per callback, at most
+    const int32_t maxCore = micRate.outputCapacityFor(burst);
+    DriftCompensator drift;
+    drift.configure(kSampleRate, 2 * burst, maxCore, channels);
+    SpectralPath spectral;
+    spectral.setChannelCount(channels);
+    spectral.setGainCurve({{250.0f, 10.0f}, {4000.0f, 20.0f}});
+    MultibandCompressor::BandParams band;
+    band.ratio = 3.0f;
+    spectral.setCompressorBands(std::vector<MultibandCompressor::BandParams>(4, band));
+    SpectralProcessor::Config config;
+    config.fftSize = 1024;
+    spectral.configure(config, kSampleRate);
+    NonUniformConvolver convolvers[kMaxChannels];
+    BiquadCascade iirs[kMaxChannels];
+    auto taps = FirDesign::bandPass(125.0f, 18000.0f, kSampleRate, 8000);
+    std::vector<float> planar(2 * kMaxChannels * maxCore);
+    float *planarIn[kMaxChannels], *planarOut[kMaxChannels];
+    for (int32_t c = 0; c < channels; ++c) {
+        convolvers[c].configure(burst, taps.data(), (int32_t) taps.size());
+        iirs[c].configure(kSampleRate);
+        iirs[c].setSections(BiquadCascade::bandLimit(125.0f, 18000.0f));
+        planarIn[c] = planar.data() + 2 * c * maxCore;
+        planarOut[c] = planarIn[c] + maxCore;
+    }
+    CallbackStats stats;
+    LoadGovernor governor;
+    governor.configure(kSampleRate);
+    Chains chains{chain::TimeChain<SpectralStage>(SpectralStage{&spectral}),
+                  chain::TimeChain<ConvolutionStage>(
+                          ConvolutionStage{convolvers, &channels, planarIn, planarOut}),
+                  chain::TimeChain<IirStage>(IirStage{iirs, &channels, planarIn, planarOut})};
+
+    const int32_t samples = burst * channels;
+    const int32_t coreSamples = maxCore * channels;
+    std::vector<int16_t> micRaw(samples);
+    std::vector<uint8_t> device(3 * samples);
+    std::vector<float> mic(samples), micCore(coreSamples), in(coreSamples), out(coreSamples),
+            speaker(samples);
+    for (int32_t i = 0; i < samples; ++i) micRaw[i] = (int16_t) ((i * 37) % 101 * 300 - 15000);
+
+    int64_t trapped = 0;
+    const int32_t callbacks = std::max(3 * 16384 / burst, 64);
+    for (int32_t n = 0; n < callbacks; ++n) {
+        // Control thread: a new FFT size, then bypass in and out
+        if (n == callbacks / 4) {
+            config.fftSize = 512;
+            spectral.configure(config, kSampleRate);
+        }
+        if (n == callbacks / 2) spectral.setBypass(true);
+        if (n == 3 * callbacks / 4) spectral.setBypass(false);
+
+        test::AllocationTrap trap;
+        stats.beginCallback();
+        const int32_t core = outRate.inputFramesFor(burst);
+        micFormat.toFloat(micRaw.data(), mic.data(), samples);
+        drift.write(micCore.data(), micRate.process(mic.data(), burst, micCore.data(), maxCore));
+        drift.read(in.data(), core);
+        stats.noteDrift(drift.getCorrectionPpm(), drift.getFillFrames(), drift.getSlips());
+        const size_t mode = (size_t) (n / 8 % 3);
+        chains.process(mode, in.data(), out.data(), core);
+        outRate.process(out.data(), core, speaker.data(), burst);
+        outFormat.fromFloat(speaker.data(), device.data(), samples);
+        if (mode == 0) {
+            const SpectralProcessor::Flow &flow = spectral.getLastFlow();
+            stats.noteDepths(flow.inputDepth, flow.outputDepth);
+        }
+        stats.noteQuality((int32_t) governor.getLevel(), governor.getStepDowns(), governor.getStepUps());
+        governor.update(stats.endCallback(core), core);
+        trapped += trap.getCount();
+    }
+    return trapped;
+}
+
+// The callback side of the async handoff; the worker thread isn't watched.
+int64_t runAsync(int32_t burst) {
+    BiquadCascade iir;
+    iir.configure(kSampleRate);
+    iir.setSections(BiquadCascade::bandLimit(125.0f, 18000.0f));
+    AsyncProcessor async;
+    async.start([&iir](const float *input, float *output, int32_t numFrames) {
+        iir.process(input, output, numFrames);
+    }, kMaxCallbackFrames, 2 * burst, kMaxCallbackFrames);
+
+    std::vector<float> in(burst, 0.25f), out(burst);
+    int64_t trapped = 0;
+    for (int32_t n = 0; n < 64; ++n) {
+        test::AllocationTrap trap;
+        async.setDryDelay(n % 2 ? 0 : burst);
+        async.process(in.data(), out.data(), burst);
+        trapped += trap.getCount();
+    }
+    async.stop();
+    return trapped;
+}
+
+// The fixed-point variant's Spectral callback, with a gain curve update between callbacks.
+int64_t runFixed(int32_t burst) {
+    SpectralProcessor::Config config;
+    config.fftSize = 1024;
+    FixedSpectralProcessor fixed(config, kSampleRate);
+    std::vector<int16_t> in(burst), out(burst);
+    for (int32_t i = 0; i < burst; ++i) in[i] = (int16_t) ((i * 37) % 101 * 300 - 15000);
+
+    int64_t trapped = 0;
+    const int32_t callbacks = std::max(3 * 4096 / burst, 16);
+    for (int32_t n = 0; n < callbacks; ++n) {
+        if (n == callbacks / 2) fixed.setGainCurve({{250.0f, 10.0f}, {4000.0f, 20.0f}});
+        test::AllocationTrap trap;
+        fixed.process(in.data(), burst, out.data(), burst);
+        trapped += trap.getCount();
+    }
+    return trapped;
+}
+
+} // namespace
+
+int main() {
+    checkTrapFires();
+    checkArenaLayout();
+    for (int32_t burst : {32, 48, 64, 96, 128, 144, 192, 240, 256, 441, 480, 512, 960, 1024,
+                          2048, 4096}) {
+        const int64_t callback = runCallbacks(burst, 1);
+        const int64_t stereo = runCallbacks(burst, 2);
+        const int64_t async = runAsync(burst);
+        const int64_t fixed = runFixed(burst);
+        if (callback != 0 || stereo != 0 || async != 0 || fixed != 0) {
+            printf("burst %d: %lld heap calls in the callback (%lld stereo), %lld in the async "
+                   "handoff, %lld in the fixed-point path\n", burst, (long long) callback,
+                   (long long) stereo, (long long) async, (long long) fixed);
+        }
+        EXPECT_TRUE(callback == 0);
+        EXPECT_TRUE(stereo == 0);
+        EXPECT_TRUE(async == 0);
+        EXPECT_TRUE(fixed == 0);
+    }
+    return test::failures();
+}
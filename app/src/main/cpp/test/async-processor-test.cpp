@@ -0,0 +1,182 @@
+// Drives AsyncProcessor with simulated real-time bursts: the wet output must line up with
+// the input, and a worker that misses its deadline must fall back to aligned dry audio
+// and recover once it catches up, also after it stalled long enough for input to be
+// dropped.
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "AsyncProcessor.h"
+#include "TestUtil.h"
+
+namespace {
+
+constexpr int32_t kSampleRate = 48000;
+constexpr float kWetGain = 2.0f;
+
+// Cleared when run() stops feeding callbacks; releases a chain that holds its first call
+std::atomic<bool> gFeeding{false};
+
+std::vector<float> noise(size_t n, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(-0.5f, 0.5f);
+    std::vector<float> v(n);
+    for (auto &s : v) s = dist(rng);
+    return v;
+}
+
+// A stand-in chain: kWetGain with delay.size() frames of latency, stalling for stallNs on
+// the stallCall-th call, or holding its first call until run() has fed every callback.
+struct SlowChain {
+    std::vector<float> delay;
+    size_t pos = 0;
+    int32_t calls = 0;
+    int32_t stallCall = -1;
+    bool holdFirstCall = false;
+    int64_t stallNs = 0;
+
+    void render(const float *input, float *output, int32_t numFrames) {
+        if (holdFirstCall && calls == 0) {
+            while (gFeeding.load()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        if (calls++ == stallCall) {
+            std::this_thread::sleep_for(std::chrono::nanoseconds(stallNs));
+        }
+        for (int32_t i = 0; i < numFrames; ++i) {
+            if (delay.empty()) {
+                output[i] = kWetGain * input[i];
+                continue;
+            }
+            output[i] = kWetGain * delay[pos];
+            delay[pos] = input[i];
+            pos = (pos + 1) % delay.size();
+        }
+    }
+};
+
+struct Result {
+    int64_t wet = 0;
+    int64_t dry = 0;
+    int64_t wrong = 0;
+    int64_t wetAtEnd = 0;   // over the last quarter
+};
+
+Result run(int32_t burst, int32_t latency, SlowChain chain, double seconds, AsyncProcessor &async) {
+    auto x = noise((size_t) (seconds * kSampleRate) / burst * burst, 5);
+    std::vector<float> y(x.size());
+
+    const int32_t chainDelay = (int32_t) chain.delay.size();
+    async.start([&chain](const float *in, float *out, int32_t n) { chain.render(in, out, n); },
+                burst, latency, chainDelay);
+
+    auto period = std::chrono::nanoseconds((int64_t) (1e9 * burst / kSampleRate));
+    auto next = std::chrono::steady_clock::now();
+    gFeeding.store(true);
+    for (size_t pos = 0; pos < x.size(); pos += burst) {
+        std::this_thread::sleep_until(next);
+        next += period;
+        async.setDryDelay(chainDelay);
+        async.process(&x[pos], &y[pos], burst);
+    }
+    gFeeding.store(false);
+    async.stop();
+
+    // Every sample is either the wet or the dry signal, both delayed by the full latency
+    Result r;
+    const size_t shift = (size_t) latency + chainDelay;
+    for (size_t n = shift; n < y.size(); ++n) {
+        const float source = x[n - shift];
+        if (std::fabs(y[n] - kWetGain * source) < 1e-6f) {
+            ++r.wet;
+            if (n >= y.size() * 3 / 4) ++r.wetAtEnd;
+        } else if (std::fabs(y[n] - source) < 1e-6f) {
+            ++r.dry;
+        } else {
+            ++r.wrong;
+        }
+    }
+    return r;
+}
+
+void checkKeepsUp() {
+    AsyncProcessor async;
+    Result r = run(192, 2 * 192, SlowChain(), 1.0, async);
+    printf("keeps up: wet %lld, dry %lld, misaligned %lld, deadline misses %lld, realtime %d\n",
+           (long long) r.wet, (long long) r.dry, (long long) r.wrong,
+           (long long) async.getDeadlineMisses(), async.hasRealtimePriority() ? 1 : 0);
+    EXPECT_TRUE(r.wrong == 0);
+    EXPECT_TRUE(async.getInputOverruns() == 0);
+    // A loaded host can still preempt the worker now and then
+    EXPECT_TRUE(r.dry * 20 < r.wet);
+}
+
+// A stall of several callbacks plays aligned dry audio, then the wet path resumes.
+void checkStallFallsBackToDry() {
+    const int32_t burst = 240;
+    SlowChain chain;
+    chain.delay.assign(480, 0.0f);
+    chain.stallCall = 40;
+    chain.stallNs = (int64_t) (6e9 * burst / kSampleRate);
+    AsyncProcessor async;
+    Result r = run(burst, burst, chain, 1.0, async);
+    printf("stall: wet %lld, dry %lld, misaligned %lld, deadline misses %lld\n",
+           (long long) r.wet, (long long) r.dry, (long long) r.wrong,
+           (long long) async.getDeadlineMisses());
+    EXPECT_TRUE(r.wrong == 0);
+    EXPECT_TRUE(async.getDeadlineMisses() > 0);
+    EXPECT_TRUE(r.dry >= 4 * burst);
+    EXPECT_TRUE(r.wetAtEnd * 5 > (int64_t) (kSampleRate / 4) * 4);
+    EXPECT_TRUE(async.getInputOverruns() == 0);
+}
+
+// A chain that never delivers plays the dry input, never silence or garbage, including
+// for the callbacks whose input overran the stalled worker.
+void checkAlwaysLateIsDry() {
+    const int32_t burst = 128;
+    SlowChain chain;
+    chain.delay.assign(64, 0.0f);
+    chain.holdFirstCall = true;
+    AsyncProcessor async;
+    Result r = run(burst, burst, chain, 0.25, async);
+    const int64_t callbacks = (kSampleRate / 4) / burst;
+    printf("always late: wet %lld, dry %lld, misaligned %lld, deadline misses %lld of %lld\n",
+           (long long) r.wet, (long long) r.dry, (long long) r.wrong,
+           (long long) async.getDeadlineMisses(), (long long) callbacks);
+    EXPECT_TRUE(r.wrong == 0);
+    EXPECT_TRUE(r.wet == 0);
+    EXPECT_TRUE(async.getInputOverruns() > 0);
+    // Only the pre-rolled first callback is on time
+    EXPECT_TRUE(async.getDeadlineMisses() == callbacks - 1);
+}
+
+// A stall long enough to overrun the input ring: the dropped callbacks play dry, and the
+// wet path lines up again once the worker has caught up.
+void checkOverrunRealigns() {
+    const int32_t burst = 192;
+    SlowChain chain;
+    chain.stallCall = 20;
+    chain.stallNs = (int64_t) (30e9 * burst / kSampleRate);
+    AsyncProcessor async;
+    Result r = run(burst, burst, chain, 1.0, async);
+    printf("overrun: wet %lld, dry %lld, misaligned %lld, deadline misses %lld, overruns %lld\n",
+           (long long) r.wet, (long long) r.dry, (long long) r.wrong,
+           (long long) async.getDeadlineMisses(), (long long) async.getInputOverruns());
+    EXPECT_TRUE(async.getInputOverruns() > 0);
+    EXPECT_TRUE(r.wrong == 0);
+    EXPECT_TRUE(r.dry >= 20 * burst);
+    EXPECT_TRUE(r.wetAtEnd * 5 > (int64_t) (kSampleRate / 4) * 4);
+}
+
+} // namespace
+
+int main() {
+    checkKeepsUp();
+    checkStallFallsBackToDry();
+    checkAlwaysLateIsDry();
+    checkOverrunRealigns();
+    return test::failures();
+}
@@ -0,0 +1,148 @@
+// BiquadCascade: the four-sample block path against a plain double-precision direct
+// form I reference, measured magnitude against responseDb(), zero block delay and the
+// denormal flush on silence.
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "BiquadCascade.h"
+#include "TestUtil.h"
+
+namespace {
+
+constexpr int kSampleRate = 48000;
+
+std::vector<BiquadCascade::Section> testSections() {
+    std::vector<BiquadCascade::Section> sections = BiquadCascade::bandLimit(125.0f, 18000.0f);
+    sections.push_back({BiquadCascade::SectionType::Peaking, 2000.0f, 1.5f, 12.0f});
+    sections.push_back({BiquadCascade::SectionType::Peaking, 4000.0f, 0.8f, -6.0f});
+    return sections;
+}
+
+void testMatchesReference() {
+    BiquadCascade cascade;
+    cascade.configure(kSampleRate);
+    cascade.setSections(testSections());
+
+    std::vector<BiquadCascade::Coefficients> coeffs;
+    for (const auto &section : cascade.getSections()) {
+        coeffs.push_back(BiquadCascade::design(section, kSampleRate));
+    }
+    std::vector<double> state(4 * coeffs.size(), 0.0);
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> dist(-0.5f, 0.5f);
+    std::uniform_int_distribution<int> blockSize(1, 37);
+    std::vector<float> in(64), out(64);
+    double maxErr = 0.0;
+    for (int block = 0; block < 2000; ++block) {
+        const int n = blockSize(rng);
+        for (int i = 0; i < n; ++i) in[i] = dist(rng);
+        cascade.process(in.data(), out.data(), n);
+        for (int i = 0; i < n; ++i) {
+            double x = in[i];
+            for (size_t s = 0; s < coeffs.size(); ++s) {
+                const auto &c = coeffs[s];
+                double *st = &state[4 * s];
+                double y = c.b0 * x + c.b1 * st[0] + c.b2 * st[1] - c.a1 * st[2] - c.a2 * st[3];
+                st[1] = st[0];
+                st[0] = x;
+                st[3] = st[2];
+                st[2] = y;
+                x = y;
+            }
+            maxErr = std::max(maxErr, std::fabs(x - out[i]));
+        }
+    }
+    printf("block vs reference: max error %.3g\n", maxErr);
+    EXPECT_TRUE(maxErr < 1e-4);
+}
+
+void testResponse() {
+    BiquadCascade cascade;
+    cascade.configure(kSampleRate);
+    cascade.setSections(testSections());
+
+    for (float hz : {50.0f, 250.0f, 1000.0f, 2000.0f, 4000.0f, 10000.0f, 20000.0f}) {
+        cascade.reset();
+        const int settle = kSampleRate / 2;
+        const int measure = kSampleRate / 2;
+        std::vector<float> x(settle + measure), y(settle + measure);
+        for (size_t i = 0; i < x.size(); ++i) x[i] = 0.25f * sinf(2.0f * (float) M_PI * hz * i / kSampleRate);
+        // Odd callback size so both the vector and the scalar tail run
+        for (size_t i = 0; i < x.size(); i += 97) {
+            int n = (int) std::min<size_t>(97, x.size() - i);
+            cascade.process(&x[i], &y[i], n);
+        }
+        double inPower = 0.0, outPower = 0.0;
+        for (int i = settle; i < settle + measure; ++i) {
+            inPower += (double) x[i] * x[i];
+            outPower += (double) y[i] * y[i];
+        }
+        double measuredDb = 10.0 * log10(outPower / inPower);
+        printf("%7.0f Hz: %7.2f dB (expected %7.2f)\n", hz, measuredDb, cascade.responseDb(hz));
+        EXPECT_NEAR(measuredDb, cascade.responseDb(hz), 0.1);
+    }
+
+    // The band limit alone: flat passband, -3 dB at the corners, 24 dB/octave skirts
+    cascade.setSections(BiquadCascade::bandLimit(125.0f, 18000.0f));
+    EXPECT_NEAR(cascade.responseDb(1000.0f), 0.0, 0.05);
+    EXPECT_NEAR(cascade.responseDb(125.0f), -3.0, 0.1);
+    EXPECT_NEAR(cascade.responseDb(62.5f), -24.0, 1.0);
+}
+
+void testNoBlockDelay() {
+    // The first output sample already carries the impulse
+    BiquadCascade cascade;
+    cascade.configure(kSampleRate);
+    cascade.setSections({{BiquadCascade::SectionType::Peaking, 1000.0f, 1.0f, 6.0f}});
+    float in[8] = {1.0f}, out[8];
+    cascade.process(in, out, 8);
+    EXPECT_NEAR(out[0], BiquadCascade::design(cascade.getSections()[0], kSampleRate).b0, 1e-6);
+
+    // In-place processing gives the same result
+    cascade.reset();
+    float buffer[8] = {1.0f};
+    cascade.process(buffer, buffer, 8);
+    for (int i = 0; i < 8; ++i) EXPECT_NEAR(buffer[i], out[i], 1e-7);
+}
+
+void testSilenceFlushesState() {
+    BiquadCascade cascade;
+    cascade.configure(kSampleRate);
+    cascade.setSections(testSections());
+    std::vector<float> x(192), y(192);
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    for (auto &s : x) s = dist(rng);
+    cascade.process(x.data(), y.data(), 192);
+
+    // After the tails decay the output must be exact zeros, not denormals
+    std::fill(x.begin(), x.end(), 0.0f);
+    for (int i = 0; i < 4 * kSampleRate / 192; ++i) cascade.process(x.data(), y.data(), 192);
+    bool allZero = true;
+    for (float s : y) allZero = allZero && s == 0.0f;
+    EXPECT_TRUE(allZero);
+}
+
+void testEmptyPassesThrough() {
+    BiquadCascade cascade;
+    cascade.configure(kSampleRate);
+    cascade.setSections({});
+    float in[5] = {1.0f, -2.0f, 3.0f, 0.5f, 0.25f}, out[5];
+    cascade.process(in, out, 5);
+    for (int i = 0; i < 5; ++i) EXPECT_NEAR(out[i], in[i], 0.0);
+}
+
+} // namespace
+
+int main() {
+    testMatchesReference();
+    testResponse();
+    testNoBlockDelay();
+    testSilenceFlushesState();
+    testEmptyPassesThrough();
+    return test::failures();
+}
@@ -0,0 +1,94 @@
+// CallbackStats bucketing, percentiles and reset, plus the SpectralProcessor flow
+// events the callback feeds into it.
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "CallbackStats.h"
+#include "SpectralProcessor.h"
+#include "TestUtil.h"
+
+namespace {
+
+void testPercentiles() {
+    CallbackStats::Snapshot s;
+    s.callbacks = 100;
+    s.histogram[3] = 90;
+    s.histogram[20] = 9;
+    s.histogram[40] = 1;
+    s.maxNs = CallbackStats::bucketUpperNs(40) - 1;
+
+    EXPECT_TRUE(s.percentileNs(0.5) == CallbackStats::bucketUpperNs(3));
+    EXPECT_TRUE(s.percentileNs(0.9) == CallbackStats::bucketUpperNs(3));
+    EXPECT_TRUE(s.percentileNs(0.99) == CallbackStats::bucketUpperNs(20));
+    EXPECT_TRUE(s.percentileNs(1.0) == s.maxNs);   // clamped to the observed max
+    EXPECT_NEAR(CallbackStats::bucketUpperNs(3), 2000.0, 1.0);   // one octave above 1 us
+}
+
+void testRecordAndReset() {
+    CallbackStats stats;
+    for (int i = 0; i < 5; ++i) {
+        stats.beginCallback();
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+        stats.addShortRead();
+        stats.noteDepths(100 + i, 50);
+        stats.endCallback(192);
+    }
+    CallbackStats::Snapshot s = stats.read();
+    EXPECT_TRUE(s.callbacks == 5);
+    EXPECT_TRUE(s.frames == 5 * 192);
+    EXPECT_TRUE(s.shortReads == 5);
+    EXPECT_TRUE(s.inputHighWater == 104);
+    EXPECT_TRUE(s.minNs >= 200000 && s.minNs <= s.maxNs);
+    EXPECT_TRUE(s.percentileNs(0.5) >= s.minNs);
+
+    uint32_t total = 0;
+    for (uint32_t count : s.histogram) total += count;
+    EXPECT_TRUE(total == 5);
+
+    // Takes effect on the next callback
+    stats.requestReset();
+    stats.beginCallback();
+    stats.endCallback(96);
+    s = stats.read();
+    EXPECT_TRUE(s.callbacks == 1);
+    EXPECT_TRUE(s.frames == 96);
+    EXPECT_TRUE(s.shortReads == 0);
+}
+
+void testSpectralFlow() {
+    const int32_t fftSize = 1024;
+    const int32_t burst = 192;
+    SpectralProcessor::Config config;
+    config.fftSize = fftSize;
+    SpectralProcessor processor(config, 48000);
+    std::vector<float> in(4 * fftSize, 0.1f), out(4 * fftSize);
+
+    // Priming zero-fill is not an underrun
+    int32_t underruns = 0;
+    for (int i = 0; i < 100; ++i) {
+        processor.process(in.data(), burst, out.data(), burst);
+        underruns += processor.getLastFlow().underrunFrames;
+        EXPECT_TRUE(processor.getLastFlow().inputDropped == 0);
+    }
+    EXPECT_TRUE(underruns == 0);
+
+    // A short read starves the output
+    processor.process(in.data(), 0, out.data(), 4 * burst);
+    EXPECT_TRUE(processor.getLastFlow().underrunFrames > 0);
+
+    // Input larger than the ring drops the oldest frames
+    processor.process(in.data(), 4 * fftSize, out.data(), 0);
+    EXPECT_TRUE(processor.getLastFlow().inputDropped > 0);
+    EXPECT_TRUE(processor.getLastFlow().inputDepth < fftSize);
+}
+
+} // namespace
+
+int main() {
+    testPercentiles();
+    testRecordAndReset();
+    testSpectralFlow();
+    return test::failures();
+}
@@ -0,0 +1,117 @@
+// Two free-running clocks around DriftCompensator: the mic delivers bursts at
+// 48 kHz * (1 + skew) while the output pulls callbacks at 48 kHz. Over hours of simulated
+// time the backlog must stay near the target with no dropouts, and the loop must settle on
+// the skew.
+
+#include <cmath>
+#include <vector>
+
+#include "DriftCompensator.h"
+#include "TestUtil.h"
+
+namespace {
+
+constexpr int32_t kSampleRate = 48000;
+constexpr int32_t kMicBurst = 96;
+constexpr int32_t kOutputBurst = 192;
+constexpr int32_t kTarget = 2 * kOutputBurst;
+
+struct Result {
+    double minFill = 1e9;
+    double maxFill = -1e9;
+    double meanCorrectionPpm = 0.0;
+    int64_t underruns = 0;
+    int64_t slips = 0;
+    float maxStep = 0.0f;
+};
+
+Result simulate(double skewPpm, double seconds, double settleSeconds) {
+    DriftCompensator compensator;
+    // The PI loop alone; latency-control-test covers the adaptive target
+    compensator.setLatencyControl(false);
+    compensator.configure(kSampleRate, kTarget, kOutputBurst);
+
+    const double micPeriod = kMicBurst / (kSampleRate * (1.0 + skewPpm * 1e-6));
+    const double outputPeriod = (double) kOutputBurst / kSampleRate;
+    // 440 Hz phasor; cheaper than sin() per frame over hours of frames
+    const double w = 2.0 * M_PI * 440.0 / kSampleRate;
+    const double rotRe = std::cos(w), rotIm = std::sin(w);
+    double re = 1.0, im = 0.0;
+
+    std::vector<float> mic(kMicBurst), out(kOutputBurst);
+    double micTime = 0.5 * micPeriod;   // clocks never tick together
+    double outputTime = 0.0;
+    float previous = 0.0f;
+    Result r;
+    int64_t settledUnderruns = 0;
+    int64_t settledSlips = 0;
+    bool settled = false;
+    double correctionSum = 0.0;
+    int64_t settledCallbacks = 0;
+
+    while (outputTime < seconds) {
+        if (micTime <= outputTime) {
+            for (int32_t i = 0; i < kMicBurst; ++i) {
+                mic[i] = 0.5f * (float) im;
+                double nextRe = re * rotRe - im * rotIm;
+                im = re * rotIm + im * rotRe;
+                re = nextRe;
+            }
+            double norm = 1.0 / std::sqrt(re * re + im * im);
+            re *= norm;
+            im *= norm;
+            compensator.write(mic.data(), kMicBurst);
+            micTime += micPeriod;
+            continue;
+        }
+
+        compensator.read(out.data(), kOutputBurst);
+        outputTime += outputPeriod;
+        if (!settled && outputTime >= settleSeconds) {
+            settled = true;
+            settledUnderruns = compensator.getUnderruns();
+            settledSlips = compensator.getSlips();
+            previous = out[0];
+        }
+        if (settled) {
+            double fill = compensator.getFillFrames();
+            r.minFill = std::min(r.minFill, fill);
+            r.maxFill = std::max(r.maxFill, fill);
+            correctionSum += compensator.getCorrectionPpm();
+            ++settledCallbacks;
+            for (int32_t i = 0; i < kOutputBurst; ++i) {
+                r.maxStep = std::max(r.maxStep, std::fabs(out[i] - previous));
+                previous = out[i];
+            }
+        }
+    }
+    r.meanCorrectionPpm = correctionSum / std::max<int64_t>(settledCallbacks, 1);
+    r.underruns = compensator.getUnderruns() - settledUnderruns;
+    r.slips = compensator.getSlips() - settledSlips;
+    return r;
+}
+
+void expectBounded(double skewPpm, double hours) {
+    Result r = simulate(skewPpm, hours * 3600.0, 60.0);
+    printf("skew %+6.0f ppm: fill %.1f..%.1f (target %d), mean correction %+.1f ppm\n",
+           skewPpm, r.minFill, r.maxFill, kTarget, r.meanCorrectionPpm);
+    EXPECT_TRUE(r.underruns == 0);
+    EXPECT_TRUE(r.slips == 0);
+    // The fill is only seen at burst granularity, so it wanders by up to a mic burst
+    // as the two clocks slide past each other; it must not drift beyond that
+    EXPECT_NEAR(r.minFill, kTarget, kMicBurst);
+    EXPECT_NEAR(r.maxFill, kTarget, kMicBurst);
+    EXPECT_NEAR(r.meanCorrectionPpm, skewPpm, 5.0);
+    // No clicks: the 440 Hz tone never moves faster than its own slope
+    const float toneStep = (float) (0.5 * 2.0 * M_PI * 440.0 / kSampleRate);
+    EXPECT_TRUE(r.maxStep <= 1.01f * toneStep);
+}
+
+} // namespace
+
+int main() {
+    expectBounded(200.0, 2.0);
+    expectBounded(-200.0, 2.0);
+    expectBounded(0.0, 0.25);
+    return test::failures();
+}
@@ -0,0 +1,223 @@
+// Accuracy of the kiss_fftr_simd backend against the scalar kiss_fftr output.
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "kiss_fftr.h"
+#include "kiss_fftr_simd.h"
+#include "TestUtil.h"
+
+namespace {
+
+void checkSize(int nfft) {
+    std::mt19937 rng(nfft);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<float> x(nfft);
+    for (auto &s : x) s = dist(rng);
+
+    kiss_fftr_cfg refFwd = kiss_fftr_alloc(nfft, 0, nullptr, nullptr);
+    kiss_fftr_cfg refInv = kiss_fftr_alloc(nfft, 1, nullptr, nullptr);
+    kiss_fftr_simd_cfg fwd = kiss_fftr_simd_alloc(nfft, 0, nullptr, nullptr);
+    kiss_fftr_simd_cfg inv = kiss_fftr_simd_alloc(nfft, 1, nullptr, nullptr);
+
+    const int bins = nfft / 2 + 1;
+    std::vector<kiss_fft_cpx> expected(bins), actual(bins);
+    kiss_fftr(refFwd, x.data(), expected.data());
+    kiss_fftr_simd(fwd, x.data(), actual.data());
+
+    // Errors are relative to the spectrum's peak magnitude (about sqrt(nfft) for noise)
+    double peak = 0.0, err = 0.0;
+    for (int k = 0; k < bins; ++k) {
+        peak = std::max(peak, (double) std::hypot(expected[k].r, expected[k].i));
+        err = std::max(err, (double) std::hypot(expected[k].r - actual[k].r,
+                                                expected[k].i - actual[k].i));
+    }
+    double forwardErr = err / peak;
+
+    // Round trip through both inverses from the same spectrum
+    std::vector<float> yRef(nfft), y(nfft);
+    kiss_fftri(refInv, expected.data(), yRef.data());
+    kiss_fftri_simd(inv, expected.data(), y.data());
+    double inverseErr = 0.0, roundTripErr = 0.0;
+    for (int n = 0; n < nfft; ++n) {
+        inverseErr = std::max(inverseErr, (double) std::fabs(y[n] - yRef[n]) / nfft);
+        roundTripErr = std::max(roundTripErr, (double) std::fabs(y[n] / nfft - x[n]));
+    }
+
+    printf("nfft %5d %-6s forward %.2e inverse %.2e round trip %.2e\n", nfft,
+           kiss_fftr_simd_is_vectorized(fwd) ? "simd" : "scalar",
+           forwardErr, inverseErr, roundTripErr);
+    EXPECT_NEAR(forwardErr, 0.0, 1e-5);
+    EXPECT_NEAR(inverseErr, 0.0, 1e-5);
+    EXPECT_NEAR(roundTripErr, 0.0, 1e-5);
+
+    kiss_fftr_free(refFwd);
+    kiss_fftr_free(refInv);
+    kiss_fftr_simd_free(fwd);
+    kiss_fftr_simd_free(inv);
+}
+
+// Four transforms through the _x4 calls match four single calls.
+void checkBatch(int nfft) {
+    std::mt19937 rng(3 * nfft);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    const int bins = nfft / 2 + 1;
+    std::vector<float> x[4], y[4], yBatch[4];
+    std::vector<kiss_fft_cpx> spectrum[4], spectrumBatch[4];
+    for (int l = 0; l < 4; ++l) {
+        x[l].resize(nfft);
+        for (auto &v : x[l]) v = dist(rng);
+        y[l].resize(nfft);
+        yBatch[l].resize(nfft);
+        spectrum[l].resize(bins);
+        spectrumBatch[l].resize(bins);
+    }
+
+    kiss_fftr_simd_cfg fwd = kiss_fftr_simd_alloc(nfft, 0, nullptr, nullptr);
+    kiss_fftr_simd_cfg inv = kiss_fftr_simd_alloc(nfft, 1, nullptr, nullptr);
+    const kiss_fft_scalar *timeIn[4] = {x[0].data(), x[1].data(), x[2].data(), x[3].data()};
+    kiss_fft_cpx *freqOut[4] = {spectrumBatch[0].data(), spectrumBatch[1].data(),
+                                spectrumBatch[2].data(), spectrumBatch[3].data()};
+    kiss_fftr_simd_x4(fwd, timeIn, freqOut);
+    const kiss_fft_cpx *freqIn[4] = {spectrum[0].data(), spectrum[1].data(),
+                                     spectrum[2].data(), spectrum[3].data()};
+    kiss_fft_scalar *timeOut[4] = {yBatch[0].data(), yBatch[1].data(), yBatch[2].data(), yBatch[3].data()};
+
+    double forwardErr = 0.0, inverseErr = 0.0;
+    for (int l = 0; l < 4; ++l) {
+        kiss_fftr_simd(fwd, x[l].data(), spectrum[l].data());
+        kiss_fftri_simd(inv, spectrum[l].data(), y[l].data());
+        for (int k = 0; k < bins; ++k) {
+            forwardErr = std::max(forwardErr, (double) std::hypot(spectrum[l][k].r - spectrumBatch[l][k].r,
+                                                                  spectrum[l][k].i - spectrumBatch[l][k].i));
+        }
+    }
+    kiss_fftri_simd_x4(inv, freqIn, timeOut);
+    for (int l = 0; l < 4; ++l) {
+        for (int n = 0; n < nfft; ++n) {
+            inverseErr = std::max(inverseErr, (double) std::fabs(y[l][n] - yBatch[l][n]));
+        }
+    }
+
+    // Repeated pointers: one pending frame in all four lanes
+    const kiss_fft_scalar *same[4] = {x[2].data(), x[2].data(), x[2].data(), x[2].data()};
+    std::vector<kiss_fft_cpx> scratch(bins);
+    kiss_fft_cpx *outs[4] = {spectrumBatch[0].data(), scratch.data(), scratch.data(), scratch.data()};
+    kiss_fftr_simd_x4(fwd, same, outs);
+    double repeatErr = 0.0;
+    for (int k = 0; k < bins; ++k) {
+        repeatErr = std::max(repeatErr, (double) std::hypot(spectrum[2][k].r - spectrumBatch[0][k].r,
+                                                            spectrum[2][k].i - spectrumBatch[0][k].i));
+    }
+
+    printf("nfft %5d x4     forward %.2e inverse %.2e\n", nfft, forwardErr / sqrt(nfft),
+           inverseErr / nfft);
+    EXPECT_NEAR(forwardErr / sqrt(nfft), 0.0, 1e-6);
+    EXPECT_NEAR(inverseErr / nfft, 0.0, 1e-6);
+    EXPECT_NEAR(repeatErr / sqrt(nfft), 0.0, 1e-6);
+
+    kiss_fftr_simd_free(fwd);
+    kiss_fftr_simd_free(inv);
+}
+
+// Windowed transform from two spans equals windowing a copy and transforming that,
+// wherever the spans split (including mid-group and on the scalar fallback).
+void checkWindowed(int nfft) {
+    std::mt19937 rng(5 * nfft);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<float> x(nfft), window(nfft), windowed(nfft);
+    for (auto &v : x) v = dist(rng);
+    for (int n = 0; n < nfft; ++n) {
+        window[n] = 0.5f - 0.5f * cosf(2.0f * (float) M_PI * n / nfft);
+        windowed[n] = x[n] * window[n];
+    }
+    kiss_fftr_simd_cfg fwd = kiss_fftr_simd_alloc(nfft, 0, nullptr, nullptr);
+    const int bins = nfft / 2 + 1;
+    std::vector<kiss_fft_cpx> expected(bins), actual(bins);
+    kiss_fftr_simd(fwd, windowed.data(), expected.data());
+
+    double err = 0.0;
+    for (int split : {nfft, 0, 1, 7, 8, nfft / 2 + 3, nfft - 1}) {
+        // second span lives elsewhere, as after a ring wrap
+        std::vector<float> second(x.begin() + split, x.end());
+        kiss_fftr_simd_windowed(fwd, x.data(), split, second.data(), window.data(), actual.data());
+        for (int k = 0; k < bins; ++k) {
+            err = std::max(err, (double) std::hypot(expected[k].r - actual[k].r,
+                                                    expected[k].i - actual[k].i));
+        }
+    }
+    printf("nfft %5d windowed max difference %.2e\n", nfft, err);
+    EXPECT_NEAR(err, 0.0, 0.0);
+    kiss_fftr_simd_free(fwd);
+}
+
+// Pruned inverse of a band-limited spectrum equals the full inverse, for bands at DC,
+// Nyquist, narrow, wide and empty.
+void checkPruned(int nfft) {
+    std::mt19937 rng(7 * nfft);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    const int bins = nfft / 2 + 1;
+    kiss_fftr_simd_cfg inv = kiss_fftr_simd_alloc(nfft, 1, nullptr, nullptr);
+
+    double err = 0.0;
+    const int bands[][2] = {{0, bins}, {0, 1}, {bins - 1, bins}, {3, 10}, {bins / 12, bins / 6},
+                            {bins / 3, bins / 2}, {1, bins - 1}, {bins / 2, bins}, {5, 5}};
+    for (const auto &band : bands) {
+        std::vector<kiss_fft_cpx> spectrum(bins, kiss_fft_cpx{0.0f, 0.0f});
+        for (int k = band[0]; k < band[1]; ++k) spectrum[k] = {dist(rng), dist(rng)};
+        std::vector<float> expected(nfft), actual(nfft, 1.0f);
+        kiss_fftri_simd(inv, spectrum.data(), expected.data());
+        kiss_fftri_simd_pruned(inv, spectrum.data(), band[0], band[1], actual.data());
+        for (int n = 0; n < nfft; ++n) {
+            err = std::max(err, (double) std::fabs(expected[n] - actual[n]));
+        }
+    }
+    printf("nfft %5d pruned inverse max difference %.2e\n", nfft, err);
+    EXPECT_NEAR(err, 0.0, 1e-5);
+    kiss_fftr_simd_free(inv);
+}
+
+void checkNextSize() {
+    EXPECT_TRUE(kiss_fftr_simd_next_size(1) == 32);
+    EXPECT_TRUE(kiss_fftr_simd_next_size(1024) == 1024);
+    EXPECT_TRUE(kiss_fftr_simd_next_size(384) == 384);
+    EXPECT_TRUE(kiss_fftr_simd_next_size(200) == 256);     // 224 = 32 * 7 is not covered
+    for (int n : {100, 480, 1000, 2500}) {
+        int nfft = kiss_fftr_simd_next_size(n);
+        kiss_fftr_simd_cfg cfg = kiss_fftr_simd_alloc(nfft, 0, nullptr, nullptr);
+        EXPECT_TRUE(nfft >= n && kiss_fftr_simd_is_vectorized(cfg));
+        kiss_fftr_simd_free(cfg);
+    }
+}
+
+// The cfg must honour kiss's mem/lenmem contract.
+void checkUserMemory() {
+    size_t len = 0;
+    EXPECT_TRUE(kiss_fftr_simd_alloc(1024, 0, nullptr, &len) == nullptr);
+    EXPECT_TRUE(len > 0);
+    std::vector<float> mem(len / sizeof(float) + 1);
+    size_t small = len - 1;
+    EXPECT_TRUE(kiss_fftr_simd_alloc(1024, 0, mem.data(), &small) == nullptr);
+    kiss_fftr_simd_cfg cfg = kiss_fftr_simd_alloc(1024, 0, mem.data(), &len);
+    EXPECT_TRUE(cfg == (kiss_fftr_simd_cfg) mem.data());
+    EXPECT_TRUE(kiss_fftr_simd_is_vectorized(cfg));
+}
+
+} // namespace
+
+int main() {
+    for (int nfft : {32, 64, 128, 256, 512, 1024, 2048, 4096, 8192}) checkSize(nfft);
+    // mixed radix: twice the common 96, 192, 240 and 480 frame bursts, and 2^a 3^b 5^c
+    for (int nfft : {96, 192, 384, 480, 960, 1920, 3840, 1536, 800, 7200}) checkSize(nfft);
+    // sizes outside the vector kernels take the scalar fallback
+    for (int nfft : {4, 8, 16, 104, 200, 1000}) checkSize(nfft);
+    for (int nfft : {32, 64, 128, 256, 1024, 2048, 8192, 480, 960, 104}) checkBatch(nfft);
+    for (int nfft : {64, 1024, 480, 104}) checkWindowed(nfft);
+    for (int nfft : {32, 64, 128, 512, 1024, 2048, 480, 960, 104}) checkPruned(nfft);
+    checkNextSize();
+    checkUserMemory();
+    EXPECT_TRUE(kiss_fftr_simd_alloc(1023, 0, nullptr, nullptr) == nullptr);
+    return test::failures();
+}
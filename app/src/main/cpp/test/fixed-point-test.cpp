@@ -0,0 +1,172 @@
+// FixedSpectralProcessor against the float SpectralProcessor on the same input and gain
+// curve: same latency, and an SNR (float output as the reference, fixed output as signal
+// plus error) for each frame size, overlap and window on a tone and on noise, with and
+// without a prescription curve. Prints the accuracy table.
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "FixedSpectralProcessor.h"
+#include "SpectralProcessor.h"
+#include "TestUtil.h"
+
+namespace {
+
+constexpr int32_t kSampleRate = 48000;
+constexpr int32_t kBurst = 192;
+
+enum class Signal {
+    Tone,       // 1 kHz at -6 dBFS
+    Noise,      // white at -20 dBFS rms
+};
+
+std::vector<int16_t> makeInput(Signal signal, int32_t frames, float scale) {
+    std::vector<int16_t> x(frames);
+    std::mt19937 rng(7);
+    std::normal_distribution<float> noise(0.0f, 0.1f);
+    for (int32_t n = 0; n < frames; ++n) {
+        float v = signal == Signal::Tone ? 0.5f * sinf(2.0f * (float) M_PI * 1000.0f * n / kSampleRate)
+                                         : noise(rng);
+        x[n] = (int16_t) std::lrintf(std::fmax(std::fmin(v * scale, 1.0f), -1.0f) * 32767.0f);
+    }
+    return x;
+}
+
+// dB of float-path power over the fixed path's difference from it, after the first frame.
+// The float path sees exactly the int16 input, so only the processing differs.
+double measureSnr(SpectralProcessor::Config config, Signal signal,
+                  const std::vector<SpectralGainTable::GainPoint> &curve, float scale,
+                  bool *latencyMatches) {
+    SpectralProcessor reference(config, kSampleRate);
+    FixedSpectralProcessor fixed(config, kSampleRate);
+    reference.getGainTable().setGainCurve(curve);
+    fixed.setGainCurve(curve);
+
+    const int32_t callbacks = 400;
+    std::vector<int16_t> input = makeInput(signal, callbacks * kBurst, scale);
+    std::vector<float> in(kBurst), out(kBurst);
+    std::vector<int16_t> fixedOut(kBurst);
+    double signalPower = 0.0, errorPower = 0.0;
+    for (int32_t c = 0; c < callbacks; ++c) {
+        const int16_t *x = &input[c * kBurst];
+        for (int32_t i = 0; i < kBurst; ++i) in[i] = x[i] / 32768.0f;
+        reference.process(in.data(), kBurst, out.data(), kBurst);
+        fixed.process(x, kBurst, fixedOut.data(), kBurst);
+        if ((c + 1) * kBurst <= 2 * config.fftSize) continue;
+        for (int32_t i = 0; i < kBurst; ++i) {
+            double r = out[i] * 32768.0;
+            double e = fixedOut[i] - r;
+            signalPower += r * r;
+            errorPower += e * e;
+        }
+    }
+    *latencyMatches = reference.getLatencyFrames() == fixed.getLatencyFrames();
+    return 10.0 * std::log10(signalPower / std::fmax(errorPower, 1e-30));
+}
+
+void checkAccuracy() {
+    const std::vector<SpectralGainTable::GainPoint> flat;
+    // A mild-to-moderate high-frequency loss
+    const std::vector<SpectralGainTable::GainPoint> prescription = {
+            {250.0f, 5.0f}, {1000.0f, 10.0f}, {2000.0f, 15.0f}, {4000.0f, 20.0f}, {8000.0f, 20.0f}};
+    struct Case {
+        int32_t fftSize;
+        int32_t overlap;
+        SpectralProcessor::WindowType window;
+    };
+    const Case cases[] = {
+            {256, 2, SpectralProcessor::WindowType::Hann},
+            {480, 2, SpectralProcessor::WindowType::Hann},
+            {1024, 2, SpectralProcessor::WindowType::Hann},
+            {1024, 4, SpectralProcessor::WindowType::Hamming},
+            {2048, 4, SpectralProcessor::WindowType::Blackman},
+            {4096, 2, SpectralProcessor::WindowType::Hann},
+            {8192, 8, SpectralProcessor::WindowType::Hann},
+    };
+
+    printf("%-22s %10s %10s %10s %10s\n", "fft/overlap/window", "tone", "noise", "tone+rx", "noise+rx");
+    for (const Case &c : cases) {
+        SpectralProcessor::Config config;
+        config.fftSize = c.fftSize;
+        config.overlap = c.overlap;
+        config.window = c.window;
+        bool sameLatency[4];
+        // The prescription adds up to 20 dB, so its inputs are 20 dB down
+        double snr[4] = {
+                measureSnr(config, Signal::Tone, flat, 1.0f, &sameLatency[0]),
+                measureSnr(config, Signal::Noise, flat, 1.0f, &sameLatency[1]),
+                measureSnr(config, Signal::Tone, prescription, 0.1f, &sameLatency[2]),
+                measureSnr(config, Signal::Noise, prescription, 0.1f, &sameLatency[3]),
+        };
+        printf("%5d / %d / %-10d %10.1f %10.1f %10.1f %10.1f dB\n", c.fftSize, c.overlap,
+               (int) c.window, snr[0], snr[1], snr[2], snr[3]);
+        for (int i = 0; i < 4; ++i) {
+            EXPECT_TRUE(sameLatency[i]);
+            // int16 output rounding alone is about 90 dB below a -6 dBFS tone and 80 dB below
+            // noise at -20 dBFS; the fixed-point transforms should cost only a little more
+            EXPECT_TRUE(snr[i] > 70.0);
+        }
+    }
+}
+
+// Gain that takes a -6 dBFS tone to just under full scale must not saturate any bin.
+void checkHeadroom() {
+    SpectralProcessor::Config config;
+    config.fftSize = 4096;
+    bool sameLatency = false;
+    double snr = measureSnr(config, Signal::Tone, {{1000.0f, 5.5f}}, 1.0f, &sameLatency);
+    printf("-6 dBFS tone +5.5 dB, fft 4096: %.1f dB\n", snr);
+    EXPECT_TRUE(snr > 70.0);
+    FixedSpectralProcessor fixed(config, kSampleRate);
+    EXPECT_TRUE(fixed.getHeadroomBits() == 11);
+}
+
+// Full-scale clicks 30 dB up: every frame is louder than the inverse transform can take.
+// The output clips, but nothing may wrap, so no loud sample comes out with the wrong sign;
+// the float path's signs are the reference.
+void checkClipping() {
+    for (int32_t overlap : {2, 4, 8}) {
+        SpectralProcessor::Config config;
+        config.fftSize = 1024;
+        config.overlap = overlap;
+        const std::vector<SpectralGainTable::GainPoint> curve = {{1000.0f, 30.0f}};
+        SpectralProcessor reference(config, kSampleRate);
+        FixedSpectralProcessor fixed(config, kSampleRate);
+        reference.getGainTable().setGainCurve(curve);
+        fixed.setGainCurve(curve);
+
+        const int32_t callbacks = 200;
+        std::vector<int16_t> input(callbacks * kBurst, 0);
+        for (size_t n = 0; n < input.size(); n += 7) input[n] = INT16_MAX;
+        std::vector<float> in(kBurst), out(kBurst);
+        std::vector<int16_t> fixedOut(kBurst);
+        int32_t flipped = 0, clipped = 0;
+        for (int32_t c = 0; c < callbacks; ++c) {
+            const int16_t *x = &input[c * kBurst];
+            for (int32_t i = 0; i < kBurst; ++i) in[i] = x[i] / 32768.0f;
+            reference.process(in.data(), kBurst, out.data(), kBurst);
+            fixed.process(x, kBurst, fixedOut.data(), kBurst);
+            for (int32_t i = 0; i < kBurst; ++i) {
+                const double r = out[i] * 32768.0;
+                if (std::fabs(r) < 32768.0) continue;
+                if ((r > 0.0) != (fixedOut[i] > 0)) ++flipped;
+                if (fixedOut[i] == INT16_MAX || fixedOut[i] == INT16_MIN) ++clipped;
+            }
+        }
+        printf("full-scale clicks +30 dB, overlap %d: %d clipped, %d wrong sign\n", overlap, clipped,
+               flipped);
+        EXPECT_TRUE(clipped > 0);
+        EXPECT_TRUE(flipped == 0);
+    }
+}
+
+} // namespace
+
+int main() {
+    checkAccuracy();
+    checkHeadroom();
+    checkClipping();
+    return test::failures();
+}
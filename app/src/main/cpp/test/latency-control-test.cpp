@@ -0,0 +1,142 @@
+// DriftCompensator's latency control against jittery mic delivery: starting from a
+// deliberately large backlog it must trim down to what the jitter actually needs, then
+// hold there with no dropouts and no clicks. A mic that stalls and then delivers its
+// backlog in one oversized write must not hold the latency up once the write is past.
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "DriftCompensator.h"
+#include "TestUtil.h"
+
+namespace {
+
+constexpr int32_t kSampleRate = 48000;
+constexpr int32_t kMicBurst = 96;
+constexpr int32_t kOutputBurst = 192;
+constexpr int32_t kStartTarget = 4096;
+
+struct Result {
+    double meanFill = 0.0;
+    int32_t finalTarget = 0;
+    int64_t lateUnderruns = 0;
+    int64_t drops = 0;
+    float maxStep = 0.0f;
+    int32_t peakMargin = 0;
+    int32_t finalMargin = 0;
+};
+
+// Mic bursts arrive up to jitterMs late (never out of order); output callbacks are regular.
+// From stallAt for stallSeconds the mic delivers nothing, then everything at once.
+Result simulate(double jitterMs, double seconds, double stallAt = -1.0, double stallSeconds = 0.0) {
+    DriftCompensator compensator;
+    compensator.configure(kSampleRate, kStartTarget, kOutputBurst);
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<double> jitter(0.0, jitterMs * 1e-3);
+    const double micPeriod = kMicBurst / (kSampleRate * (1.0 + 100e-6));
+    const double outputPeriod = (double) kOutputBurst / kSampleRate;
+    const double w = 2.0 * M_PI * 440.0 / kSampleRate;
+    const double rotRe = std::cos(w), rotIm = std::sin(w);
+    double re = 1.0, im = 0.0;
+
+    std::vector<float> mic(kMicBurst), out(kOutputBurst);
+    std::vector<float> stalled;
+    double nominal = 0.5 * micPeriod;
+    double arrival = nominal + jitter(rng);
+    double outputTime = 0.0;
+    float previous = 0.0f;
+    const double settleSeconds = seconds / 2;
+    int64_t settledUnderruns = -1;
+    double fillSum = 0.0;
+    int64_t fillCount = 0;
+    Result r;
+
+    while (outputTime < seconds) {
+        if (arrival <= outputTime) {
+            for (int32_t i = 0; i < kMicBurst; ++i) {
+                mic[i] = 0.5f * (float) im;
+                double nextRe = re * rotRe - im * rotIm;
+                im = re * rotIm + im * rotRe;
+                re = nextRe;
+            }
+            if (arrival >= stallAt && arrival < stallAt + stallSeconds) {
+                stalled.insert(stalled.end(), mic.begin(), mic.end());
+            } else if (!stalled.empty()) {
+                stalled.insert(stalled.end(), mic.begin(), mic.end());
+                compensator.write(stalled.data(), (int32_t) stalled.size());
+                stalled.clear();
+            } else {
+                compensator.write(mic.data(), kMicBurst);
+            }
+            r.peakMargin = std::max(r.peakMargin, compensator.getMarginFrames());
+            nominal += micPeriod;
+            arrival = std::max(arrival, nominal + jitter(rng));
+            continue;
+        }
+
+        compensator.read(out.data(), kOutputBurst);
+        outputTime += outputPeriod;
+        if (outputTime >= settleSeconds) {
+            if (settledUnderruns < 0) settledUnderruns = compensator.getUnderruns();
+            fillSum += compensator.getFillFrames();
+            ++fillCount;
+        }
+        if (outputTime >= 1.0) {
+            // Only dropouts may click; those are counted separately
+            for (int32_t i = 0; i < kOutputBurst; ++i) {
+                if (compensator.getUnderruns() == 0) {
+                    r.maxStep = std::max(r.maxStep, std::fabs(out[i] - previous));
+                }
+                previous = out[i];
+            }
+        } else {
+            previous = out[kOutputBurst - 1];
+        }
+    }
+    r.meanFill = fillSum / std::max<int64_t>(fillCount, 1);
+    r.finalTarget = compensator.getTargetFrames();
+    r.lateUnderruns = compensator.getUnderruns() - settledUnderruns;
+    r.drops = compensator.getDrops();
+    r.finalMargin = compensator.getMarginFrames();
+    return r;
+}
+
+void expectTrimmed(double jitterMs) {
+    Result r = simulate(jitterMs, 600.0);
+    const double jitterFrames = jitterMs * 1e-3 * kSampleRate;
+    printf("jitter %.1f ms: mean backlog %.1f frames (%.2f ms), target %d, %lld drops\n",
+           jitterMs, r.meanFill, 1e3 * r.meanFill / kSampleRate, r.finalTarget,
+           (long long) r.drops);
+    EXPECT_TRUE(r.drops > 0);
+    EXPECT_TRUE(r.lateUnderruns == 0);
+    // One output callback, one mic burst and the jitter, plus a modest safety margin
+    EXPECT_TRUE(r.meanFill < kOutputBurst + kMicBurst + jitterFrames + 128);
+    EXPECT_TRUE(r.meanFill > kOutputBurst);
+    const float toneStep = (float) (0.5 * 2.0 * M_PI * 440.0 / kSampleRate);
+    EXPECT_TRUE(r.maxStep <= 1.5f * toneStep);
+}
+
+// 40 ms without mic audio, then one 2k-frame write, as after a stall or a priming read
+void expectRecoversFromOversizedWrite() {
+    const double jitterMs = 2.0;
+    Result r = simulate(jitterMs, 120.0, 10.0, 0.04);
+    const double jitterFrames = jitterMs * 1e-3 * kSampleRate;
+    printf("oversized write: margin peak %d, final %d, mean backlog %.1f frames, target %d\n",
+           r.peakMargin, r.finalMargin, r.meanFill, r.finalTarget);
+    EXPECT_TRUE(r.peakMargin > 1024);
+    EXPECT_TRUE(r.finalMargin < kMicBurst + 128);
+    EXPECT_TRUE(r.lateUnderruns == 0);
+    EXPECT_TRUE(r.meanFill < kOutputBurst + kMicBurst + jitterFrames + 128);
+}
+
+} // namespace
+
+int main() {
+    expectTrimmed(0.0);
+    expectTrimmed(2.0);
+    expectTrimmed(5.0);
+    expectRecoversFromOversizedWrite();
+    return test::failures();
+}
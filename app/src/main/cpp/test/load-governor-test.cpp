@@ -0,0 +1,148 @@
+// LoadGovernor against synthetic callback costs: stepping down under sustained load but
+// not on isolated spikes, the hysteresis band, timed recovery, the backoff that keeps
+// a device at a boundary from oscillating, and stepping over levels marked unavailable.
+
+#include <cstdio>
+
+#include "LoadGovernor.h"
+#include "TestUtil.h"
+
+namespace {
+
+constexpr int32_t kSampleRate = 48000;
+constexpr int32_t kBurst = 192;
+constexpr double kPeriodNs = 1e9 * kBurst / kSampleRate;
+
+using Level = LoadGovernor::Level;
+
+// Feeds callbacks at a fixed load for a while; returns the number of level changes.
+int run(LoadGovernor &governor, double load, double seconds) {
+    int changes = 0;
+    const int64_t callbacks = (int64_t) (seconds * kSampleRate / kBurst);
+    for (int64_t i = 0; i < callbacks; ++i) {
+        changes += governor.update((int64_t) (load * kPeriodNs), kBurst);
+    }
+    return changes;
+}
+
+// Feeds callbacks at a fixed load until the governor reaches a level (or gives up).
+void runUntil(LoadGovernor &governor, double load, Level level) {
+    for (int i = 0; i < 100000 && governor.getLevel() != level; ++i) {
+        governor.update((int64_t) (load * kPeriodNs), kBurst);
+    }
+}
+
+void checkLightLoadStaysFull() {
+    LoadGovernor governor;
+    governor.configure(kSampleRate);
+    EXPECT_TRUE(run(governor, 0.2, 10.0) == 0);
+    EXPECT_TRUE(governor.getLevel() == Level::Full);
+}
+
+// One callback near the deadline in every 32 is jitter, not pressure.
+void checkSpikesAreIgnored() {
+    LoadGovernor governor;
+    governor.configure(kSampleRate);
+    for (int i = 0; i < 3000; ++i) {
+        double load = i % 32 == 0 ? 1.5 : 0.2;
+        governor.update((int64_t) (load * kPeriodNs), kBurst);
+    }
+    EXPECT_TRUE(governor.getLevel() == Level::Full);
+}
+
+void checkStepsDownToBypass() {
+    LoadGovernor governor;
+    governor.configure(kSampleRate);
+    LoadGovernor::Params params;
+
+    // The first step comes within a window of callbacks
+    int32_t callbacks = 0;
+    while (governor.getLevel() == Level::Full && callbacks < 100) {
+        governor.update((int64_t) (0.9 * kPeriodNs), kBurst);
+        ++callbacks;
+    }
+    EXPECT_TRUE(governor.getLevel() == Level::SmallerFft);
+    EXPECT_TRUE(callbacks == params.stepDownCount);
+
+    // The rest one at a time, each after its settle time, never past Bypass
+    EXPECT_TRUE(run(governor, 0.9, params.settleSeconds * 0.9) == 0);
+    EXPECT_TRUE(run(governor, 0.9, 10.0) == LoadGovernor::kNumLevels - 2);
+    EXPECT_TRUE(governor.getLevel() == Level::Bypass);
+    EXPECT_TRUE(governor.getStepDowns() == LoadGovernor::kNumLevels - 1);
+    EXPECT_TRUE(governor.getStepUps() == 0);
+}
+
+// Between the two thresholds nothing moves; below stepUpLoad it climbs one level per hold.
+void checkHysteresisAndRecovery() {
+    LoadGovernor governor;
+    governor.configure(kSampleRate);
+    LoadGovernor::Params params;
+    run(governor, 0.9, 0.5);
+    EXPECT_TRUE(governor.getLevel() == Level::SmallerFft);
+
+    EXPECT_TRUE(run(governor, 0.5, 20.0) == 0);
+    EXPECT_TRUE(governor.getLevel() == Level::SmallerFft);
+
+    EXPECT_TRUE(run(governor, 0.1, params.stepUpSeconds * 0.9) == 0);
+    EXPECT_TRUE(run(governor, 0.1, params.stepUpSeconds * 0.2) == 1);
+    EXPECT_TRUE(governor.getLevel() == Level::Full);
+    EXPECT_TRUE(governor.getStepUps() == 1);
+}
+
+// Knocked back down right after a step up, the next try waits twice as long.
+void checkBackoff() {
+    LoadGovernor governor;
+    governor.configure(kSampleRate);
+    LoadGovernor::Params params;
+    runUntil(governor, 0.9, Level::FewerBands);
+    runUntil(governor, 0.1, Level::SmallerFft);
+    runUntil(governor, 0.9, Level::FewerBands);
+    EXPECT_TRUE(governor.getStepUps() == 1);
+
+    // Settle, then twice the hold
+    const double settle = params.settleSeconds;
+    EXPECT_TRUE(run(governor, 0.1, settle + params.stepUpSeconds * 1.9) == 0);
+    EXPECT_TRUE(run(governor, 0.1, params.stepUpSeconds * 0.2) == 1);
+    EXPECT_TRUE(governor.getLevel() == Level::SmallerFft);
+    printf("backoff: %lld down, %lld up\n", (long long) governor.getStepDowns(),
+           (long long) governor.getStepUps());
+}
+
+// With no compressor the two band rungs would change nothing: one step from SmallerFft to
+// Bypass, and one back.
+void checkSkipsUnavailableLevels() {
+    LoadGovernor governor;
+    governor.configure(kSampleRate);
+    governor.setAvailable(Level::FewerBands, false);
+    governor.setAvailable(Level::NoCompressor, false);
+    governor.setAvailable(Level::Bypass, false);
+    EXPECT_TRUE(governor.isAvailable(Level::Bypass));
+
+    runUntil(governor, 0.9, Level::SmallerFft);
+    EXPECT_TRUE(run(governor, 0.9, 5.0) == 1);
+    EXPECT_TRUE(governor.getLevel() == Level::Bypass);
+    EXPECT_TRUE(governor.getStepDowns() == 2);
+
+    runUntil(governor, 0.1, Level::SmallerFft);
+    EXPECT_TRUE(governor.getStepUps() == 1);
+    EXPECT_TRUE(run(governor, 0.1, 10.0) == 1);
+    EXPECT_TRUE(governor.getLevel() == Level::Full);
+
+    // Back on, the ladder has all its rungs again
+    governor.setAvailable(Level::FewerBands, true);
+    runUntil(governor, 0.9, Level::SmallerFft);
+    EXPECT_TRUE(run(governor, 0.9, 0.6) == 1);
+    EXPECT_TRUE(governor.getLevel() == Level::FewerBands);
+}
+
+} // namespace
+
+int main() {
+    checkLightLoadStaysFull();
+    checkSpikesAreIgnored();
+    checkStepsDownToBypass();
+    checkHysteresisAndRecovery();
+    checkBackoff();
+    checkSkipsUnavailableLevels();
+    return test::failures();
+}
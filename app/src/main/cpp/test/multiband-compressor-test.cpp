@@ -0,0 +1,164 @@
+// Offline checks of MultibandCompressor with stepped-level tones: the static
+// input/output curve and the attack/release times, plus the band merge the load governor
+// uses.
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "MultibandCompressor.h"
+#include "fft_backend.h"
+#include "TestUtil.h"
+
+namespace {
+
+constexpr int32_t kFftSize = 1024;
+constexpr int32_t kHop = kFftSize / 2;
+constexpr int32_t kSampleRate = 48000;
+constexpr int32_t kBands = 8;
+constexpr int32_t kBand = 4;
+
+struct Harness {
+    std::vector<float> window;
+    float windowSumSquares = 0.0f;
+    fft_backend_cfg fft;
+    std::vector<float> frame;
+    std::vector<kiss_fft_cpx> spectrum;
+    MultibandCompressor compressor;
+    float toneHz;
+
+    Harness() : window(kFftSize), frame(kFftSize), spectrum(kFftSize / 2 + 1) {
+        for (int i = 0; i < kFftSize; ++i) {
+            window[i] = 0.5f - 0.5f * cosf(2.0f * M_PI * i / (kFftSize - 1));
+            windowSumSquares += window[i] * window[i];
+        }
+        fft = fft_backend_alloc(kFftSize, 0, nullptr, nullptr);
+        compressor.configure(kBands, kFftSize, kHop, kSampleRate, windowSumSquares);
+
+        // Put the tone on the centre bin of kBand, where the applied gain is exactly that band's
+        const float binHz = (float) kSampleRate / kFftSize;
+        float centreHz = 125.0f * powf(18000.0f / 125.0f, (kBand + 0.5f) / kBands);
+        toneHz = lroundf(centreHz / binHz) * binHz;
+    }
+
+    ~Harness() { fft_backend_free(fft); }
+
+    // Runs one frame of a tone of the given amplitude starting at sample `start`;
+    // returns the gain in dB applied to the tone's bin.
+    float runFrame(float amplitude, int64_t start) {
+        for (int i = 0; i < kFftSize; ++i) {
+            frame[i] = amplitude * sinf(2.0f * M_PI * toneHz * (start + i) / kSampleRate) * window[i];
+        }
+        fft_backend_fftr(fft, frame.data(), spectrum.data());
+        const kiss_fft_cpx &bin = spectrum[lroundf(toneHz * kFftSize / kSampleRate)];
+        double before = bin.r * bin.r + bin.i * bin.i;
+        compressor.process(spectrum.data());
+        double after = bin.r * bin.r + bin.i * bin.i;
+        return (float) (10.0 * log10(after / before));
+    }
+};
+
+void checkStaticCurve() {
+    Harness h;
+    MultibandCompressor::BandParams params;
+    params.thresholdDb = -40.0f;
+    params.ratio = 3.0f;
+    params.attackMs = 5.0f;
+    params.releaseMs = 50.0f;
+    params.gainDb = 6.0f;
+    h.compressor.setAllBands(params);
+
+    int64_t t = 0;
+    for (float inputDb = -70.0f; inputDb <= -5.0f; inputDb += 5.0f) {
+        float amplitude = powf(10.0f, inputDb / 20.0f);
+        float gainDb = 0.0f;
+        for (int i = 0; i < 100; ++i, t += kHop) gainDb = h.runFrame(amplitude, t);
+        float expected = h.compressor.staticOutputDb(kBand, inputDb) - inputDb;
+        printf("in %6.1f dB -> out %6.1f dB (expected %6.1f)\n",
+               inputDb, inputDb + gainDb, inputDb + expected);
+        EXPECT_NEAR(gainDb, expected, 0.5);
+    }
+}
+
+// Frames until the band gain covers 1 - 1/e of the step from `from` to `to`.
+float timeConstantMs(const std::vector<float> &gains, float from, float to) {
+    float target = from + (to - from) * (1.0f - expf(-1.0f));
+    for (size_t i = 0; i < gains.size(); ++i) {
+        bool reached = to < from ? gains[i] <= target : gains[i] >= target;
+        if (reached) return (i + 1) * 1000.0f * kHop / kSampleRate;
+    }
+    return 1e9f;
+}
+
+void checkAttackRelease() {
+    Harness h;
+    MultibandCompressor::BandParams params;
+    params.thresholdDb = -40.0f;
+    params.ratio = 4.0f;
+    params.attackMs = 100.0f;
+    params.releaseMs = 500.0f;
+    h.compressor.setAllBands(params);
+
+    const float quiet = powf(10.0f, -60.0f / 20.0f);
+    const float loud = powf(10.0f, -20.0f / 20.0f);
+    // Step the tone on frame boundaries so every frame sees a single level
+    int64_t t = 0;
+    for (int i = 0; i < 200; ++i, t += kHop) h.runFrame(quiet, t);
+    float quietGain = h.compressor.currentGainDb(kBand);
+    std::vector<float> attack, release;
+    for (int i = 0; i < 200; ++i, t += kHop) {
+        h.runFrame(loud, t);
+        attack.push_back(h.compressor.currentGainDb(kBand));
+    }
+    float loudGain = h.compressor.currentGainDb(kBand);
+    for (int i = 0; i < 400; ++i, t += kHop) {
+        h.runFrame(quiet, t);
+        release.push_back(h.compressor.currentGainDb(kBand));
+    }
+
+    const float frameMs = 1000.0f * kHop / kSampleRate;
+    float attackMs = timeConstantMs(attack, quietGain, loudGain);
+    float releaseMs = timeConstantMs(release, loudGain, quietGain);
+    printf("gain %.1f -> %.1f dB, attack %.1f ms, release %.1f ms (frame %.1f ms)\n",
+           quietGain, loudGain, attackMs, releaseMs, frameMs);
+    EXPECT_NEAR(quietGain, 0.0, 0.1);
+    EXPECT_NEAR(loudGain, -15.0, 0.5);
+    EXPECT_NEAR(attackMs, params.attackMs, frameMs);
+    EXPECT_NEAR(releaseMs, params.releaseMs, frameMs);
+}
+
+// Disabled (0 bands) must leave the spectrum untouched.
+void checkBypass() {
+    Harness h;
+    h.compressor.configure(0, kFftSize, kHop, kSampleRate, h.windowSumSquares);
+    EXPECT_NEAR(h.runFrame(1.0f, 0), 0.0, 1e-6);
+}
+
+// Pairs average, the fastest attack wins, an odd band passes through.
+void checkMergeBands() {
+    std::vector<MultibandCompressor::BandParams> bands(5);
+    for (int b = 0; b < 5; ++b) {
+        bands[b].thresholdDb = -50.0f + 10.0f * b;
+        bands[b].ratio = 1.0f + b;
+        bands[b].attackMs = 5.0f + b;
+    }
+    auto merged = MultibandCompressor::mergeBands(bands, 3);
+    EXPECT_TRUE(merged.size() == 3);
+    EXPECT_NEAR(merged[0].thresholdDb, -45.0, 1e-6);
+    EXPECT_NEAR(merged[1].ratio, 3.5, 1e-6);
+    EXPECT_NEAR(merged[1].attackMs, 7.0, 1e-6);
+    EXPECT_NEAR(merged[2].thresholdDb, -10.0, 1e-6);
+    EXPECT_TRUE(MultibandCompressor::mergeBands(bands, 2).size() == 2);
+    EXPECT_TRUE(MultibandCompressor::mergeBands(bands, 8).size() == 5);
+    EXPECT_TRUE(MultibandCompressor::mergeBands(bands, 0).empty());
+}
+
+} // namespace
+
+int main() {
+    checkStaticCurve();
+    checkAttackRelease();
+    checkBypass();
+    checkMergeBands();
+    return test::failures();
+}
@@ -0,0 +1,209 @@
+// Multichannel processing must be mono processing run per channel: Interleave round-trips
+// every channel count, and a SpectralProcessor, DriftCompensator or PolyphaseResampler
+// given N interleaved channels must produce, channel by channel, exactly what N mono
+// instances produce from the same signals. Each channel gets different content (and for
+// the spectral path a different gain curve) so crosstalk or shared state would show.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "DriftCompensator.h"
+#include "Interleave.h"
+#include "PolyphaseResampler.h"
+#include "SpectralProcessor.h"
+#include "TestUtil.h"
+
+namespace {
+
+constexpr int32_t kSampleRate = 48000;
+constexpr int32_t kMaxChunk = 256;
+
+// A different tone and level per channel
+std::vector<float> channelSignal(int32_t channel, int32_t frames) {
+    std::vector<float> x(frames);
+    const double hz = 220.0 * (channel + 1) + 37.0 * channel;
+    const double amplitude = 0.5 / (channel + 1);
+    for (int32_t i = 0; i < frames; ++i) x[i] = (float) (amplitude * sin(2.0 * M_PI * hz * i / kSampleRate));
+    return x;
+}
+
+std::vector<float> interleave(const std::vector<std::vector<float>> &planar) {
+    const int32_t channels = (int32_t) planar.size();
+    const int32_t frames = (int32_t) planar[0].size();
+    std::vector<float> out((size_t) frames * channels);
+    for (int32_t i = 0; i < frames; ++i) {
+        for (int32_t c = 0; c < channels; ++c) out[(size_t) i * channels + c] = planar[c][i];
+    }
+    return out;
+}
+
+// Samples of channel c in interleaved that differ from mono
+int32_t mismatches(const std::vector<float> &interleaved, int32_t channels, int32_t c,
+                   const std::vector<float> &mono) {
+    int32_t count = 0;
+    for (size_t i = 0; i < mono.size(); ++i) {
+        if (interleaved[i * channels + c] != mono[i]) ++count;
+    }
+    return count;
+}
+
+void checkInterleave() {
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> sample(-1.0f, 1.0f);
+    for (int32_t channels = 1; channels <= 8; ++channels) {
+        for (int32_t frames : {0, 1, 2, 3, 4, 5, 7, 8, 9, 11, 37}) {
+            std::vector<float> interleaved((size_t) frames * channels);
+            for (float &x : interleaved) x = sample(rng);
+            std::vector<std::vector<float>> planar(channels, std::vector<float>(frames));
+            std::vector<float *> pointers;
+            for (auto &p : planar) pointers.push_back(p.data());
+
+            Interleave::toPlanar(interleaved.data(), channels, frames, pointers.data());
+            int32_t wrong = 0;
+            for (int32_t i = 0; i < frames; ++i) {
+                for (int32_t c = 0; c < channels; ++c) {
+                    if (planar[c][i] != interleaved[(size_t) i * channels + c]) ++wrong;
+                }
+            }
+            std::vector<float> back((size_t) frames * channels, 0.0f);
+            Interleave::fromPlanar(pointers.data(), channels, frames, back.data());
+            EXPECT_TRUE(wrong == 0);
+            EXPECT_TRUE(back == interleaved);
+        }
+    }
+}
+
+void checkSpectral(int32_t channels) {
+    const int32_t frames = kSampleRate / 2;
+    SpectralProcessor::Config config;
+    config.fftSize = 512;
+    config.overlap = 4;
+    MultibandCompressor::BandParams band;
+    band.ratio = 3.0f;
+    const std::vector<MultibandCompressor::BandParams> bands(4, band);
+    // Uneven callbacks, the same sequence for every processor
+    auto run = [&](SpectralProcessor &processor, const float *input, float *output, int32_t stride) {
+        std::mt19937 rng(5);
+        std::uniform_int_distribution<int32_t> chunk(1, kMaxChunk);
+        for (int32_t at = 0; at < frames;) {
+            const int32_t n = std::min(chunk(rng), frames - at);
+            processor.process(input + (size_t) at * stride, n, output + (size_t) at * stride, n);
+            at += n;
+        }
+    };
+
+    std::vector<std::vector<float>> inputs;
+    std::vector<std::vector<float>> monoOutputs;
+    for (int32_t c = 0; c < channels; ++c) {
+        inputs.push_back(channelSignal(c, frames));
+        SpectralProcessor mono(config, kSampleRate);
+        mono.setCompressorBands(bands);
+        mono.getGainTable().setGainCurve({{1000.0f, 6.0f * c}});
+        std::vector<float> out(frames);
+        run(mono, inputs[c].data(), out.data(), 1);
+        monoOutputs.push_back(std::move(out));
+    }
+
+    SpectralProcessor multi(config, kSampleRate, channels);
+    multi.setCompressorBands(bands);
+    for (int32_t c = 0; c < channels; ++c) multi.getGainTable(c).setGainCurve({{1000.0f, 6.0f * c}});
+    const std::vector<float> input = interleave(inputs);
+    std::vector<float> output(input.size());
+    run(multi, input.data(), output.data(), channels);
+    EXPECT_TRUE(multi.getChannelCount() == channels);
+    for (int32_t c = 0; c < channels; ++c) {
+        EXPECT_TRUE(mismatches(output, channels, c, monoOutputs[c]) == 0);
+    }
+}
+
+void checkDrift(int32_t channels) {
+    const int32_t frames = kSampleRate / 4;
+    const int32_t burst = 192;
+    // The writer runs 200 ppm fast against the reader, so the ratio moves
+    auto drive = [&](DriftCompensator &drift, const float *input, float *output, int32_t stride) {
+        int32_t written = 0, read = 0;
+        double writerClock = 0.0;
+        while (read + burst <= frames) {
+            writerClock += burst * 1.0002;
+            const int32_t n = std::min((int32_t) writerClock - written, frames - written);
+            if (n > 0) drift.write(input + (size_t) written * stride, n);
+            written += std::max(n, 0);
+            drift.read(output + (size_t) read * stride, burst);
+            read += burst;
+        }
+    };
+
+    std::vector<std::vector<float>> inputs;
+    std::vector<std::vector<float>> monoOutputs;
+    for (int32_t c = 0; c < channels; ++c) {
+        inputs.push_back(channelSignal(c, frames));
+        DriftCompensator mono;
+        mono.configure(kSampleRate, 2 * burst, burst * 2);
+        std::vector<float> out(frames, 0.0f);
+        drive(mono, inputs[c].data(), out.data(), 1);
+        monoOutputs.push_back(std::move(out));
+    }
+
+    DriftCompensator multi;
+    multi.configure(kSampleRate, 2 * burst, burst * 2, channels);
+    const std::vector<float> input = interleave(inputs);
+    std::vector<float> output(input.size(), 0.0f);
+    drive(multi, input.data(), output.data(), channels);
+    EXPECT_TRUE(multi.getChannelCount() == channels);
+    for (int32_t c = 0; c < channels; ++c) {
+        EXPECT_TRUE(mismatches(output, channels, c, monoOutputs[c]) == 0);
+    }
+}
+
+void checkResampler(int32_t channels) {
+    const int32_t frames = 44100 / 4;
+    auto push = [&](PolyphaseResampler &resampler, const float *input, int32_t stride) {
+        std::vector<float> output;
+        std::vector<float> block((size_t) resampler.outputCapacityFor(kMaxChunk) * stride);
+        std::mt19937 rng(9);
+        std::uniform_int_distribution<int32_t> chunk(1, kMaxChunk);
+        for (int32_t at = 0; at < frames;) {
+            const int32_t n = std::min(chunk(rng), frames - at);
+            const int32_t produced = resampler.process(input + (size_t) at * stride, n, block.data(),
+                                                       resampler.outputCapacityFor(n));
+            output.insert(output.end(), block.begin(), block.begin() + (size_t) produced * stride);
+            at += n;
+        }
+        return output;
+    };
+
+    std::vector<std::vector<float>> inputs;
+    std::vector<std::vector<float>> monoOutputs;
+    for (int32_t c = 0; c < channels; ++c) {
+        inputs.push_back(channelSignal(c, frames));
+        PolyphaseResampler mono;
+        mono.configure(44100, kSampleRate, kMaxChunk);
+        monoOutputs.push_back(push(mono, inputs[c].data(), 1));
+    }
+
+    PolyphaseResampler multi;
+    multi.configure(44100, kSampleRate, kMaxChunk, channels);
+    const std::vector<float> input = interleave(inputs);
+    const std::vector<float> output = push(multi, input.data(), channels);
+    EXPECT_TRUE(multi.getChannelCount() == channels);
+    EXPECT_TRUE(output.size() == monoOutputs[0].size() * channels);
+    if (output.size() != monoOutputs[0].size() * channels) return;
+    for (int32_t c = 0; c < channels; ++c) {
+        EXPECT_TRUE(mismatches(output, channels, c, monoOutputs[c]) == 0);
+    }
+}
+
+} // namespace
+
+int main() {
+    checkInterleave();
+    for (int32_t channels : {2, 3, 4}) {
+        checkSpectral(channels);
+        checkDrift(channels);
+        checkResampler(channels);
+    }
+    return test::failures();
+}
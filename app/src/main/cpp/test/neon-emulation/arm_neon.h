@@ -0,0 +1,211 @@
+#ifndef OBOEPASSTHROUGH_NEON_EMULATION_ARM_NEON_H
+#define OBOEPASSTHROUGH_NEON_EMULATION_ARM_NEON_H
+
+/**
+ * Lane-by-lane stand-in for <arm_neon.h>, just the intrinsics SimdVec4.h and
+ * SampleConverter.cpp use, so their NEON branches build and run on an x86 host
+ * (PASSTHROUGH_NEON_EMULATION). Each intrinsic follows the ARM reference semantics,
+ * including the saturating conversions and the fused multiply-add. Correctness only:
+ * it says nothing about NEON speed, and a real aarch64 build is still the final word.
+ */
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#error "test/neon-emulation/arm_neon.h shadows the real header on an ARM target"
+#endif
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+typedef float float32x4_t __attribute__((vector_size(16)));
+typedef float float32x2_t __attribute__((vector_size(8)));
+typedef int32_t int32x4_t __attribute__((vector_size(16)));
+typedef uint32_t uint32x4_t __attribute__((vector_size(16)));
+typedef int16_t int16x4_t __attribute__((vector_size(8)));
+
+typedef struct {
+    float32x4_t val[2];
+} float32x4x2_t;
+
+// ---- loads and stores ----
+
+static inline float32x4_t vld1q_f32(const float *p) {
+    float32x4_t r;
+    memcpy(&r, p, sizeof(r));
+    return r;
+}
+
+static inline void vst1q_f32(float *p, float32x4_t v) { memcpy(p, &v, sizeof(v)); }
+
+static inline int32x4_t vld1q_s32(const int32_t *p) {
+    int32x4_t r;
+    memcpy(&r, p, sizeof(r));
+    return r;
+}
+
+static inline void vst1q_s32(int32_t *p, int32x4_t v) { memcpy(p, &v, sizeof(v)); }
+
+static inline uint32x4_t vld1q_u32(const uint32_t *p) {
+    uint32x4_t r;
+    memcpy(&r, p, sizeof(r));
+    return r;
+}
+
+static inline void vst1q_u32(uint32_t *p, uint32x4_t v) { memcpy(p, &v, sizeof(v)); }
+
+static inline int16x4_t vld1_s16(const int16_t *p) {
+    int16x4_t r;
+    memcpy(&r, p, sizeof(r));
+    return r;
+}
+
+static inline void vst1_s16(int16_t *p, int16x4_t v) { memcpy(p, &v, sizeof(v)); }
+
+// p[0,2,4,6] -> val[0], p[1,3,5,7] -> val[1]
+static inline float32x4x2_t vld2q_f32(const float *p) {
+    float32x4x2_t r;
+    for (int i = 0; i < 4; ++i) {
+        r.val[0][i] = p[2 * i];
+        r.val[1][i] = p[2 * i + 1];
+    }
+    return r;
+}
+
+static inline void vst2q_f32(float *p, float32x4x2_t v) {
+    for (int i = 0; i < 4; ++i) {
+        p[2 * i] = v.val[0][i];
+        p[2 * i + 1] = v.val[1][i];
+    }
+}
+
+// ---- float arithmetic ----
+
+static inline float32x4_t vdupq_n_f32(float x) { return (float32x4_t) {x, x, x, x}; }
+static inline float32x4_t vaddq_f32(float32x4_t a, float32x4_t b) { return a + b; }
+static inline float32x4_t vsubq_f32(float32x4_t a, float32x4_t b) { return a - b; }
+static inline float32x4_t vmulq_f32(float32x4_t a, float32x4_t b) { return a * b; }
+static inline float32x4_t vmulq_n_f32(float32x4_t a, float b) { return a * vdupq_n_f32(b); }
+static inline float32x4_t vnegq_f32(float32x4_t a) { return -a; }
+
+// c + a * b, rounded after the multiply (ARMv7 VMLA)
+static inline float32x4_t vmlaq_f32(float32x4_t c, float32x4_t a, float32x4_t b) {
+    const float32x4_t p = a * b;
+    return c + p;
+}
+
+// c + a * b, rounded once (AArch64 FMLA)
+static inline float32x4_t vfmaq_f32(float32x4_t c, float32x4_t a, float32x4_t b) {
+    float32x4_t r;
+    for (int i = 0; i < 4; ++i) r[i] = fmaf(a[i], b[i], c[i]);
+    return r;
+}
+
+static inline float32x4_t vminq_f32(float32x4_t a, float32x4_t b) {
+    float32x4_t r;
+    for (int i = 0; i < 4; ++i) r[i] = a[i] < b[i] ? a[i] : b[i];
+    return r;
+}
+
+static inline float32x4_t vmaxq_f32(float32x4_t a, float32x4_t b) {
+    float32x4_t r;
+    for (int i = 0; i < 4; ++i) r[i] = a[i] > b[i] ? a[i] : b[i];
+    return r;
+}
+
+static inline uint32x4_t vcltq_f32(float32x4_t a, float32x4_t b) {
+    uint32x4_t r;
+    for (int i = 0; i < 4; ++i) r[i] = a[i] < b[i] ? 0xffffffffu : 0u;
+    return r;
+}
+
+// Bitwise: mask bits set take a, clear take b
+static inline float32x4_t vbslq_f32(uint32x4_t mask, float32x4_t a, float32x4_t b) {
+    uint32x4_t ua, ub;
+    memcpy(&ua, &a, sizeof(ua));
+    memcpy(&ub, &b, sizeof(ub));
+    const uint32x4_t ur = (ua & mask) | (ub & ~mask);
+    float32x4_t r;
+    memcpy(&r, &ur, sizeof(r));
+    return r;
+}
+
+// ---- lane shuffles ----
+
+static inline float32x2_t vget_low_f32(float32x4_t a) { return (float32x2_t) {a[0], a[1]}; }
+static inline float32x2_t vget_high_f32(float32x4_t a) { return (float32x2_t) {a[2], a[3]}; }
+
+static inline float32x4_t vcombine_f32(float32x2_t lo, float32x2_t hi) {
+    return (float32x4_t) {lo[0], lo[1], hi[0], hi[1]};
+}
+
+// Swaps within each 64-bit half: [a1 a0 a3 a2]
+static inline float32x4_t vrev64q_f32(float32x4_t a) {
+    return (float32x4_t) {a[1], a[0], a[3], a[2]};
+}
+
+// val[0] = [a0 b0 a2 b2], val[1] = [a1 b1 a3 b3]
+static inline float32x4x2_t vtrnq_f32(float32x4_t a, float32x4_t b) {
+    float32x4x2_t r;
+    r.val[0] = (float32x4_t) {a[0], b[0], a[2], b[2]};
+    r.val[1] = (float32x4_t) {a[1], b[1], a[3], b[3]};
+    return r;
+}
+
+// ---- integer lanes ----
+
+static inline int32x4_t vdupq_n_s32(int32_t x) { return (int32x4_t) {x, x, x, x}; }
+static inline uint32x4_t vdupq_n_u32(uint32_t x) { return (uint32x4_t) {x, x, x, x}; }
+static inline int32x4_t vsubq_s32(int32x4_t a, int32x4_t b) {
+    return (int32x4_t) ((uint32x4_t) a - (uint32x4_t) b);
+}
+static inline uint32x4_t vaddq_u32(uint32x4_t a, uint32x4_t b) { return a + b; }
+static inline uint32x4_t vandq_u32(uint32x4_t a, uint32x4_t b) { return a & b; }
+static inline uint32x4_t veorq_u32(uint32x4_t a, uint32x4_t b) { return a ^ b; }
+static inline uint32x4_t vshlq_n_u32(uint32x4_t a, int n) { return a << n; }
+static inline uint32x4_t vshrq_n_u32(uint32x4_t a, int n) { return a >> n; }
+static inline int32x4_t vreinterpretq_s32_u32(uint32x4_t a) { return (int32x4_t) a; }
+
+static inline int32x4_t vmovl_s16(int16x4_t a) { return (int32x4_t) {a[0], a[1], a[2], a[3]}; }
+
+static inline int16x4_t vqmovn_s32(int32x4_t a) {
+    int16x4_t r;
+    for (int i = 0; i < 4; ++i) r[i] = (int16_t) (a[i] > 32767 ? 32767 : a[i] < -32768 ? -32768 : a[i]);
+    return r;
+}
+
+// ---- conversions ----
+
+static inline float32x4_t vcvtq_f32_s32(int32x4_t a) {
+    return (float32x4_t) {(float) a[0], (float) a[1], (float) a[2], (float) a[3]};
+}
+
+// Saturates; NaN converts to 0
+static inline int32_t neonEmulationSaturate(double x) {
+    if (x != x) return 0;
+    if (x >= 2147483647.0) return INT32_MAX;
+    if (x <= -2147483648.0) return INT32_MIN;
+    return (int32_t) x;
+}
+
+// Toward zero
+static inline int32x4_t vcvtq_s32_f32(float32x4_t a) {
+    int32x4_t r;
+    for (int i = 0; i < 4; ++i) r[i] = neonEmulationSaturate(truncf(a[i]));
+    return r;
+}
+
+// To nearest, ties to even (AArch64 FCVTNS)
+static inline int32x4_t vcvtnq_s32_f32(float32x4_t a) {
+    int32x4_t r;
+    for (int i = 0; i < 4; ++i) {
+        const float lo = floorf(a[i]);
+        const float diff = a[i] - lo;
+        const float nearest = diff > 0.5f ? lo + 1.0f
+                            : diff < 0.5f ? lo
+                            : fmodf(lo, 2.0f) == 0.0f ? lo : lo + 1.0f;
+        r[i] = neonEmulationSaturate(nearest);
+    }
+    return r;
+}
+
+#endif //OBOEPASSTHROUGH_NEON_EMULATION_ARM_NEON_H
@@ -0,0 +1,206 @@
+// Drives NonUniformConvolver's worker in lockstep with its callbacks and checks it against
+// direct convolution, plus the worst-case CPU time of a callback. Offline mode, with no
+// pacing at all, must match exactly as well. A wall-clock paced run reports how often the
+// worker is late on this host and checks that a miss only drops that block's tail.
+
+#include <time.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "NonUniformConvolver.h"
+#include "TestUtil.h"
+
+namespace {
+
+constexpr int32_t kSampleRate = 48000;
+
+double threadCpuNs() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+std::vector<float> noise(size_t n, unsigned seed, float scale = 1.0f) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(-scale, scale);
+    std::vector<float> v(n);
+    for (auto &s : v) s = dist(rng);
+    return v;
+}
+
+// Decaying noise, shaped like a measured room / ear-canal response.
+std::vector<float> decayingTaps(int32_t numTaps) {
+    auto taps = noise(numTaps, 7);
+    for (int32_t i = 0; i < numTaps; ++i) taps[i] *= expf(-4.0f * i / numTaps);
+    return taps;
+}
+
+std::vector<float> directConvolution(const std::vector<float> &x, const std::vector<float> &h) {
+    std::vector<float> y(x.size(), 0.0f);
+    for (size_t n = 0; n < x.size(); ++n) {
+        double acc = 0.0;
+        size_t kMax = std::min(h.size() - 1, n);
+        for (size_t k = 0; k <= kMax; ++k) acc += (double) h[k] * x[n - k];
+        y[n] = (float) acc;
+    }
+    return y;
+}
+
+// The worker thread, with each callback waiting until the worker has finished the blocks it
+// was handed: every tail segment is on time, so the output must match exactly, and the
+// audio thread's share (the head) must fit in a callback.
+void runThreaded(int32_t burst, int32_t numTaps, double seconds) {
+    auto taps = decayingTaps(numTaps);
+    auto x = noise((size_t) (seconds * kSampleRate) / burst * burst, 11, 0.5f);
+    auto expected = directConvolution(x, taps);
+
+    NonUniformConvolver conv;
+    conv.configure(burst, taps.data(), numTaps);
+    EXPECT_TRUE(conv.getNumTailSegments() > 0);
+
+    std::vector<float> y(x.size());
+    double worstNs = 0.0;
+    int64_t handed = 0;
+    for (size_t pos = 0; pos < x.size(); pos += burst) {
+        double t0 = threadCpuNs();
+        conv.process(&x[pos], &y[pos], burst);
+        worstNs = std::max(worstNs, threadCpuNs() - t0);
+        ++handed;
+        while (conv.getTailBlocksDone() + conv.getInputOverruns() < handed) {
+            std::this_thread::yield();
+        }
+    }
+
+    double err = 0.0;
+    int32_t latency = conv.getLatencyFrames();
+    for (size_t n = 0; n + latency < y.size(); ++n) {
+        err = std::max(err, (double) std::fabs(y[n + latency] - expected[n]));
+    }
+    double budgetNs = 1e9 * burst / kSampleRate;
+    printf("burst %d, %d taps, %d tail segments: max err %.2e, worst callback %.1f us "
+           "(budget %.1f us)\n",
+           burst, numTaps, conv.getNumTailSegments(), err, worstNs / 1e3, budgetNs / 1e3);
+
+    EXPECT_TRUE(conv.getDeadlineMisses() == 0);
+    EXPECT_TRUE(conv.getInputOverruns() == 0);
+    EXPECT_NEAR(err, 0.0, 1e-3);
+    EXPECT_TRUE(worstNs < budgetNs);
+}
+
+// Paced by the wall clock instead, so the worker may be late; how often depends on the
+// host and is only reported. A miss must cost just the late tail: every callback not
+// touched by one still matches exactly.
+void measureRealTimeMisses(int32_t burst, int32_t numTaps, double seconds) {
+    auto taps = decayingTaps(numTaps);
+    auto x = noise((size_t) (seconds * kSampleRate) / burst * burst, 17, 0.5f);
+    auto expected = directConvolution(x, taps);
+
+    NonUniformConvolver conv;
+    conv.configure(burst, taps.data(), numTaps);
+
+    std::vector<float> y(x.size());
+    std::vector<bool> missed(x.size() / burst + 1, false);
+    auto period = std::chrono::nanoseconds((int64_t) (1e9 * burst / kSampleRate));
+    auto next = std::chrono::steady_clock::now();
+    for (size_t pos = 0; pos < x.size(); pos += burst) {
+        std::this_thread::sleep_until(next);
+        next += period;
+        const int64_t missesBefore = conv.getDeadlineMisses();
+        conv.process(&x[pos], &y[pos], burst);
+        if (conv.getDeadlineMisses() != missesBefore) {
+            // The block mixed here is played by this call or, behind the latency, the next
+            missed[pos / burst] = true;
+            missed[pos / burst + 1] = true;
+        }
+    }
+
+    double err = 0.0;
+    int32_t latency = conv.getLatencyFrames();
+    for (size_t n = 0; n + latency < y.size(); ++n) {
+        if (missed[(n + latency) / burst]) continue;
+        err = std::max(err, (double) std::fabs(y[n + latency] - expected[n]));
+    }
+    printf("paced burst %d, %d taps: %lld deadline misses in %zu callbacks, "
+           "max err elsewhere %.2e\n", burst, numTaps, (long long) conv.getDeadlineMisses(), x.size() / burst, err);
+
+    EXPECT_TRUE(conv.getInputOverruns() == 0);
+    EXPECT_NEAR(err, 0.0, 1e-3);
+}
+
+// As fast as the caller can go, with the tail on the caller's thread: nothing may be late.
+void runOffline(int32_t burst, int32_t numTaps) {
+    auto taps = decayingTaps(numTaps);
+    auto x = noise((size_t) kSampleRate / burst * burst, 13, 0.5f);
+    auto expected = directConvolution(x, taps);
+
+    NonUniformConvolver conv;
+    conv.setOffline(true);
+    conv.configure(burst, taps.data(), numTaps);
+    EXPECT_TRUE(conv.getNumTailSegments() > 0);
+    std::vector<float> y(x.size());
+    for (size_t pos = 0; pos < x.size(); pos += burst) conv.process(&x[pos], &y[pos], burst);
+
+    double err = 0.0;
+    int32_t latency = conv.getLatencyFrames();
+    for (size_t n = 0; n + latency < y.size(); ++n) {
+        err = std::max(err, (double) std::fabs(y[n + latency] - expected[n]));
+    }
+    printf("offline burst %d, %d taps: max err %.2e, deadline misses %lld\n", burst, numTaps,
+           err, (long long) conv.getDeadlineMisses());
+    EXPECT_TRUE(conv.getDeadlineMisses() == 0);
+    EXPECT_TRUE(conv.getInputOverruns() == 0);
+    EXPECT_NEAR(err, 0.0, 1e-3);
+}
+
+// A short filter must stay on the caller's thread.
+void checkShortFilterHasNoTail() {
+    auto taps = decayingTaps(1025);
+    NonUniformConvolver conv;
+    conv.configure(192, taps.data(), (int32_t) taps.size());
+    EXPECT_TRUE(conv.getNumTailSegments() == 0);
+}
+
+// release() drops the worker and tail; configure() brings them back, exact as before.
+void checkReleaseAndReconfigure() {
+    const int32_t burst = 256;
+    auto taps = decayingTaps(8000);
+    auto x = noise((size_t) kSampleRate / 4 / burst * burst, 19, 0.5f);
+    auto expected = directConvolution(x, taps);
+
+    NonUniformConvolver conv;
+    conv.configure(burst, taps.data(), (int32_t) taps.size());
+    std::vector<float> y(x.size());
+    for (size_t pos = 0; pos < x.size(); pos += burst) conv.process(&x[pos], &y[pos], burst);
+    conv.release();
+    EXPECT_TRUE(conv.getNumTailSegments() == 0);
+    EXPECT_TRUE(conv.getDeadlineMisses() == 0);
+
+    conv.setOffline(true);
+    conv.configure(burst, taps.data(), (int32_t) taps.size());
+    EXPECT_TRUE(conv.getNumTailSegments() > 0);
+    for (size_t pos = 0; pos < x.size(); pos += burst) conv.process(&x[pos], &y[pos], burst);
+    double err = 0.0;
+    const int32_t latency = conv.getLatencyFrames();
+    for (size_t n = 0; n + latency < y.size(); ++n) {
+        err = std::max(err, (double) std::fabs(y[n + latency] - expected[n]));
+    }
+    EXPECT_NEAR(err, 0.0, 1e-3);
+}
+
+} // namespace
+
+int main() {
+    checkShortFilterHasNoTail();
+    checkReleaseAndReconfigure();
+    runOffline(256, 16384);
+    runOffline(192, 8000);
+    runThreaded(256, 16384, 1.5);
+    runThreaded(192, 8000, 1.0);
+    measureRealTimeMisses(192, 8000, 1.0);
+    return test::failures();
+}
@@ -0,0 +1,99 @@
+// Checks PartitionedConvolver against direct time-domain convolution.
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "FirDesign.h"
+#include "PartitionedConvolver.h"
+#include "TestUtil.h"
+
+namespace {
+
+std::vector<float> directConvolution(const std::vector<float> &x, const std::vector<float> &h) {
+    std::vector<float> y(x.size(), 0.0f);
+    for (size_t n = 0; n < x.size(); ++n) {
+        double acc = 0.0;
+        for (size_t k = 0; k < h.size() && k <= n; ++k) acc += (double) h[k] * x[n - k];
+        y[n] = (float) acc;
+    }
+    return y;
+}
+
+std::vector<float> noise(size_t n, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<float> v(n);
+    for (auto &s : v) s = dist(rng);
+    return v;
+}
+
+double maxError(const std::vector<float> &expected, const std::vector<float> &actual,
+                int32_t latency) {
+    double err = 0.0;
+    for (size_t n = 0; n + latency < actual.size(); ++n) {
+        err = std::max(err, (double) std::fabs(actual[n + latency] - expected[n]));
+    }
+    return err;
+}
+
+// Streams in irregular chunks to exercise the block adapter.
+void checkStreaming(int32_t blockSize, const std::vector<float> &taps) {
+    auto x = noise(8192, 1);
+    auto expected = directConvolution(x, taps);
+
+    PartitionedConvolver conv;
+    conv.configure(blockSize, taps.data(), (int32_t) taps.size());
+    std::vector<float> y(x.size());
+    const int32_t chunks[] = {1, 37, 192, 5, 480, 96};
+    size_t pos = 0;
+    for (int i = 0; pos < x.size(); ++i) {
+        int32_t n = std::min<int32_t>(chunks[i % 6], (int32_t) (x.size() - pos));
+        conv.process(&x[pos], &y[pos], n);
+        pos += n;
+    }
+
+    // The first latency frames are the silence primed into the block adapter
+    for (int32_t n = 0; n < conv.getLatencyFrames(); ++n) EXPECT_NEAR(y[n], 0.0, 0.0);
+    EXPECT_NEAR(maxError(expected, y, conv.getLatencyFrames()), 0.0, 1e-4);
+}
+
+void checkBlockApi() {
+    const int32_t B = 64;
+    auto taps = noise(300, 2);  // not a multiple of the block size
+    auto x = noise(B * 40, 3);
+    auto expected = directConvolution(x, taps);
+
+    PartitionedConvolver conv;
+    conv.configure(B, taps.data(), (int32_t) taps.size());
+    EXPECT_TRUE(conv.getNumPartitions() == 5);
+    std::vector<float> y(x.size());
+    for (size_t pos = 0; pos < x.size(); pos += B) conv.processBlock(&x[pos], &y[pos]);
+    EXPECT_NEAR(maxError(expected, y, 0), 0.0, 1e-4);
+}
+
+void checkReset() {
+    const int32_t B = 32;
+    auto taps = noise(100, 4);
+    auto x = noise(B * 8, 5);
+    PartitionedConvolver conv;
+    conv.configure(B, taps.data(), (int32_t) taps.size());
+    std::vector<float> first(x.size()), second(x.size());
+    conv.process(x.data(), first.data(), (int32_t) x.size());
+    conv.reset();
+    conv.process(x.data(), second.data(), (int32_t) x.size());
+    EXPECT_NEAR(maxError(first, second, 0), 0.0, 0.0);
+}
+
+} // namespace
+
+int main() {
+    auto bandPass = FirDesign::bandPass(125.0f, 18000.0f, 48000, 1025);
+    for (int32_t blockSize : {48, 96, 192, 256, 240}) {
+        checkStreaming(blockSize, bandPass);
+    }
+    checkStreaming(128, {1.0f});  // identity filter, single partial partition
+    checkBlockApi();
+    checkReset();
+    return test::failures();
+}
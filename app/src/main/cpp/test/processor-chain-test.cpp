@@ -0,0 +1,126 @@
+// ProcessorChain templates with toy stages: time-domain stage order and in-place
+// chaining, spectral stages narrowing the live bin range, and ChainSet running only the
+// selected chain.
+
+#include <vector>
+
+#include "ProcessorChain.h"
+#include "TestUtil.h"
+
+namespace {
+
+struct Gain {
+    float gain;
+    int32_t calls = 0;
+    void process(const float *input, float *output, int32_t numFrames) {
+        for (int32_t i = 0; i < numFrames; ++i) output[i] = gain * input[i];
+        ++calls;
+    }
+};
+
+struct Offset {
+    float offset;
+    void process(const float *input, float *output, int32_t numFrames) {
+        for (int32_t i = 0; i < numFrames; ++i) output[i] = input[i] + offset;
+    }
+};
+
+// Zeroes everything outside [begin, end)
+struct BandPass {
+    int32_t begin;
+    int32_t end;
+    void process(kiss_fft_cpx *spectrum, SpectralGainTable::BinRange &active) {
+        for (int32_t k = active.begin; k < active.end; ++k) {
+            if (k < begin || k >= end) spectrum[k].r = spectrum[k].i = 0.0f;
+        }
+        active = chain::intersect(active, {begin, end});
+    }
+};
+
+struct Scale {
+    float scale;
+    void process(kiss_fft_cpx *spectrum, SpectralGainTable::BinRange &active) {
+        for (int32_t k = active.begin; k < active.end; ++k) {
+            spectrum[k].r *= scale;
+            spectrum[k].i *= scale;
+        }
+    }
+};
+
+void checkTimeChainOrder() {
+    const float in[4] = {0.0f, 1.0f, -2.0f, 0.5f};
+    float out[4];
+
+    chain::TimeChain<Gain, Offset> gainThenOffset(Gain{2.0f}, Offset{1.0f});
+    gainThenOffset.process(in, out, 4);
+    for (int i = 0; i < 4; ++i) EXPECT_NEAR(out[i], 2.0f * in[i] + 1.0f, 1e-6);
+    EXPECT_TRUE(gainThenOffset.stage<0>().calls == 1);
+
+    chain::TimeChain<Offset, Gain> offsetThenGain(Offset{1.0f}, Gain{2.0f});
+    offsetThenGain.process(in, out, 4);
+    for (int i = 0; i < 4; ++i) EXPECT_NEAR(out[i], 2.0f * (in[i] + 1.0f), 1e-6);
+
+    // In place end to end
+    float buffer[4] = {0.0f, 1.0f, -2.0f, 0.5f};
+    offsetThenGain.process(buffer, buffer, 4);
+    for (int i = 0; i < 4; ++i) EXPECT_NEAR(buffer[i], out[i], 1e-6);
+
+    chain::TimeChain<> empty;
+    empty.process(in, out, 4);
+    for (int i = 0; i < 4; ++i) EXPECT_NEAR(out[i], in[i], 0.0);
+}
+
+void checkSpectralChainRange() {
+    const int32_t bins = 33;
+    std::vector<kiss_fft_cpx> spectrum(bins, kiss_fft_cpx{1.0f, -1.0f});
+
+    chain::SpectralChain<BandPass, Scale, BandPass> c(BandPass{3, 20}, Scale{0.5f}, BandPass{5, 40});
+    SpectralGainTable::BinRange active = c.process(spectrum.data(), bins);
+    EXPECT_TRUE(active.begin == 5 && active.end == 20);
+    for (int32_t k = 0; k < bins; ++k) {
+        const float expected = k >= 5 && k < 20 ? 0.5f : 0.0f;
+        EXPECT_NEAR(spectrum[k].r, expected, 1e-6);
+        EXPECT_NEAR(spectrum[k].i, -expected, 1e-6);
+    }
+
+    chain::SpectralChain<BandPass, BandPass> disjoint(BandPass{3, 8}, BandPass{12, 20});
+    active = disjoint.process(spectrum.data(), bins);
+    EXPECT_TRUE(active.begin == active.end);
+
+    chain::SpectralChain<> none;
+    active = none.process(spectrum.data(), bins);
+    EXPECT_TRUE(active.begin == 0 && active.end == bins);
+}
+
+void checkChainSetSelects() {
+    using Set = chain::ChainSet<chain::TimeChain<Gain>, chain::TimeChain<Gain, Offset>,
+                                chain::TimeChain<Gain>>;
+    Set set(chain::TimeChain<Gain>(Gain{2.0f}),
+            chain::TimeChain<Gain, Offset>(Gain{3.0f}, Offset{1.0f}),
+            chain::TimeChain<Gain>(Gain{-1.0f}));
+    const float in[2] = {1.0f, 2.0f};
+    float out[2];
+
+    set.process(1, in, out, 2);
+    EXPECT_NEAR(out[1], 7.0, 1e-6);
+    set.process(2, in, out, 2);
+    EXPECT_NEAR(out[1], -2.0, 1e-6);
+    set.process(0, in, out, 2);
+    EXPECT_NEAR(out[1], 4.0, 1e-6);
+    // Out of range falls back to the first chain
+    set.process(7, in, out, 2);
+    EXPECT_NEAR(out[1], 4.0, 1e-6);
+
+    EXPECT_TRUE(set.get<0>().stage<0>().calls == 2);
+    EXPECT_TRUE(set.get<1>().stage<0>().calls == 1);
+    EXPECT_TRUE(set.get<2>().stage<0>().calls == 1);
+}
+
+} // namespace
+
+int main() {
+    checkTimeChainOrder();
+    checkSpectralChainRange();
+    checkChainSetSelects();
+    return test::failures();
+}
@@ -0,0 +1,192 @@
+// SampleConverter: exact integer round trips, saturation at full scale, the vector blocks
+// agreeing with the scalar tail at every length, and the dither's error statistics
+// (zero mean, TPDF-plus-rounding variance of 1/4 LSB^2, never more than 1.5 LSB).
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "SampleConverter.h"
+#include "TestUtil.h"
+
+namespace {
+
+using Format = SampleConverter::Format;
+
+int32_t readSample(Format format, const std::vector<uint8_t> &bytes, int32_t i) {
+    switch (format) {
+        case Format::I16: {
+            int16_t x;
+            std::memcpy(&x, &bytes[2 * i], sizeof(x));
+            return x;
+        }
+        case Format::I24:
+            return (int32_t) ((uint32_t) bytes[3 * i] << 8 | (uint32_t) bytes[3 * i + 1] << 16 |
+                              (uint32_t) bytes[3 * i + 2] << 24) >> 8;
+        default: {
+            int32_t x;
+            std::memcpy(&x, &bytes[4 * i], sizeof(x));
+            return x;
+        }
+    }
+}
+
+void writeSample(Format format, std::vector<uint8_t> &bytes, int32_t i, int32_t x) {
+    switch (format) {
+        case Format::I16: {
+            int16_t v = (int16_t) x;
+            std::memcpy(&bytes[2 * i], &v, sizeof(v));
+            break;
+        }
+        case Format::I24:
+            bytes[3 * i] = (uint8_t) x;
+            bytes[3 * i + 1] = (uint8_t) (x >> 8);
+            bytes[3 * i + 2] = (uint8_t) (x >> 16);
+            break;
+        default:
+            std::memcpy(&bytes[4 * i], &x, sizeof(x));
+            break;
+    }
+}
+
+double fullScale(Format format) {
+    return format == Format::I16 ? 32768.0 : format == Format::I24 ? 8388608.0 : 2147483648.0;
+}
+
+// Integers survive toFloat + undithered fromFloat exactly. I32 keeps float's 24 bits.
+void checkRoundTrip() {
+    std::mt19937 rng(3);
+    const int32_t n = 1027;
+    for (Format format : {Format::I16, Format::I24, Format::I32}) {
+        const int32_t bytes = SampleConverter::bytesPerSample(format);
+        std::vector<uint8_t> in(n * bytes), out(n * bytes);
+        std::vector<int32_t> expected(n);
+        for (int32_t i = 0; i < n; ++i) {
+            int32_t x = (int32_t) (rng() & 0xffffff) - 0x800000;       // 24-bit
+            if (format == Format::I16) x >>= 8;
+            if (format == Format::I32) x *= 256;
+            if (i == 0) x = (int32_t) -fullScale(format);              // both extremes
+            if (i == 1) x = format == Format::I32 ? 0x7fffff00 : (int32_t) fullScale(format) - 1;
+            expected[i] = x;
+            writeSample(format, in, i, x);
+        }
+        SampleConverter converter;
+        converter.configure(format, false);
+        std::vector<float> f(n);
+        converter.toFloat(in.data(), f.data(), n);
+        EXPECT_NEAR(f[0], -1.0, 0.0);
+        converter.fromFloat(f.data(), out.data(), n);
+        int32_t mismatches = 0;
+        for (int32_t i = 0; i < n; ++i) mismatches += readSample(format, out, i) != expected[i];
+        EXPECT_TRUE(mismatches == 0);
+    }
+}
+
+void checkSaturation() {
+    const float in[] = {4.0f, 1.0f, -1.0f, -4.0f, 0.5f, 1e9f, -1e9f, 0.0f, 1.0f};
+    const int32_t n = sizeof(in) / sizeof(in[0]);
+    for (Format format : {Format::I16, Format::I24, Format::I32}) {
+        for (bool dither : {false, true}) {
+            SampleConverter converter;
+            converter.configure(format, dither);
+            std::vector<uint8_t> out(n * SampleConverter::bytesPerSample(format));
+            converter.fromFloat(in, out.data(), n);
+            // I32 saturates at the largest float below 2^31
+            const int32_t top = format == Format::I32 ? 2147483520
+                                                      : (int32_t) fullScale(format) - 1;
+            const int32_t bottom = (int32_t) -fullScale(format);
+            for (int32_t i : {0, 1, 5, 8}) EXPECT_TRUE(readSample(format, out, i) == top);
+            for (int32_t i : {2, 3, 6}) EXPECT_TRUE(readSample(format, out, i) == bottom);
+            const int32_t half = readSample(format, out, 4);
+            EXPECT_NEAR(half, fullScale(format) / 2, 1.0);
+        }
+    }
+}
+
+// Every length exercises a different split between four-sample blocks and the tail
+void checkLengths() {
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> dist(-1.2f, 1.2f);
+    for (Format format : {Format::I16, Format::I24, Format::I32}) {
+        for (int32_t n = 1; n <= 11; ++n) {
+            std::vector<float> in(n);
+            for (float &x : in) x = dist(rng);
+            SampleConverter converter;
+            converter.configure(format, false);
+            std::vector<uint8_t> out(n * SampleConverter::bytesPerSample(format));
+            converter.fromFloat(in.data(), out.data(), n);
+            std::vector<float> back(n);
+            converter.toFloat(out.data(), back.data(), n);
+            for (int32_t i = 0; i < n; ++i) {
+                const double scale = fullScale(format);
+                const double clamped = std::fmin(std::fmax(in[i] * scale, -scale), scale - 1.0);
+                EXPECT_NEAR(readSample(format, out, i), clamped, format == Format::I32 ? 128.0 : 0.5);
+                EXPECT_NEAR(back[i] * scale, readSample(format, out, i), format == Format::I32 ? 128.0 : 0.0);
+            }
+        }
+    }
+}
+
+void checkDither() {
+    for (Format format : {Format::I16, Format::I24}) {
+        const double scale = fullScale(format);
+        const int32_t n = 200003;
+        std::vector<float> in(n);
+        std::mt19937 rng(9);
+        // +-1000 LSB: near full scale float's mantissa is too short to carry I24's dither
+        std::uniform_real_distribution<float> dist(-1000.0f, 1000.0f);
+        for (float &x : in) x = dist(rng) / (float) scale;
+        // Silence too: undithered it would be all zeros
+        for (int32_t i = 0; i < 1000; ++i) in[i] = 0.0f;
+
+        SampleConverter converter;
+        converter.configure(format, true);
+        std::vector<uint8_t> out(n * SampleConverter::bytesPerSample(format));
+        // Odd chunks, so the tail's dither is in the mix
+        for (int32_t i = 0; i < n; i += 97) {
+            const int32_t chunk = std::min(97, n - i);
+            converter.fromFloat(&in[i], &out[i * SampleConverter::bytesPerSample(format)], chunk);
+        }
+        double sum = 0.0, sumSquares = 0.0, worst = 0.0;
+        int32_t silentNonZero = 0;
+        for (int32_t i = 0; i < n; ++i) {
+            const double e = readSample(format, out, i) - (double) in[i] * scale;
+            sum += e;
+            sumSquares += e * e;
+            worst = std::fmax(worst, std::fabs(e));
+            if (i < 1000) silentNonZero += readSample(format, out, i) != 0;
+        }
+        const double mean = sum / n;
+        const double variance = sumSquares / n - mean * mean;
+        EXPECT_NEAR(mean, 0.0, 0.01);
+        EXPECT_NEAR(variance, 0.25, 0.02);
+        EXPECT_TRUE(worst < 1.5 + 1e-3);
+        // Triangular +-1 LSB rounds to +-1 a quarter of the time
+        EXPECT_TRUE(silentNonZero > 150 && silentNonZero < 350);
+    }
+}
+
+void checkFloatPassthrough() {
+    const float in[] = {0.25f, -2.0f, 3.5f, 0.0f, -0.125f};
+    float out[5] = {};
+    SampleConverter converter;
+    converter.fromFloat(in, out, 5);
+    EXPECT_TRUE(std::memcmp(in, out, sizeof(in)) == 0);
+    float back[5] = {};
+    converter.toFloat(out, back, 5);
+    EXPECT_TRUE(std::memcmp(in, back, sizeof(in)) == 0);
+}
+
+} // namespace
+
+int main() {
+    checkRoundTrip();
+    checkSaturation();
+    checkLengths();
+    checkDither();
+    checkFloatPassthrough();
+    return test::failures();
+}
@@ -0,0 +1,316 @@
+// SpectralProcessor reconstruction for each window/overlap, the fused frame kernel
+// against the plain window/FFT/gain/IFFT/normalize/overlap-add loop, batched catch-up
+// matching frame-by-frame processing, SpectralPath swapping configurations mid-stream without a
+// discontinuity, the crossfaded bypass in and out, and the auto FFT size pick.
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "kiss_fftr.h"
+#include "SpectralPath.h"
+#include "TestUtil.h"
+
+namespace {
+
+constexpr int32_t kSampleRate = 48000;
+constexpr float kToneHz = 1000.0f;
+constexpr float kAmplitude = 0.5f;
+
+float tone(int64_t n) {
+    return kAmplitude * sinf(2.0f * (float) M_PI * kToneHz * (float) (n % kSampleRate) / kSampleRate);
+}
+
+// Output trimmed of its zero-fill lines up with the input, so compare sample for sample
+void testReconstruction(SpectralProcessor::Config config) {
+    SpectralProcessor processor(config, kSampleRate);
+    const int32_t burst = 192;
+    std::vector<float> in(burst), out(burst);
+    int64_t inPos = 0;
+    int64_t outPos = 0;
+    double maxError = 0.0;
+    for (int call = 0; call < 500; ++call) {
+        for (int32_t i = 0; i < burst; ++i) in[i] = tone(inPos + i);
+        inPos += burst;
+        int32_t delivered = processor.process(in.data(), burst, out.data(), burst);
+        for (int32_t i = 0; i < delivered; ++i, ++outPos) {
+            // skip the first frame, which has no earlier frames to overlap with
+            if (outPos >= config.fftSize) {
+                maxError = std::max(maxError, (double) std::fabs(out[i] - tone(outPos)));
+            }
+        }
+    }
+    EXPECT_TRUE(outPos > 400 * burst);
+    EXPECT_NEAR(maxError, 0.0, 0.01);
+    // Every zero-filled frame, leading or not, delays what follows
+    EXPECT_TRUE(processor.getLatencyFrames() == 500 * burst - outPos);
+    EXPECT_TRUE(processor.getLatencyFrames() < config.fftSize);
+}
+
+// The frame loop as it was before the fused kernel: a pass per step, scalar kiss_fftr,
+// unscaled window, separate normalize and overlap-add
+class ReferenceFrameLoop {
+public:
+    ReferenceFrameLoop(int32_t fftSize, int32_t hop, int32_t compressorBands,
+                       const MultibandCompressor::BandParams &band)
+            : mFftSize(fftSize), mHop(hop), mWindow(fftSize), mSpectrum(fftSize / 2 + 1),
+              mTime(fftSize), mOverlap(fftSize - hop, 0.0f) {
+        float windowSum = 0.0f, windowSumSquares = 0.0f;
+        for (int i = 0; i < fftSize; ++i) {
+            mWindow[i] = 0.5f - 0.5f * cosf(2.0f * (float) M_PI * i / fftSize);
+            windowSum += mWindow[i];
+            windowSumSquares += mWindow[i] * mWindow[i];
+        }
+        mScale = (float) hop / (windowSum * fftSize);
+        mFwd = kiss_fftr_alloc(fftSize, 0, nullptr, nullptr);
+        mInv = kiss_fftr_alloc(fftSize, 1, nullptr, nullptr);
+        mGains.setFftSize(fftSize, kSampleRate);
+        mCompressor.setAllBands(band);
+        mCompressor.configure(compressorBands, fftSize, hop, kSampleRate, windowSumSquares);
+    }
+
+    ~ReferenceFrameLoop() {
+        kiss_fftr_free(mFwd);
+        kiss_fftr_free(mInv);
+    }
+
+    // Appends every hop the new input completes.
+    void push(const float *x, int32_t n, std::vector<float> &out) {
+        mInput.insert(mInput.end(), x, x + n);
+        while ((int32_t) mInput.size() >= mFftSize) {
+            std::vector<float> windowed(mFftSize);
+            for (int i = 0; i < mFftSize; ++i) windowed[i] = mInput[i] * mWindow[i];
+            kiss_fftr(mFwd, windowed.data(), mSpectrum.data());
+            mCompressor.process(mSpectrum.data());
+            mGains.apply(mSpectrum.data());
+            kiss_fftri(mInv, mSpectrum.data(), mTime.data());
+            for (int i = 0; i < mFftSize; ++i) mTime[i] *= mScale;
+            for (int i = 0; i < mFftSize - mHop; ++i) mTime[i] += mOverlap[i];
+            out.insert(out.end(), mTime.begin(), mTime.begin() + mHop);
+            std::copy(mTime.begin() + mHop, mTime.end(), mOverlap.begin());
+            mInput.erase(mInput.begin(), mInput.begin() + mHop);
+        }
+    }
+
+private:
+    int32_t mFftSize, mHop;
+    std::vector<float> mWindow;
+    std::vector<kiss_fft_cpx> mSpectrum;
+    std::vector<float> mTime, mOverlap, mInput;
+    float mScale;
+    kiss_fftr_cfg mFwd, mInv;
+    SpectralGainTable mGains;
+    MultibandCompressor mCompressor;
+};
+
+void testFusedMatchesReference(int32_t fftSize, int32_t overlap, int32_t compressorBands) {
+    SpectralProcessor::Config config{fftSize, overlap, SpectralProcessor::WindowType::Hann};
+    SpectralProcessor processor(config, kSampleRate);
+    MultibandCompressor::BandParams band;
+    band.ratio = 3.0f;
+    band.thresholdDb = -30.0f;
+    processor.setCompressorBands(std::vector<MultibandCompressor::BandParams>(compressorBands, band));
+    ReferenceFrameLoop reference(fftSize, config.hopSize(), compressorBands, band);
+
+    // Odd burst so the ring's spans split at every possible offset
+    const int32_t burst = 173;
+    std::vector<float> in(burst), out(burst), expected, actual;
+    int64_t n = 0;
+    for (int call = 0; call < 600; ++call) {
+        for (int32_t i = 0; i < burst; ++i, ++n) {
+            in[i] = tone(n) * (1.0f + 0.8f * sinf(0.0003f * n)) + 0.1f * sinf(0.37f * n);
+        }
+        int32_t delivered = processor.process(in.data(), burst, out.data(), burst);
+        actual.insert(actual.end(), out.begin(), out.begin() + delivered);
+        reference.push(in.data(), burst, expected);
+    }
+    double maxDiff = 0.0;
+    size_t count = std::min(actual.size(), expected.size());
+    for (size_t i = 0; i < count; ++i) maxDiff = std::max(maxDiff, (double) std::fabs(actual[i] - expected[i]));
+    printf("fused fft %d overlap %d, %d bands: max difference %.2e over %zu frames\n",
+           fftSize, overlap, compressorBands, maxDiff, count);
+    EXPECT_TRUE(count > 500 * (size_t) burst);
+    EXPECT_NEAR(maxDiff, 0.0, 2e-6);
+}
+
+// Several hops per callback through the batched FFTs give the same samples as one frame
+// at a time, compressor state included. minFrames 0 keeps the processor's default, which
+// batches small FFTs in vectorized builds; 2 also runs partly filled batches.
+void testBatchedMatchesSingle(SpectralProcessor::Config config, int32_t minFrames) {
+    SpectralProcessor single(config, kSampleRate);
+    SpectralProcessor batched(config, kSampleRate);
+    single.setBatchMinFrames(SpectralProcessor::kMaxBatchFrames + 1);
+    if (minFrames > 0) {
+        batched.setBatchMinFrames(minFrames);
+    } else {
+#ifndef PASSTHROUGH_SCALAR_FFT
+        const bool small = config.fftSize <= SpectralProcessor::kMaxBatchFftSize;
+        EXPECT_TRUE(batched.getBatchMinFrames() == (small ? SpectralProcessor::kMaxBatchFrames
+                                                          : SpectralProcessor::kMaxBatchFrames + 1));
+#endif
+    }
+    MultibandCompressor::BandParams band;
+    band.ratio = 3.0f;
+    band.thresholdDb = -30.0f;
+    single.setCompressorBands(std::vector<MultibandCompressor::BandParams>(8, band));
+    batched.setCompressorBands(std::vector<MultibandCompressor::BandParams>(8, band));
+
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<int32_t> burstFrames(1, config.fftSize);
+    std::vector<float> in(config.fftSize), a(config.fftSize), b(config.fftSize);
+    int64_t n = 0;
+    double maxDiff = 0.0;
+    for (int call = 0; call < 400; ++call) {
+        const int32_t burst = burstFrames(rng);
+        for (int32_t i = 0; i < burst; ++i, ++n) in[i] = tone(n) * (1.0f + 0.5f * sinf(0.001f * n));
+        int32_t gotA = single.process(in.data(), burst, a.data(), burst);
+        int32_t gotB = batched.process(in.data(), burst, b.data(), burst);
+        EXPECT_TRUE(gotA == gotB);
+        for (int32_t i = 0; i < burst; ++i) maxDiff = std::max(maxDiff, (double) std::fabs(a[i] - b[i]));
+    }
+    printf("batched fft %d overlap %d: max difference %g\n", config.fftSize, config.overlap, maxDiff);
+    EXPECT_NEAR(maxDiff, 0.0, 1e-6);
+}
+
+void testSwapIsContinuous() {
+    SpectralPath path;
+    SpectralProcessor::Config config;
+    config.fftSize = 1024;
+    path.configure(config, kSampleRate);
+
+    const int32_t burst = 96;
+    std::vector<float> in(burst), out(burst);
+    int64_t pos = 0;
+    float previous = 0.0f;
+    float maxStep = 0.0f;
+    bool measuring = false;
+    auto run = [&](int calls) {
+        for (int call = 0; call < calls; ++call) {
+            for (int32_t i = 0; i < burst; ++i) in[i] = tone(pos + i);
+            pos += burst;
+            path.process(in.data(), burst, out.data(), burst);
+            for (int32_t i = 0; i < burst; ++i) {
+                if (measuring) maxStep = std::max(maxStep, std::fabs(out[i] - previous));
+                previous = out[i];
+            }
+        }
+    };
+    // Priming can gap once when the burst doesn't divide the hop; start after it settles
+    run(100);
+    measuring = true;
+    run(100);
+    float steadyStep = maxStep;
+
+    config.fftSize = 256;
+    config.overlap = 4;
+    path.configure(config, kSampleRate);
+    run(100);
+    config.fftSize = 2048;
+    config.window = SpectralProcessor::WindowType::Blackman;
+    path.configure(config, kSampleRate);
+    run(200);
+
+    // A hard cut between the differently delayed outputs would jump by up to 2 * amplitude
+    const float toneStep = 2.0f * (float) M_PI * kToneHz / kSampleRate * kAmplitude;
+    EXPECT_TRUE(steadyStep <= 1.1f * toneStep);
+    EXPECT_TRUE(maxStep <= 1.5f * toneStep);
+    EXPECT_TRUE(path.getConfig().fftSize == 2048);
+    EXPECT_TRUE(path.getConfig().overlap == 4);
+}
+
+// Into bypass and back: crossfaded both ways, exactly dry in between, and processed again
+// (with the restarted processor's delay) afterwards.
+void testBypassIsContinuous() {
+    SpectralPath path;
+    SpectralProcessor::Config config;
+    config.fftSize = 512;
+    path.configure(config, kSampleRate);
+
+    const int32_t burst = 96;
+    std::vector<float> in(burst), out(burst);
+    int64_t pos = 0;
+    float previous = 0.0f;
+    float maxStep = 0.0f;
+    float maxDryError = 0.0f;
+    auto run = [&](int calls, bool checkDry) {
+        for (int call = 0; call < calls; ++call) {
+            for (int32_t i = 0; i < burst; ++i) in[i] = tone(pos + i);
+            pos += burst;
+            path.process(in.data(), burst, out.data(), burst);
+            for (int32_t i = 0; i < burst; ++i) {
+                if (pos > 100 * burst) maxStep = std::max(maxStep, std::fabs(out[i] - previous));
+                if (checkDry) maxDryError = std::max(maxDryError, std::fabs(out[i] - in[i]));
+                previous = out[i];
+            }
+        }
+    };
+    run(100, false);
+    path.setBypass(true);
+    run(SpectralPath::kCrossfadeFrames / burst + 1, false);
+    EXPECT_TRUE(path.isBypassed());
+    EXPECT_TRUE(path.getLatencyFrames() == 0);
+    run(50, true);
+    path.setBypass(false);
+    run(100, false);
+    EXPECT_TRUE(!path.isBypassed());
+
+    const float toneStep = 2.0f * (float) M_PI * kToneHz / kSampleRate * kAmplitude;
+    EXPECT_NEAR(maxDryError, 0.0, 1e-7);
+    EXPECT_TRUE(maxStep <= 1.5f * toneStep);
+
+    int32_t latency = path.getLatencyFrames();
+    EXPECT_TRUE(latency > 0);
+    float maxError = 0.0f;
+    for (int32_t i = 0; i < burst; ++i) {
+        maxError = std::max(maxError, std::fabs(out[i] - tone(pos - burst + i - latency)));
+    }
+    EXPECT_NEAR(maxError, 0.0, 0.01);
+}
+
+void testAutoConfig() {
+    SpectralProcessor::Config base;
+    base.overlap = 4;
+
+    // Anything fits a generous budget, so the smallest size wins
+    SpectralProcessor::Config roomy = SpectralPath::chooseAutoConfig(base, 192, kSampleRate, 100.0);
+    EXPECT_TRUE(roomy.fftSize == SpectralPath::kMinAutoFftSize);
+    EXPECT_TRUE(roomy.overlap == 4);
+
+    // Nothing fits: still a valid size in range
+    SpectralProcessor::Config tight = SpectralPath::chooseAutoConfig(base, 192, kSampleRate, 1e-9);
+    EXPECT_TRUE(tight.fftSize >= SpectralPath::kMinAutoFftSize &&
+                tight.fftSize <= SpectralPath::kMaxAutoFftSize);
+    EXPECT_TRUE(192 % tight.hopSize() == 0 || tight.hopSize() % 192 == 0);
+
+    // At 50% overlap the hop equals a 240-frame burst, a mixed-radix size
+    base.overlap = 2;
+    SpectralProcessor::Config aligned = SpectralPath::chooseAutoConfig(base, 240, kSampleRate, 100.0);
+    EXPECT_TRUE(aligned.fftSize == 480);
+    // A burst no covered size aligns with falls back to the powers of two
+    SpectralProcessor::Config prime = SpectralPath::chooseAutoConfig(base, 97, kSampleRate, 100.0);
+    EXPECT_TRUE(prime.fftSize == SpectralPath::kMinAutoFftSize);
+}
+
+} // namespace
+
+int main() {
+    using Window = SpectralProcessor::WindowType;
+    testReconstruction({1024, 2, Window::Hann});
+    testReconstruction({1024, 4, Window::Hann});
+    testReconstruction({512, 8, Window::Hann});
+    testReconstruction({1024, 2, Window::Hamming});
+    testReconstruction({2048, 4, Window::Blackman});
+    testReconstruction({2048, 2, Window::Blackman});   // sanitized up to 75%
+    testReconstruction({480, 2, Window::Hann});         // mixed radix, hop = a 240 burst
+    testReconstruction({960, 4, Window::Hann});
+    testFusedMatchesReference(1024, 2, 0);
+    testFusedMatchesReference(1024, 2, 8);
+    testFusedMatchesReference(256, 8, 8);
+    testBatchedMatchesSingle({128, 4, Window::Hann}, 0);
+    testBatchedMatchesSingle({1024, 2, Window::Hann}, 2);
+    testBatchedMatchesSingle({512, 8, Window::Hann}, 2);
+    testSwapIsContinuous();
+    testBypassIsContinuous();
+    testAutoConfig();
+    return test::failures();
+}
@@ -0,0 +1,173 @@
+#include "WavFile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+constexpr uint16_t kFormatPcm = 1;
+constexpr uint16_t kFormatFloat = 3;
+constexpr uint16_t kFormatExtensible = 0xFFFE;
+
+uint16_t readLe16(const uint8_t *p) { return (uint16_t) (p[0] | (p[1] << 8)); }
+uint32_t readLe32(const uint8_t *p) {
+    return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+void writeLe16(uint8_t *p, uint16_t v) { p[0] = (uint8_t) v; p[1] = (uint8_t) (v >> 8); }
+void writeLe32(uint8_t *p, uint32_t v) {
+    for (int i = 0; i < 4; ++i) p[i] = (uint8_t) (v >> (8 * i));
+}
+
+float decodeSample(const uint8_t *p, int32_t bits, bool isFloat) {
+    if (isFloat) {
+        float f;
+        std::memcpy(&f, p, sizeof(f));
+        return f;
+    }
+    switch (bits) {
+        case 16: return (int16_t) readLe16(p) * (1.0f / 32768.0f);
+        case 24: return (int32_t) ((uint32_t) (p[0] << 8 | p[1] << 16 | p[2] << 24)) * (1.0f / 2147483648.0f);
+        case 32: return (int32_t) readLe32(p) * (1.0f / 2147483648.0f);
+        default: return (p[0] - 128) * (1.0f / 128.0f);
+    }
+}
+
+} // namespace
+
+WavReader::~WavReader() {
+    close();
+}
+
+bool WavReader::open(const std::string &path) {
+    close();
+    mFile = fopen(path.c_str(), "rb");
+    if (!mFile) return false;
+
+    uint8_t riff[12];
+    if (fread(riff, 1, 12, mFile) != 12 ||
+        memcmp(riff, "RIFF", 4) != 0 || memcmp(riff + 8, "WAVE", 4) != 0) {
+        close();
+        return false;
+    }
+
+    bool haveFormat = false;
+    uint8_t header[8];
+    while (fread(header, 1, 8, mFile) == 8) {
+        uint32_t size = readLe32(header + 4);
+        if (memcmp(header, "fmt ", 4) == 0 && size >= 16) {
+            uint8_t fmt[40] = {};
+            size_t n = std::min<size_t>(size, sizeof(fmt));
+            if (fread(fmt, 1, n, mFile) != n) break;
+            uint16_t tag = readLe16(fmt);
+            if (tag == kFormatExtensible && size >= 26) tag = readLe16(fmt + 24);
+            mChannels = readLe16(fmt + 2);
+            mSampleRate = (int32_t) readLe32(fmt + 4);
+            mBitsPerSample = readLe16(fmt + 14);
+            mIsFloat = tag == kFormatFloat;
+            haveFormat = (tag == kFormatPcm && (mBitsPerSample == 8 || mBitsPerSample == 16 ||
+                                                mBitsPerSample == 24 || mBitsPerSample == 32)) ||
+                         (mIsFloat && mBitsPerSample == 32);
+            fseek(mFile, (long) (size - n + (size & 1)), SEEK_CUR);
+        } else if (memcmp(header, "data", 4) == 0 && haveFormat && mChannels > 0) {
+            mNumFrames = size / (mChannels * (mBitsPerSample / 8));
+            mFramesLeft = mNumFrames;
+            return true;
+        } else {
+            fseek(mFile, (long) (size + (size & 1)), SEEK_CUR);
+        }
+    }
+    close();
+    return false;
+}
+
+void WavReader::close() {
+    if (mFile) {
+        fclose(mFile);
+        mFile = nullptr;
+    }
+    mFramesLeft = 0;
+}
+
+int32_t WavReader::read(float *dst, int32_t numFrames) {
+    if (!mFile) return 0;
+    const int32_t bytesPerSample = mBitsPerSample / 8;
+    const int32_t frameBytes = bytesPerSample * mChannels;
+    numFrames = (int32_t) std::min<int64_t>(numFrames, mFramesLeft);
+    mScratch.resize((size_t) numFrames * frameBytes);
+    int32_t got = (int32_t) (fread(&mScratch[0], frameBytes, numFrames, mFile));
+    mFramesLeft = got < numFrames ? 0 : mFramesLeft - got;
+
+    const uint8_t *p = reinterpret_cast<const uint8_t *>(mScratch.data());
+    const float scale = 1.0f / mChannels;
+    for (int32_t i = 0; i < got; ++i) {
+        float sum = 0.0f;
+        for (int32_t c = 0; c < mChannels; ++c, p += bytesPerSample) {
+            sum += decodeSample(p, mBitsPerSample, mIsFloat);
+        }
+        dst[i] = sum * scale;
+    }
+    return got;
+}
+
+WavWriter::~WavWriter() {
+    close();
+}
+
+bool WavWriter::open(const std::string &path, int32_t sampleRate, bool asFloat) {
+    close();
+    mFile = fopen(path.c_str(), "wb");
+    if (!mFile) return false;
+    mIsFloat = asFloat;
+    mDataBytes = 0;
+
+    const uint16_t bits = asFloat ? 32 : 16;
+    uint8_t h[44];
+    memcpy(h, "RIFF", 4);
+    writeLe32(h + 4, 36);
+    memcpy(h + 8, "WAVEfmt ", 8);
+    writeLe32(h + 16, 16);
+    writeLe16(h + 20, asFloat ? kFormatFloat : kFormatPcm);
+    writeLe16(h + 22, 1);
+    writeLe32(h + 24, (uint32_t) sampleRate);
+    writeLe32(h + 28, (uint32_t) sampleRate * (bits / 8));
+    writeLe16(h + 32, bits / 8);
+    writeLe16(h + 34, bits);
+    memcpy(h + 36, "data", 4);
+    writeLe32(h + 40, 0);
+    return fwrite(h, 1, sizeof(h), mFile) == sizeof(h);
+}
+
+void WavWriter::close() {
+    if (!mFile) return;
+    // Sizes saturate at 4 GiB; readers that honour the file length still get everything
+    uint32_t dataBytes = (uint32_t) std::min<int64_t>(mDataBytes, 0xFFFFFFFFll - 36);
+    uint8_t size[4];
+    writeLe32(size, dataBytes + 36);
+    fseek(mFile, 4, SEEK_SET);
+    fwrite(size, 1, 4, mFile);
+    writeLe32(size, dataBytes);
+    fseek(mFile, 40, SEEK_SET);
+    fwrite(size, 1, 4, mFile);
+    fclose(mFile);
+    mFile = nullptr;
+}
+
+bool WavWriter::write(const float *src, int32_t numFrames) {
+    if (!mFile) return false;
+    size_t bytes;
+    if (mIsFloat) {
+        bytes = (size_t) numFrames * sizeof(float);
+        mScratch.assign(reinterpret_cast<const char *>(src), bytes);
+    } else {
+        bytes = (size_t) numFrames * 2;
+        mScratch.resize(bytes);
+        uint8_t *p = reinterpret_cast<uint8_t *>(&mScratch[0]);
+        for (int32_t i = 0; i < numFrames; ++i) {
+            float s = std::max(-1.0f, std::min(1.0f, src[i]));
+            writeLe16(p + 2 * i, (uint16_t) (int16_t) lrintf(s * 32767.0f));
+        }
+    }
+    mDataBytes += (int64_t) bytes;
+    return fwrite(mScratch.data(), 1, bytes, mFile) == bytes;
+}
@@ -0,0 +1,55 @@
+#ifndef OBOEPASSTHROUGH_WAVFILE_H
+#define OBOEPASSTHROUGH_WAVFILE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+/**
+ * Streaming RIFF/WAVE I/O for the host tools. Reads PCM 16/24/32-bit and IEEE float
+ * (any channel count, downmixed to mono); writes mono PCM 16-bit or float. Files are
+ * streamed in caller-sized chunks so hours of field recordings never sit in memory.
+ */
+class WavReader {
+public:
+    ~WavReader();
+
+    bool open(const std::string &path);
+    void close();
+
+    // Reads up to numFrames mono frames; returns the number read (0 at end of data).
+    int32_t read(float *dst, int32_t numFrames);
+
+    int32_t getSampleRate() const { return mSampleRate; }
+    int32_t getChannelCount() const { return mChannels; }
+    int64_t getNumFrames() const { return mNumFrames; }
+
+private:
+    FILE *mFile = nullptr;
+    int32_t mSampleRate = 0;
+    int32_t mChannels = 0;
+    int32_t mBitsPerSample = 0;
+    bool mIsFloat = false;
+    int64_t mNumFrames = 0;
+    int64_t mFramesLeft = 0;
+    std::string mScratch;
+};
+
+class WavWriter {
+public:
+    ~WavWriter();
+
+    bool open(const std::string &path, int32_t sampleRate, bool asFloat);
+    // Patches the RIFF and data sizes; called by the destructor if needed.
+    void close();
+
+    bool write(const float *src, int32_t numFrames);
+
+private:
+    FILE *mFile = nullptr;
+    bool mIsFloat = false;
+    int64_t mDataBytes = 0;
+    std::string mScratch;
+};
+
+#endif //OBOEPASSTHROUGH_WAVFILE_H
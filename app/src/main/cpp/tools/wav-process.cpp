@@ -0,0 +1,254 @@
+// Streams a WAV file through the MicPassthrough DSP chain in callback-sized chunks and
+// reports the real-time factor (processing time / audio duration, lower is faster).
+//
+//   wav-process in.wav out.wav [--callback N] [--mode spectral|convolution|iir]
+//               [--fft N|auto] [--overlap 2|4|8] [--window hann|hamming|blackman]
+//               [--taps N] [--fixed] [--float] [--max-rtf X]
+//
+// --fixed runs the spectral mode on int16 through FixedSpectralProcessor, times that, and
+// reports its SNR against the float path on the same int16-quantized input.
+// --max-rtf makes the exit status non-zero when the chain runs slower than X, for CI.
+// Convolution mode runs the filter tail on the calling thread (NonUniformConvolver's
+// offline mode) so the output is exact and its cost is in the timings; on a device the
+// tail runs on a worker and the callback times would be lower.
+// The output is trimmed by the chain's latency so it lines up sample-for-sample with
+// the input; the latency a device would add at this callback size is reported instead.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "BiquadCascade.h"
+#include "FirDesign.h"
+#include "FixedSpectralProcessor.h"
+#include "NonUniformConvolver.h"
+#include "SpectralPath.h"
+#include "WavFile.h"
+
+namespace {
+
+enum class Mode {
+    Spectral,
+    Convolution,
+    Iir,
+};
+
+void usage() {
+    fprintf(stderr,
+            "usage: wav-process in.wav out.wav [--callback N] [--mode spectral|convolution|iir]\n"
+            "                   [--fft N|auto] [--overlap 2|4|8] [--window hann|hamming|blackman]\n"
+            "                   [--taps N] [--fixed] [--float] [--max-rtf X]\n");
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        usage();
+        return 2;
+    }
+    std::string inPath = argv[1];
+    std::string outPath = argv[2];
+    int32_t callbackFrames = 192;
+    SpectralProcessor::Config config;
+    bool autoFftSize = false;
+    int32_t numTaps = 1025;
+    Mode mode = Mode::Spectral;
+    bool fixedPoint = false;
+    bool floatOutput = false;
+    double maxRtf = 0.0;
+    for (int i = 3; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--callback") && hasValue) {
+            callbackFrames = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--fft") && hasValue) {
+            ++i;
+            autoFftSize = !strcmp(argv[i], "auto");
+            config.fftSize = autoFftSize ? config.fftSize : atoi(argv[i]);
+        } else if (!strcmp(argv[i], "--overlap") && hasValue) {
+            config.overlap = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--window") && hasValue) {
+            ++i;
+            config.window = !strcmp(argv[i], "hamming") ? SpectralProcessor::WindowType::Hamming
+                          : !strcmp(argv[i], "blackman") ? SpectralProcessor::WindowType::Blackman
+                          : SpectralProcessor::WindowType::Hann;
+        } else if (!strcmp(argv[i], "--taps") && hasValue) {
+            numTaps = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--mode") && hasValue) {
+            ++i;
+            mode = !strcmp(argv[i], "convolution") ? Mode::Convolution
+                 : !strcmp(argv[i], "iir") ? Mode::Iir
+                 : Mode::Spectral;
+        } else if (!strcmp(argv[i], "--fixed")) {
+            fixedPoint = true;
+        } else if (!strcmp(argv[i], "--float")) {
+            floatOutput = true;
+        } else if (!strcmp(argv[i], "--max-rtf") && hasValue) {
+            maxRtf = atof(argv[++i]);
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (callbackFrames <= 0 || config.fftSize <= 0 || numTaps <= 0) {
+        usage();
+        return 2;
+    }
+
+    WavReader reader;
+    if (!reader.open(inPath)) {
+        fprintf(stderr, "can't read %s (PCM 8/16/24/32-bit or float32 WAV expected)\n", inPath.c_str());
+        return 1;
+    }
+    const int32_t sampleRate = reader.getSampleRate();
+    WavWriter writer;
+    if (!writer.open(outPath, sampleRate, floatOutput)) {
+        fprintf(stderr, "can't write %s\n", outPath.c_str());
+        return 1;
+    }
+
+    if (autoFftSize) {
+        config = SpectralPath::chooseAutoConfig(config, callbackFrames, sampleRate);
+    }
+    SpectralProcessor spectral(config, sampleRate);
+    std::unique_ptr<FixedSpectralProcessor> fixed;
+    if (fixedPoint && mode == Mode::Spectral) {
+        fixed = std::make_unique<FixedSpectralProcessor>(config, sampleRate);
+    }
+    NonUniformConvolver convolver;
+    convolver.setOffline(true);
+    BiquadCascade iir;
+    iir.configure(sampleRate);
+    iir.setSections(BiquadCascade::bandLimit(125.0f, 18000.0f));
+    int32_t latency = 0;
+    if (mode == Mode::Convolution) {
+        auto taps = FirDesign::bandPass(125.0f, 18000.0f, sampleRate, numTaps);
+        convolver.configure(callbackFrames, taps.data(), (int32_t) taps.size());
+        latency = convolver.getLatencyFrames();
+    }
+    int64_t toSkip = latency;
+
+    std::vector<float> in(callbackFrames), out(callbackFrames);
+    std::vector<int16_t> in16, out16;
+    if (fixed) {
+        in16.resize(callbackFrames);
+        out16.resize(callbackFrames);
+    }
+    double signalPower = 0.0;
+    double errorPower = 0.0;
+    int64_t framesIn = 0;
+    int64_t framesOut = 0;
+    double processNs = 0.0;
+    double worstCallbackNs = 0.0;
+    int64_t callbacks = 0;
+
+    // Keep calling after the input ends until the latency has been flushed out
+    while (framesOut < reader.getNumFrames()) {
+        int32_t got = reader.read(in.data(), callbackFrames);
+        std::fill(in.begin() + got, in.end(), 0.0f);
+        framesIn += got;
+        if (fixed) {
+            // Both paths see the same int16 samples
+            for (int32_t i = 0; i < callbackFrames; ++i) {
+                float x = std::clamp(in[i], -1.0f, 1.0f) * 32767.0f;
+                in16[i] = (int16_t) lrintf(x);
+                in[i] = in16[i] / 32768.0f;
+            }
+        }
+
+        // Spectral output is in order behind its zero-fill, so every zero-filled frame
+        // is a frame of latency; convolution has a fixed one-block lag and iir none.
+        int32_t delivered = callbackFrames;
+        auto t0 = std::chrono::steady_clock::now();
+        if (mode == Mode::Convolution) {
+            convolver.process(in.data(), out.data(), callbackFrames);
+        } else if (mode == Mode::Iir) {
+            iir.process(in.data(), out.data(), callbackFrames);
+        } else if (fixed) {
+            delivered = fixed->process(in16.data(), callbackFrames, out16.data(), callbackFrames);
+        } else {
+            delivered = spectral.process(in.data(), callbackFrames, out.data(), callbackFrames);
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+        processNs += ns;
+        worstCallbackNs = std::max(worstCallbackNs, ns);
+        ++callbacks;
+
+        if (fixed) {
+            // The float path as the reference, untimed
+            spectral.process(in.data(), callbackFrames, out.data(), callbackFrames);
+            for (int32_t i = 0; i < callbackFrames; ++i) {
+                double r = out[i] * 32768.0;
+                double e = out16[i] - r;
+                signalPower += r * r;
+                errorPower += e * e;
+                out[i] = out16[i] / 32768.0f;
+            }
+        }
+
+        int32_t skip = 0;
+        if (mode == Mode::Convolution) {
+            skip = (int32_t) std::min<int64_t>(toSkip, callbackFrames);
+            toSkip -= skip;
+        } else if (mode == Mode::Spectral) {
+            latency += callbackFrames - delivered;
+        }
+        int32_t keep = (int32_t) std::min<int64_t>(delivered - skip,
+                                                   reader.getNumFrames() - framesOut);
+        if (!writer.write(out.data() + skip, keep)) {
+            fprintf(stderr, "write failed\n");
+            return 1;
+        }
+        framesOut += keep;
+    }
+    writer.close();
+
+    const double audioSeconds = (double) framesIn / sampleRate;
+    const double rtf = audioSeconds > 0.0 ? processNs * 1e-9 / audioSeconds : 0.0;
+    const double budgetNs = 1e9 * callbackFrames / sampleRate;
+    if (mode == Mode::Convolution) {
+        printf("mode            convolution (%d taps)\n", numTaps);
+    } else if (mode == Mode::Iir) {
+        printf("mode            iir (%d biquads)\n", (int) iir.getSections().size());
+    } else {
+        const SpectralProcessor::Config &used = spectral.getConfig();
+        printf("mode            spectral%s (fft %d%s, hop %d, window %d)\n",
+               fixed ? " fixed-point" : "", used.fftSize, autoFftSize ? " auto" : "",
+               used.hopSize(), (int) used.window);
+    }
+    printf("input           %s (%d Hz, %d ch, %.2f s)\n", inPath.c_str(), sampleRate,
+           reader.getChannelCount(), audioSeconds);
+    printf("callback        %d frames (%.3f ms budget), %lld calls\n", callbackFrames,
+           budgetNs * 1e-6, (long long) callbacks);
+    printf("latency         %d frames (%.2f ms)\n", latency, 1e3 * latency / sampleRate);
+    printf("mean callback   %.1f us (%.2f%% of budget)\n", processNs / callbacks * 1e-3,
+           100.0 * processNs / callbacks / budgetNs);
+    printf("worst callback  %.1f us (%.2f%% of budget)\n", worstCallbackNs * 1e-3,
+           100.0 * worstCallbackNs / budgetNs);
+    printf("real-time factor %.4f (%.0fx faster than real time)\n", rtf,
+           rtf > 0.0 ? 1.0 / rtf : 0.0);
+    if (fixed) {
+        printf("fixed-point SNR %.1f dB against the float path (%d headroom bits)\n",
+               10.0 * std::log10(signalPower / std::max(errorPower, 1e-30)),
+               fixed->getHeadroomBits());
+    }
+    if (mode == Mode::Convolution && convolver.getDeadlineMisses() > 0) {
+        // Offline, every tail block is ready in time; a miss means the output is wrong
+        fprintf(stderr, "tail deadline misses %lld: output is missing the filter tail\n",
+                (long long) convolver.getDeadlineMisses());
+        return 1;
+    }
+
+    if (maxRtf > 0.0 && rtf > maxRtf) {
+        fprintf(stderr, "real-time factor %.4f exceeds --max-rtf %.4f\n", rtf, maxRtf);
+        return 1;
+    }
+    return 0;
+}
@@ -26,6 +26,55 @@ class AudioProcessingService : Service() {
         // This is a requirement for services that access the microphone from the background.
         startForeground(NOTIFICATION_ID, notification)
 
+        // Pick the DSP path before starting; defaults to the spectral (FFT) filter.
+        setProcessingMode(intent?.getIntExtra(EXTRA_PROCESSING_MODE, PROCESSING_MODE_SPECTRAL)
+            ?: PROCESSING_MODE_SPECTRAL)
+
+        // Spectral frame size (0 = pick from the measured cost), overlap and window.
+        setSpectralConfig(
+            intent?.getIntExtra(EXTRA_FFT_SIZE, DEFAULT_FFT_SIZE) ?: DEFAULT_FFT_SIZE,
+            intent?.getIntExtra(EXTRA_FFT_OVERLAP, FFT_OVERLAP_50) ?: FFT_OVERLAP_50,
+            intent?.getIntExtra(EXTRA_WINDOW_TYPE, WINDOW_HANN) ?: WINDOW_HANN
+        )
+
+        // Extra latency budget (ms) for running the chain on a worker thread; 0 keeps it on
+        // the audio callback.
+        setAsyncLatency(intent?.getFloatExtra(EXTRA_ASYNC_LATENCY_MS, 0f) ?: 0f)
+
+        // Step the spectral path down a quality ladder under CPU pressure (default on).
+        setLoadGovernor(intent?.getBooleanExtra(EXTRA_LOAD_GOVERNOR, true) ?: true)
+
+        // int16 streams and a fixed-point spectral path for low-end cores (default off).
+        setFixedPoint(intent?.getBooleanExtra(EXTRA_FIXED_POINT, false) ?: false)
+
+        // Channels per stream, each processed independently (default mono).
+        setChannelCount(intent?.getIntExtra(EXTRA_CHANNELS, 1) ?: 1)
+
+        // Optional per-user prescription: matching arrays of frequencies (Hz) and gains (dB).
+        val gainFrequencies = intent?.getFloatArrayExtra(EXTRA_GAIN_FREQUENCIES_HZ)
+        val gainsDb = intent?.getFloatArrayExtra(EXTRA_GAINS_DB)
+        if (gainFrequencies != null && gainsDb != null) {
+            setGainCurve(gainFrequencies, gainsDb)
+        }
+
+        // Optional biquad sections for the IIR path: matching arrays of type, frequency, Q and gain.
+        val iirTypes = intent?.getIntArrayExtra(EXTRA_IIR_TYPES)
+        val iirFrequencies = intent?.getFloatArrayExtra(EXTRA_IIR_FREQUENCIES_HZ)
+        val iirQs = intent?.getFloatArrayExtra(EXTRA_IIR_QS)
+        val iirGains = intent?.getFloatArrayExtra(EXTRA_IIR_GAINS_DB)
+        if (iirTypes != null && iirFrequencies != null && iirQs != null && iirGains != null) {
+            setIirSections(iirTypes, iirFrequencies, iirQs, iirGains)
+        }
+
+        // Optional multi-band compressor: one entry per band in each array.
+        val wdrcThresholds = intent?.getFloatArrayExtra(EXTRA_WDRC_THRESHOLDS_DB)
+        val wdrcRatios = intent?.getFloatArrayExtra(EXTRA_WDRC_RATIOS)
+        val wdrcAttack = intent?.getFloatArrayExtra(EXTRA_WDRC_ATTACK_MS)
+        val wdrcRelease = intent?.getFloatArrayExtra(EXTRA_WDRC_RELEASE_MS)
+        if (wdrcThresholds != null && wdrcRatios != null && wdrcAttack != null && wdrcRelease != null) {
+            setCompressor(wdrcThresholds, wdrcRatios, wdrcAttack, wdrcRelease)
+        }
+
         // Call your C++ function to start the audio processing.
         startPassthrough()
 
@@ -72,9 +121,126 @@ class AudioProcessingService : Service() {
     // These declarations link to the C++ functions you've already written.
     private external fun startPassthrough()
     private external fun stopPassthrough()
+    private external fun setProcessingMode(mode: Int)
+    private external fun setSpectralConfig(fftSize: Int, overlap: Int, windowType: Int)
+    private external fun setAsyncLatency(extraLatencyMs: Float)
+    private external fun setLoadGovernor(enabled: Boolean)
+    private external fun setFixedPoint(enabled: Boolean)
+    private external fun setChannelCount(channels: Int)
+    private external fun setIirSections(
+        types: IntArray, frequenciesHz: FloatArray, qs: FloatArray, gainsDb: FloatArray
+    )
+    private external fun setGainCurve(frequenciesHz: FloatArray, gainsDb: FloatArray)
+    private external fun setCompressor(
+        thresholdsDb: FloatArray, ratios: FloatArray, attackMs: FloatArray, releaseMs: FloatArray
+    )
 
     companion object {
         const val CHANNEL_ID = "AudioProcessingServiceChannel"
         const val NOTIFICATION_ID = 1
+
+        // Intent extra selecting the native processing path (values mirror ProcessingMode in native-lib.cpp)
+        const val EXTRA_PROCESSING_MODE = "processingMode"
+        const val PROCESSING_MODE_SPECTRAL = 0
+        const val PROCESSING_MODE_CONVOLUTION = 1
+        const val PROCESSING_MODE_IIR = 2
+
+        // Biquad sections for PROCESSING_MODE_IIR, one value per section (up to 8); without
+        // them the path is a 4th-order 125-18000 Hz band limit. Gain applies to peaking only.
+        const val EXTRA_IIR_TYPES = "iirTypes"
+        const val EXTRA_IIR_FREQUENCIES_HZ = "iirFrequenciesHz"
+        const val EXTRA_IIR_QS = "iirQs"
+        const val EXTRA_IIR_GAINS_DB = "iirGainsDb"
+        const val IIR_HIGH_PASS = 0
+        const val IIR_LOW_PASS = 1
+        const val IIR_PEAKING = 2
+
+        // Spectral frame: size in samples (64-8192, rounded up to a power of two or a
+        // 2/3/5 mixed-radix size such as 480; FFT_SIZE_AUTO picks one aligned to the device
+        // burst), frames per window (2/4/8 = 50/75/87.5% overlap) and analysis window
+        const val EXTRA_FFT_SIZE = "fftSize"
+        const val EXTRA_FFT_OVERLAP = "fftOverlap"
+        const val EXTRA_WINDOW_TYPE = "windowType"
+        const val FFT_SIZE_AUTO = 0
+        const val DEFAULT_FFT_SIZE = 1024
+        const val FFT_OVERLAP_50 = 2
+        const val FFT_OVERLAP_75 = 4
+        const val FFT_OVERLAP_87_5 = 8
+        const val WINDOW_HANN = 0
+        const val WINDOW_HAMMING = 1
+        const val WINDOW_BLACKMAN = 2
+
+        // Runs the processing chain on a real-time worker thread with this much extra output
+        // latency (ms, rounded up to whole bursts); a callback the worker misses plays the
+        // dry mic signal instead. 0 (default) processes on the audio callback.
+        const val EXTRA_ASYNC_LATENCY_MS = "asyncLatencyMs"
+
+        // When spectral-mode callbacks keep running close to the deadline, step down one
+        // QUALITY_* level at a time (crossfaded), and back up after a sustained quiet spell
+        const val EXTRA_LOAD_GOVERNOR = "loadGovernor"
+        const val QUALITY_FULL = 0
+        const val QUALITY_SMALLER_FFT = 1
+        const val QUALITY_FEWER_BANDS = 2
+        const val QUALITY_NO_COMPRESSOR = 3
+        const val QUALITY_BYPASS = 4
+
+        // Opens the streams as int16 and runs spectral mode in Q15/Q31 fixed point (gain
+        // curve only: no compressor, async worker or load governor). Other modes convert at
+        // the stream edges. For cores where float throughput or power is the limit.
+        const val EXTRA_FIXED_POINT = "fixedPoint"
+
+        // 1-4 channels on both streams (2 for binaural), each with its own processor state.
+        // Mono when the device won't open the count, with fixed point, or with async latency.
+        const val EXTRA_CHANNELS = "channels"
+
+        // Prescription gain curve points, interpolated on a log-frequency axis
+        const val EXTRA_GAIN_FREQUENCIES_HZ = "gainFrequenciesHz"
+        const val EXTRA_GAINS_DB = "gainsDb"
+
+        // Multi-band compressor settings, one value per band (8-16 bands)
+        const val EXTRA_WDRC_THRESHOLDS_DB = "wdrcThresholdsDb"
+        const val EXTRA_WDRC_RATIOS = "wdrcRatios"
+        const val EXTRA_WDRC_ATTACK_MS = "wdrcAttackMs"
+        const val EXTRA_WDRC_RELEASE_MS = "wdrcReleaseMs"
+
+        // Indices into getCallbackStats() (mirror StatsIndex in native-lib.cpp). Times are ns,
+        // high-water marks are frames, everything else counts since start or the last reset.
+        const val STATS_CALLBACKS = 0
+        const val STATS_FRAMES = 1
+        const val STATS_MIN_NS = 2
+        const val STATS_MEAN_NS = 3
+        const val STATS_P50_NS = 4
+        const val STATS_P90_NS = 5
+        const val STATS_P99_NS = 6
+        const val STATS_MAX_NS = 7
+        const val STATS_SHORT_READS = 8
+        const val STATS_INPUT_OVERRUNS = 9
+        const val STATS_OUTPUT_OVERFLOWS = 10
+        const val STATS_OUTPUT_UNDERRUNS = 11
+        const val STATS_INPUT_HIGH_WATER = 12
+        const val STATS_OUTPUT_HIGH_WATER = 13
+        const val STATS_TAIL_DEADLINE_MISSES = 14
+        const val STATS_SAMPLE_RATE = 15
+        // Mic/DAC clock drift compensation: correction in parts per billion, buffered mic
+        // frames, and hard slips when the loop could not keep up
+        const val STATS_DRIFT_PPB = 16
+        const val STATS_DRIFT_FILL_FRAMES = 17
+        const val STATS_DRIFT_SLIPS = 18
+        // Jitter controller: mic backlog it holds, the safety margin within it, and trims
+        const val STATS_LATENCY_TARGET_FRAMES = 19
+        const val STATS_LATENCY_MARGIN_FRAMES = 20
+        const val STATS_LATENCY_DROPS = 21
+        // EXTRA_ASYNC_LATENCY_MS mode: callbacks the worker missed, played dry
+        const val STATS_WORKER_DEADLINE_MISSES = 22
+        // Load governor: current QUALITY_* level and the degradation / recovery steps taken
+        const val STATS_QUALITY_LEVEL = 23
+        const val STATS_QUALITY_STEP_DOWNS = 24
+        const val STATS_QUALITY_STEP_UPS = 25
+        // Callback duration histogram: 64 buckets, bucket i ends at 1 us * 2^((i + 1) / 4)
+        const val STATS_HISTOGRAM = 26
+
+        // Snapshot of the native callback instrumentation; safe to poll from any thread.
+        @JvmStatic external fun getCallbackStats(): LongArray
+        @JvmStatic external fun resetCallbackStats()
     }
 }